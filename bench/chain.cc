@@ -0,0 +1,84 @@
+// `vertices * rotate * translate * projection` on math::Matrix, evaluated
+// left to right with a temporary per product versus as one lazy chain, and
+// as a chain whose result comes from a utils::Arena reset every evaluation.
+// Prints multiply-adds, heap allocations and time per evaluation.
+
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <heap/counters.hh>
+#include <math/Mat.hh>
+#include <math/Matrix.hh>
+#include <memory>
+#include <string_view>
+#include <utils/memory.hh>
+
+constexpr std::chrono::milliseconds budget{200};
+
+template <typename Evaluate>
+void measure(std::string_view method, unsigned rows, std::size_t madds,
+             Evaluate evaluate) {
+  using clock = std::chrono::steady_clock;
+  const heap::Counters before = heap::thread();
+  const math::Matrix result = evaluate();
+  const auto per_evaluation =
+      static_cast<std::size_t>((heap::thread() - before).allocations);
+
+  unsigned long evaluations = 0;
+  const clock::time_point started = clock::now();
+  clock::duration elapsed{};
+  do {
+    const math::Matrix result = evaluate();
+    evaluations++;
+    elapsed = clock::now() - started;
+  } while (elapsed < budget);
+
+  const double nanoseconds =
+      std::chrono::duration<double, std::nano>{elapsed}.count() / evaluations;
+  std::printf("%-6s %8u %12zu %8zu %14.0f\n", method.data(), rows, madds,
+              per_evaluation, nanoseconds);
+}
+
+template <unsigned rows>
+void run(const math::Matrix& rotate, const math::Matrix& translate,
+         const math::Matrix& projection) {
+  auto source = std::make_unique<math::Mat<rows, 4>>();
+  for (unsigned i = 0; i < rows; i++) {
+    for (unsigned j = 0; j < 4; j++) (*source)(i, j) = (i + j) % 7 - 3.f;
+  }
+  const math::Matrix vertices = *source;
+
+  measure("eager", rows, 3 * rows * 16, [&] {
+    math::Matrix result = vertices * rotate;
+    result = result * translate;
+    result = result * projection;
+    return result;
+  });
+  measure("chain", rows,
+          (vertices * rotate * translate * projection).cost(), [&] {
+            return math::Matrix{vertices * rotate * translate * projection};
+          });
+  // Sized by a first evaluation, as after the first frame.
+  utils::Arena arena;
+  math::Matrix{vertices * rotate * translate * projection, &arena};
+  measure("arena", rows,
+          (vertices * rotate * translate * projection).cost(), [&] {
+            arena.reset();
+            return math::Matrix{vertices * rotate * translate * projection,
+                                &arena};
+          });
+}
+
+int main(const int argc, const char* argv[]) {
+  const math::Matrix rotate = math::Matrix::rotate4x4y(0.7f);
+  const math::Matrix translate = math::Matrix::translate4x4(1, -2, -5);
+  const math::Matrix projection =
+      math::Matrix::perspective(1.2f, 1.5f, 0.1f, 100.f);
+
+  std::printf("%-6s %8s %12s %8s %14s\n", "order", "rows", "multiply-adds",
+              "allocs", "ns/evaluation");
+  run<12>(rotate, translate, projection);
+  run<1 << 10>(rotate, translate, projection);
+  run<1 << 14>(rotate, translate, projection);
+  return 0;
+}
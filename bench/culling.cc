@@ -0,0 +1,77 @@
+// Frustum culling of random boxes: testing every box against the frustum,
+// the BVH on one thread and on every hardware thread, and refitting it.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <math/Frustum.hh>
+#include <math/Mat.hh>
+#include <numbers>
+#include <random>
+#include <scene/Bvh.hh>
+#include <utils/jobs.hh>
+#include <vector>
+
+// Each measurement runs for about this long.
+constexpr std::chrono::milliseconds budget{200};
+
+// Microseconds per call of `work`.
+double measure(const std::function<void()>& work) {
+  using clock = std::chrono::steady_clock;
+  unsigned long calls = 0;
+  const clock::time_point started = clock::now();
+  clock::duration elapsed{};
+  do {
+    work();
+    calls++;
+    elapsed = clock::now() - started;
+  } while (elapsed < budget);
+  return std::chrono::duration<double, std::micro>{elapsed}.count() / calls;
+}
+
+int main(const int argc, const char* argv[]) {
+  utils::JobSystem jobs;
+  const math::Frustum frustum{math::perspective(
+      std::numbers::pi_v<float> / 4, 1, 0.1f, 100)};
+
+  std::printf("%10s %10s %12s %12s %12s %12s\n", "objects", "visible",
+              "us/brute", "us/bvh", "us/threads", "us/refit");
+  for (unsigned count = 1 << 10; count <= 1 << 20; count <<= 2) {
+    std::mt19937 random{count};
+    std::uniform_real_distribution<float> coordinate{-100, 100};
+    std::vector<math::Aabb> boxes;
+    for (unsigned i = 0; i < count; i++) {
+      const math::Vec3 center{coordinate(random), coordinate(random),
+                              coordinate(random)};
+      boxes.push_back({math::Vec3{center[0] - 0.5f, center[1] - 0.5f,
+                                  center[2] - 0.5f},
+                       math::Vec3{center[0] + 0.5f, center[1] + 0.5f,
+                                  center[2] + 0.5f}});
+    }
+    scene::Bvh bvh;
+    bvh.build(boxes);
+
+    std::vector<scene::Bvh::Object> visible;
+    visible.reserve(count);
+    const double brute = measure([&] {
+      visible.clear();
+      for (scene::Bvh::Object object = 0; object < count; object++) {
+        if (frustum.intersects(boxes[object])) visible.push_back(object);
+      }
+    });
+    const double single = measure([&] {
+      visible.clear();
+      bvh.cull(frustum, visible);
+    });
+    const std::size_t visible_count = visible.size();
+    const double parallel = measure([&] {
+      visible.clear();
+      bvh.cull(frustum, visible, &jobs);
+    });
+    const double refit = measure([&] { bvh.refit(boxes); });
+    std::printf("%10u %10zu %12.1f %12.1f %12.1f %12.1f\n", count,
+                visible_count, brute, single, parallel, refit);
+  }
+  return 0;
+}
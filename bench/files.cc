@@ -0,0 +1,115 @@
+// Milliseconds to load and read through files: utils::readFile against
+// utils::MappedFile, for many small files and one large one, and the
+// parallel utils::FileBatch for the small ones. "cold" passes first evict the
+// files from the page cache with posix_fadvise(POSIX_FADV_DONTNEED).
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utils/fs.hh>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+constexpr unsigned small_count = 512;
+constexpr std::size_t small_size = 4 << 10;
+constexpr std::size_t large_size = 128 << 20;
+constexpr std::chrono::milliseconds budget{500};
+
+// Every byte is read, as a parser would.
+std::size_t checksum(std::span<const std::byte> bytes) {
+  std::size_t sum = 0;
+  for (const std::byte byte : bytes) sum += static_cast<unsigned char>(byte);
+  return sum;
+}
+
+void evict(std::span<const fs::path> paths) {
+  for (const fs::path& path : paths) {
+    const int descriptor = open(path.c_str(), O_RDONLY);
+    posix_fadvise(descriptor, 0, 0, POSIX_FADV_DONTNEED);
+    close(descriptor);
+  }
+}
+
+volatile std::size_t sink;
+
+// Runs `pass` for the budget and prints the mean time per pass.
+template <typename Pass>
+void measure(std::string_view files, std::string_view method, bool cold,
+             std::span<const fs::path> paths, Pass pass) {
+  using clock = std::chrono::steady_clock;
+  unsigned long passes = 0;
+  clock::duration elapsed{};
+  do {
+    if (cold) evict(paths);
+    const clock::time_point started = clock::now();
+    sink = pass();
+    elapsed += clock::now() - started;
+    passes++;
+  } while (elapsed < budget && passes < 1000);
+
+  const double milliseconds =
+      std::chrono::duration<double, std::milli>{elapsed}.count();
+  std::printf("%-8s %-12s %-6s %10.3f\n", files.data(), method.data(),
+              cold ? "cold" : "warm", milliseconds / passes);
+}
+
+void write(const fs::path& path, std::size_t size) {
+  std::string contents(size, '\0');
+  for (std::size_t i = 0; i < size; i++) contents[i] = static_cast<char>(i);
+  std::ofstream{path, std::ios::binary}.write(contents.data(), size);
+}
+
+int main(const int argc, const char* argv[]) {
+  const fs::path directory = fs::temp_directory_path() / "files_benchmark";
+  fs::create_directories(directory);
+  std::vector<fs::path> small;
+  for (unsigned i = 0; i < small_count; i++) {
+    small.push_back(directory / ("small" + std::to_string(i)));
+    write(small.back(), small_size);
+  }
+  const std::vector<fs::path> large{directory / "large"};
+  write(large[0], large_size);
+
+  std::printf("%-8s %-12s %-6s %10s\n", "files", "method", "cache", "ms");
+  for (const bool cold : {false, true}) {
+    const auto read = [](std::span<const fs::path> paths) {
+      std::size_t sum = 0;
+      for (const fs::path& path : paths) {
+        const std::string contents = utils::readFile(path);
+        sum += checksum(std::as_bytes(std::span{contents}));
+      }
+      return sum;
+    };
+    const auto map = [](std::span<const fs::path> paths) {
+      std::size_t sum = 0;
+      for (const fs::path& path : paths) {
+        sum += checksum(utils::MappedFile{path}.bytes());
+      }
+      return sum;
+    };
+    measure("small", "readFile", cold, small, [&] { return read(small); });
+    measure("small", "MappedFile", cold, small, [&] { return map(small); });
+    measure("small", "FileBatch", cold, small, [&] {
+      utils::FileBatch batch{small};
+      std::size_t sum = 0;
+      for (std::size_t i = 0; i < batch.size(); i++) {
+        sum += checksum(batch.get(i).bytes());
+      }
+      return sum;
+    });
+    measure("large", "readFile", cold, large, [&] { return read(large); });
+    measure("large", "MappedFile", cold, large, [&] { return map(large); });
+  }
+
+  fs::remove_all(directory);
+  return 0;
+}
@@ -0,0 +1,68 @@
+// Vertices transformed per microsecond by math::simd::transform4, split over
+// a utils::JobSystem with parallelFor, for growing thread counts. Speedup is
+// against one thread; the large batch does not fit the caches and levels off
+// at the memory bandwidth.
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <math/Mat.hh>
+#include <math/simd.hh>
+#include <random>
+#include <thread>
+#include <utils/jobs.hh>
+#include <vector>
+
+constexpr std::chrono::milliseconds budget{200};
+
+// Microseconds per call of `work`, over the budget.
+template <typename Work>
+double measure(Work work) {
+  using clock = std::chrono::steady_clock;
+  unsigned long calls = 0;
+  const clock::time_point started = clock::now();
+  clock::duration elapsed{};
+  do {
+    work();
+    calls++;
+    elapsed = clock::now() - started;
+  } while (elapsed < budget);
+  return std::chrono::duration<double, std::micro>{elapsed}.count() / calls;
+}
+
+int main(const int argc, const char* argv[]) {
+  const unsigned hardware =
+      std::max(std::thread::hardware_concurrency(), 1u);
+  const math::Mat4 matrix = math::rotate4x4(1, 2, 3, 0.5f) *
+                            math::translate4x4(1, 2, 3) *
+                            math::perspective(1, 1.5f, 0.1f, 100);
+
+  std::printf("%10s %8s %12s %10s\n", "vertices", "threads", "per us",
+              "speedup");
+  for (const std::size_t count : {std::size_t{1} << 14, std::size_t{1} << 17,
+                                  std::size_t{1} << 21}) {
+    std::mt19937 random{3};
+    std::uniform_real_distribution<float> coordinate{-10, 10};
+    std::vector<float> vertices(4 * count), out(4 * count);
+    for (std::size_t i = 0; i < count; i++) {
+      for (unsigned c = 0; c < 3; c++) vertices[4 * i + c] = coordinate(random);
+      vertices[4 * i + 3] = 1;
+    }
+
+    double single = 0;
+    for (unsigned threads = 1; threads <= hardware; threads *= 2) {
+      utils::JobSystem jobs{threads};
+      const double microseconds = measure([&] {
+        jobs.parallelFor(0, count, [&](std::size_t begin, std::size_t end) {
+          math::simd::transform4(vertices.data() + 4 * begin, end - begin,
+                                 matrix.pointer(), out.data() + 4 * begin);
+        });
+      });
+      if (threads == 1) single = microseconds;
+      std::printf("%10zu %8u %12.1f %10.2f\n", count, threads,
+                  count / microseconds, single / microseconds);
+    }
+  }
+  return 0;
+}
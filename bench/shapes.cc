@@ -0,0 +1,65 @@
+// Shape updates per millisecond for growing store sizes and every
+// instruction set the CPU supports.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <math/Mat.hh>
+#include <math/simd.hh>
+#include <scene/Shapes.hh>
+#include <string_view>
+
+constexpr float step = 1.f / 60.f;
+// Each size runs for about this long.
+constexpr std::chrono::milliseconds budget{200};
+
+std::string_view isaName(math::simd::Isa isa) {
+  switch (isa) {
+    case math::simd::Isa::scalar:
+      return "scalar";
+    case math::simd::Isa::sse:
+      return "sse";
+    case math::simd::Isa::avx2:
+      return "avx2";
+  }
+  return "unknown";
+}
+
+int main(const int argc, const char* argv[]) {
+  using clock = std::chrono::steady_clock;
+  const math::simd::Isa best = math::simd::detect();
+
+  std::printf("%-8s %10s %14s %16s\n", "isa", "shapes", "us/update",
+              "updates/ms");
+  for (unsigned count = 1 << 10; count <= 1 << 24; count <<= 2) {
+    scene::Shapes shapes{0.25f};
+    for (unsigned i = 0; i < count; i++) {
+      shapes.add(i * 0.001f, 1.f + i % 3, 0.9f, 0.01f, math::Vec3{1, 1, 1});
+    }
+    scene::Shapes::Frame frame;
+    shapes.update(step, frame);
+
+    for (const math::simd::Isa isa :
+         {math::simd::Isa::scalar, math::simd::Isa::sse,
+          math::simd::Isa::avx2}) {
+      if (isa > best) continue;
+      math::simd::setIsa(isa);
+
+      unsigned long updates = 0;
+      const clock::time_point started = clock::now();
+      clock::duration elapsed{};
+      do {
+        shapes.update(step, frame);
+        updates++;
+        elapsed = clock::now() - started;
+      } while (elapsed < budget);
+
+      const double microseconds =
+          std::chrono::duration<double, std::micro>{elapsed}.count() /
+          updates;
+      std::printf("%-8s %10u %14.2f %16.0f\n", isaName(isa).data(), count,
+                  microseconds, count / microseconds * 1000);
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,129 @@
+// Composed transforms per microsecond: 4x4 matrix products against
+// math::Transform, one at a time and in SoA batches on every supported
+// instruction set, plus the batch conversion to matrices done at upload.
+
+#include <chrono>
+#include <cstdio>
+#include <math/Mat.hh>
+#include <math/Transform.hh>
+#include <math/simd.hh>
+#include <random>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+constexpr unsigned count = 1 << 12;
+constexpr std::chrono::milliseconds budget{200};
+
+std::string_view isaName(math::simd::Isa isa) {
+  switch (isa) {
+    case math::simd::Isa::scalar:
+      return "scalar";
+    case math::simd::Isa::sse:
+      return "sse";
+    case math::simd::Isa::avx2:
+      return "avx2";
+  }
+  return "unknown";
+}
+
+// Runs `pass` over all transforms for the budget and prints the throughput.
+template <typename Pass>
+void measure(std::string_view method, Pass pass) {
+  using clock = std::chrono::steady_clock;
+  unsigned long passes = 0;
+  const clock::time_point started = clock::now();
+  clock::duration elapsed{};
+  do {
+    pass();
+    passes++;
+    elapsed = clock::now() - started;
+  } while (elapsed < budget);
+
+  const double microseconds =
+      std::chrono::duration<double, std::micro>{elapsed}.count();
+  std::printf("%-24s %12.1f\n", method.data(), passes * count / microseconds);
+}
+
+// Ten arrays: translation, rotation and scale components.
+struct Batch {
+  std::vector<float> values = std::vector<float>(10 * count);
+
+  std::span<float> array(unsigned index) {
+    return std::span{values}.subspan(index * count, count);
+  }
+
+  math::TransformArrays<float> arrays() {
+    return {array(0), array(1), array(2),
+            {array(3), array(4), array(5), array(6)},
+            array(7), array(8), array(9)};
+  }
+};
+
+int main(const int argc, const char* argv[]) {
+  std::mt19937 random{3};
+  std::uniform_real_distribution<float> unit{-1, 1};
+  std::vector<math::Transform> locals(count), parents(count),
+      worlds(count);
+  for (unsigned i = 0; i < count; i++) {
+    for (math::Transform* t : {&locals[i], &parents[i]}) {
+      t->translation = math::Vec3{unit(random), unit(random), unit(random)};
+      t->rotation = math::normalize(
+          math::Quat{unit(random), unit(random), unit(random), unit(random)});
+      const float scale = 1 + unit(random) / 2;
+      t->scale = math::Vec3{scale, scale, scale};
+    }
+  }
+  std::vector<math::Mat4> local_matrices(count), parent_matrices(count),
+      world_matrices(count);
+  Batch local_batch, parent_batch, world_batch;
+  for (unsigned i = 0; i < count; i++) {
+    local_matrices[i] = math::toMat4(locals[i]);
+    parent_matrices[i] = math::toMat4(parents[i]);
+    for (auto [batch, t] :
+         {std::pair{&local_batch, &locals[i]},
+          std::pair{&parent_batch, &parents[i]}}) {
+      const math::TransformArrays<float> arrays = batch->arrays();
+      arrays.tx[i] = t->translation[0];
+      arrays.ty[i] = t->translation[1];
+      arrays.tz[i] = t->translation[2];
+      arrays.rotation.x[i] = t->rotation.x;
+      arrays.rotation.y[i] = t->rotation.y;
+      arrays.rotation.z[i] = t->rotation.z;
+      arrays.rotation.w[i] = t->rotation.w;
+      arrays.sx[i] = t->scale[0];
+      arrays.sy[i] = t->scale[1];
+      arrays.sz[i] = t->scale[2];
+    }
+  }
+
+  const math::simd::Isa best = math::simd::detect();
+  std::printf("%-24s %12s\n", "method", "per us");
+  measure("mat4 product", [&] {
+    for (unsigned i = 0; i < count; i++) {
+      world_matrices[i] = local_matrices[i] * parent_matrices[i];
+    }
+  });
+  measure("transform product", [&] {
+    for (unsigned i = 0; i < count; i++) {
+      worlds[i] = locals[i] * parents[i];
+    }
+  });
+  for (const math::simd::Isa isa :
+       {math::simd::Isa::scalar, math::simd::Isa::sse,
+        math::simd::Isa::avx2}) {
+    if (isa > best) continue;
+    math::simd::setIsa(isa);
+    const std::string suffix = std::string{" "} + isaName(isa).data();
+    measure("batch product" + suffix, [&] {
+      math::multiply(local_batch.arrays(), parent_batch.arrays(),
+                     world_batch.arrays());
+    });
+    measure("batch toMat4" + suffix, [&] {
+      math::toMat4(local_batch.arrays(), world_matrices);
+    });
+  }
+  math::simd::setIsa(best);
+  return 0;
+}
@@ -0,0 +1,91 @@
+// Sine and cosine pairs per microsecond: std::sin with std::cos, the fused
+// scalar math::sincos and the batch version on every supported instruction
+// set, at both accuracy levels.
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <math/simd.hh>
+#include <math/trig.hh>
+#include <string>
+#include <string_view>
+#include <vector>
+
+constexpr unsigned count = 1 << 12;
+constexpr std::chrono::milliseconds budget{200};
+
+std::string_view isaName(math::simd::Isa isa) {
+  switch (isa) {
+    case math::simd::Isa::scalar:
+      return "scalar";
+    case math::simd::Isa::sse:
+      return "sse";
+    case math::simd::Isa::avx2:
+      return "avx2";
+  }
+  return "unknown";
+}
+
+std::string_view accuracyName(math::Accuracy accuracy) {
+  return accuracy == math::Accuracy::precise ? "precise" : "fast";
+}
+
+std::vector<float> angles(count);
+std::vector<float> sines(count);
+std::vector<float> cosines(count);
+
+// Runs `pass` over all angles for the budget and prints the throughput.
+template <typename Pass>
+void measure(std::string_view method, std::string_view accuracy, Pass pass) {
+  using clock = std::chrono::steady_clock;
+  unsigned long passes = 0;
+  const clock::time_point started = clock::now();
+  clock::duration elapsed{};
+  do {
+    pass();
+    passes++;
+    elapsed = clock::now() - started;
+  } while (elapsed < budget);
+
+  const double microseconds =
+      std::chrono::duration<double, std::micro>{elapsed}.count();
+  std::printf("%-16s %-8s %12.1f\n", method.data(), accuracy.data(),
+              passes * count / microseconds);
+}
+
+int main(const int argc, const char* argv[]) {
+  for (unsigned i = 0; i < count; i++) {
+    angles[i] = (static_cast<int>(i) - static_cast<int>(count / 2)) * 0.01f;
+  }
+
+  std::printf("%-16s %-8s %12s\n", "method", "accuracy", "pairs/us");
+  measure("std::sin+cos", "libm", [] {
+    for (unsigned i = 0; i < count; i++) {
+      sines[i] = std::sin(angles[i]);
+      cosines[i] = std::cos(angles[i]);
+    }
+  });
+
+  const math::simd::Isa best = math::simd::detect();
+  for (const math::Accuracy accuracy :
+       {math::Accuracy::precise, math::Accuracy::fast}) {
+    measure("sincos", accuracyName(accuracy), [accuracy] {
+      for (unsigned i = 0; i < count; i++) {
+        const math::SinCos result = math::sincos(angles[i], accuracy);
+        sines[i] = result.sin;
+        cosines[i] = result.cos;
+      }
+    });
+    for (const math::simd::Isa isa :
+         {math::simd::Isa::scalar, math::simd::Isa::sse,
+          math::simd::Isa::avx2}) {
+      if (isa > best) continue;
+      math::simd::setIsa(isa);
+      const std::string method = std::string{"batch "} + isaName(isa).data();
+      measure(method, accuracyName(accuracy),
+              [accuracy] { math::sincos(angles, sines, cosines, accuracy); });
+    }
+    math::simd::setIsa(best);
+  }
+  return 0;
+}
@@ -0,0 +1,74 @@
+#include "counters.hh"
+
+#include <malloc.h>
+#include <sys/resource.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace heap {
+namespace {
+// Constant-initialized, so allocations made by other static initializers
+// before this file's are counted too.
+constinit std::atomic<bool> hooked{false};
+constinit thread_local Counters local;
+constinit std::atomic<std::uint64_t> allocations{0};
+constinit std::atomic<std::uint64_t> deallocations{0};
+constinit std::atomic<std::uint64_t> allocated_bytes{0};
+constinit std::atomic<std::uint64_t> freed_bytes{0};
+}  // namespace
+
+Counters& Counters::operator+=(const Counters& other) {
+  allocations += other.allocations;
+  deallocations += other.deallocations;
+  allocated_bytes += other.allocated_bytes;
+  freed_bytes += other.freed_bytes;
+  return *this;
+}
+
+Counters operator-(const Counters& left, const Counters& right) {
+  return {left.allocations - right.allocations,
+          left.deallocations - right.deallocations,
+          left.allocated_bytes - right.allocated_bytes,
+          left.freed_bytes - right.freed_bytes};
+}
+
+bool installed() { return hooked.load(std::memory_order_relaxed); }
+
+Counters thread() { return local; }
+
+Counters process() {
+  return {allocations.load(std::memory_order_relaxed),
+          deallocations.load(std::memory_order_relaxed),
+          allocated_bytes.load(std::memory_order_relaxed),
+          freed_bytes.load(std::memory_order_relaxed)};
+}
+
+std::size_t peakRss() {
+  rusage usage{};
+  getrusage(RUSAGE_SELF, &usage);
+  // Linux reports kilobytes.
+  return static_cast<std::size_t>(usage.ru_maxrss) * 1024;
+}
+
+namespace detail {
+void install() { hooked.store(true, std::memory_order_relaxed); }
+
+void allocated(void* pointer) {
+  const std::size_t size = malloc_usable_size(pointer);
+  local.allocations++;
+  local.allocated_bytes += size;
+  allocations.fetch_add(1, std::memory_order_relaxed);
+  allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+}
+
+void freed(void* pointer) {
+  const std::size_t size = malloc_usable_size(pointer);
+  local.deallocations++;
+  local.freed_bytes += size;
+  deallocations.fetch_add(1, std::memory_order_relaxed);
+  freed_bytes.fetch_add(size, std::memory_order_relaxed);
+}
+}  // namespace detail
+}  // namespace heap
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace heap {
+// Heap use as seen by the global operator new and delete. Counting is
+// opt-in: link the `heap-hooks` object library to replace the operators,
+// otherwise installed() is false and every counter stays zero.
+//
+// Sizes are what malloc reserved for each block (malloc_usable_size), so
+// freed bytes balance allocated bytes exactly.
+struct Counters {
+  std::uint64_t allocations = 0;
+  std::uint64_t deallocations = 0;
+  std::uint64_t allocated_bytes = 0;
+  std::uint64_t freed_bytes = 0;
+
+  Counters& operator+=(const Counters& other);
+};
+
+Counters operator-(const Counters& left, const Counters& right);
+
+bool installed();
+// Operations made by the calling thread, so work on other threads does not
+// show up in a frame or zone measured around it.
+Counters thread();
+// Operations made by all threads.
+Counters process();
+// Highest resident set size of the process so far, in bytes.
+std::size_t peakRss();
+
+namespace detail {
+// Called by the replaced operators.
+void install();
+void allocated(void* pointer);
+void freed(void* pointer);
+}  // namespace detail
+}  // namespace heap
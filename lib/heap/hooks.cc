@@ -0,0 +1,55 @@
+// Replacements of the global operator new and delete that report to
+// heap::detail. Only the plain and aligned forms are replaced: the standard
+// library implements the array, sized and nothrow forms by calling these.
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+#include "counters.hh"
+
+namespace {
+// Runs the new handler until malloc succeeds, as the default operator new
+// does.
+template <typename Allocate>
+void* allocateOrThrow(Allocate allocate) {
+  for (;;) {
+    if (void* pointer = allocate()) {
+      heap::detail::allocated(pointer);
+      return pointer;
+    }
+    const std::new_handler handler = std::get_new_handler();
+    if (handler == nullptr) throw std::bad_alloc{};
+    handler();
+  }
+}
+
+const bool installed = (heap::detail::install(), true);
+}  // namespace
+
+void* operator new(std::size_t size) {
+  if (size == 0) size = 1;
+  return allocateOrThrow([size] { return std::malloc(size); });
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+  const auto align = static_cast<std::size_t>(alignment);
+  // aligned_alloc wants a multiple of the alignment.
+  const std::size_t rounded = (std::max<std::size_t>(size, 1) + align - 1) /
+                              align * align;
+  return allocateOrThrow(
+      [align, rounded] { return std::aligned_alloc(align, rounded); });
+}
+
+void operator delete(void* pointer) noexcept {
+  if (pointer == nullptr) return;
+  heap::detail::freed(pointer);
+  std::free(pointer);
+}
+
+void operator delete(void* pointer, std::align_val_t) noexcept {
+  if (pointer == nullptr) return;
+  heap::detail::freed(pointer);
+  std::free(pointer);
+}
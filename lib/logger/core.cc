@@ -0,0 +1,162 @@
+#include "core.hh"
+
+#include <syslog.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <filesystem>
+#include <optional>
+#include <stop_token>
+#include <string>
+#include <string_view>
+#include <thread>
+
+namespace logger {
+namespace {
+constexpr std::size_t ring_capacity = 1024;
+
+class Backend {
+  detail::Ring<detail::Record, ring_capacity> ring;
+  std::atomic<bool> active{false};
+  // Producers between Producer's constructor and destructor.
+  std::atomic<unsigned> producers{0};
+  std::atomic<Overflow> overflow{Overflow::drop};
+  std::atomic<std::uint64_t> dropped_count{0};
+  std::uint64_t reported_dropped = 0;
+  std::jthread thread;
+
+  bool consumeOne(std::string& message) {
+    detail::Record* record = ring.front();
+    if (record == nullptr) return false;
+    if (record->consume == nullptr) {
+      ring.pop();
+      return true;
+    }
+    try {
+      record->consume(record->payload, record->format, message);
+    } catch (const std::exception& exception) {
+      message = std::string{record->format} + " (" + exception.what() + ")";
+    }
+    detail::write(record->level, record->location, message);
+    ring.pop();
+    return true;
+  }
+
+  void reportDropped() {
+    const std::uint64_t dropped = dropped_count.load(std::memory_order_relaxed);
+    if (dropped == reported_dropped) return;
+    syslog(LOG_WARNING, "Logger queue overflow: %llu messages dropped",
+           static_cast<unsigned long long>(dropped - reported_dropped));
+    reported_dropped = dropped;
+  }
+
+  void run(std::stop_token stop) {
+    std::string message;
+    unsigned idle = 0;
+    while (true) {
+      if (consumeOne(message)) {
+        idle = 0;
+        continue;
+      }
+      reportDropped();
+      // Stop only once the queue is drained.
+      if (stop.stop_requested()) break;
+      if (++idle < 64) {
+        std::this_thread::yield();
+      } else {
+        std::this_thread::sleep_for(std::chrono::milliseconds{1});
+      }
+    }
+  }
+
+ public:
+  ~Backend() { stop(); }
+
+  void start() {
+    if (active.exchange(true)) return;
+    thread = std::jthread{[this](std::stop_token stop) { run(stop); }};
+  }
+
+  void stop() {
+    if (!active.exchange(false)) return;
+    // Producers that saw the flag set finish queueing first: the thread
+    // stops once the queue is empty, and an unpublished slot would end its
+    // drain early. It keeps running meanwhile, making room for them.
+    while (producers.load() > 0) std::this_thread::yield();
+    thread.request_stop();
+    thread.join();
+  }
+
+  // Both sides write one flag and then read the other's, so either the
+  // producer sees the flag cleared or stop() sees the producer.
+  bool enter() {
+    producers.fetch_add(1);
+    if (active.load()) return true;
+    producers.fetch_sub(1);
+    return false;
+  }
+
+  void leave() { producers.fetch_sub(1); }
+
+  std::optional<detail::Claim<detail::Record>> claim() {
+    while (true) {
+      std::optional<detail::Claim<detail::Record>> claimed = ring.claim();
+      if (claimed) return claimed;
+      // Waiting would hold up close(), which is stopping the thread.
+      if (overflow.load(std::memory_order_relaxed) == Overflow::drop ||
+          !active.load(std::memory_order_relaxed)) {
+        dropped_count.fetch_add(1, std::memory_order_relaxed);
+        return std::nullopt;
+      }
+      std::this_thread::yield();
+    }
+  }
+
+  void publish(std::size_t position) { ring.publish(position); }
+
+  void setOverflow(Overflow policy) { overflow.store(policy); }
+
+  std::uint64_t dropped() const { return dropped_count.load(); }
+};
+
+Backend& backend() {
+  static Backend instance;
+  return instance;
+}
+}  // namespace
+
+namespace detail {
+Producer::Producer() : queued{backend().enter()} {}
+
+Producer::~Producer() {
+  if (queued) backend().leave();
+}
+
+std::optional<Claim<Record>> claim() { return backend().claim(); }
+
+void publish(std::size_t position) { backend().publish(position); }
+
+void write(int level, const src_loc& location, std::string_view message) {
+  const std::filesystem::path full_path = location.file_name();
+  syslog(level, "%s:%d %.*s", full_path.filename().c_str(), location.line(),
+         static_cast<int>(message.size()), message.data());
+}
+}  // namespace detail
+
+void open(std::string_view name) {
+  openlog(name.data(), LOG_CONS | LOG_PERROR | LOG_PID, LOG_USER);
+  backend().start();
+}
+
+void close() {
+  backend().stop();
+  closelog();
+}
+
+void setOverflow(Overflow overflow) { backend().setOverflow(overflow); }
+
+std::uint64_t dropped() { return backend().dropped(); }
+}  // namespace logger
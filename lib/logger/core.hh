@@ -2,53 +2,184 @@
 
 #include <syslog.h>
 
-#include <filesystem>
+#include <cstddef>
+#include <cstdint>
 #include <format>
-#include <iostream>
+#include <new>
+#include <optional>
 #include <source_location>
 #include <string>
 #include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "ring.hh"
+
+// Calls below this syslog level are compiled out entirely.
+#ifndef LOGGER_MIN_LEVEL
+#ifdef NDEBUG
+#define LOGGER_MIN_LEVEL LOG_INFO
+#else
+#define LOGGER_MIN_LEVEL LOG_DEBUG
+#endif
+#endif
 
 namespace logger {
 using src_loc = std::source_location;
 
-void open(std::string_view name) {
-  openlog(name.data(), LOG_CONS | LOG_PERROR | LOG_PID, LOG_USER);
+constexpr int min_level = LOGGER_MIN_LEVEL;
+
+// What a full queue does with a new message.
+enum class Overflow { drop, block };
+
+// Format strings must be string literals: they are read later by the
+// background thread, so they have to outlive the call.
+struct Format {
+  std::string_view text;
+
+  consteval Format(const char* text) : text{text} {}
+};
+
+namespace detail {
+constexpr std::size_t payload_size = 160;
+
+// One queued message: the captured arguments live in `payload` and are
+// formatted and destroyed by `consume` on the background thread, which
+// skips records without one.
+struct Record {
+  int level;
+  src_loc location;
+  std::string_view format;
+  void (*consume)(std::byte* payload, std::string_view format,
+                  std::string& out);
+  alignas(std::max_align_t) std::byte payload[payload_size];
+};
+
+// Registers a message being queued for the producer's lifetime, so that
+// close() waits for it before stopping the background thread.
+class Producer {
+  bool queued;
+
+ public:
+  Producer();
+  ~Producer();
+
+  Producer(const Producer&) = delete;
+  Producer& operator=(const Producer&) = delete;
+
+  // Whether the background thread takes the message; without it messages
+  // are written synchronously, as before open().
+  bool running() const { return queued; }
+};
+
+// Reserves a slot in the queue, or returns nothing if the message is dropped.
+std::optional<Claim<Record>> claim();
+void publish(std::size_t position);
+void write(int level, const src_loc& location, std::string_view message);
+
+// Strings are copied, because views and pointers may dangle by the time the
+// background thread formats them; everything else is captured by value.
+template <typename T>
+using Stored =
+    std::conditional_t<std::is_convertible_v<const std::decay_t<T>&,
+                                             std::string_view>,
+                       std::string, std::decay_t<T>>;
+
+template <typename Payload>
+void consume(std::byte* storage, std::string_view format, std::string& out) {
+  Payload* payload = std::launder(reinterpret_cast<Payload*>(storage));
+  try {
+    // Format specs are only checked here, so this may throw.
+    out = std::apply(
+        [format](auto&... args) {
+          return std::vformat(format, std::make_format_args(args...));
+        },
+        *payload);
+  } catch (...) {
+    payload->~Payload();
+    throw;
+  }
+  payload->~Payload();
+}
+
+template <typename... Args>
+void enqueue(int level, const src_loc& location, std::string_view format,
+             Args&&... args) {
+  using Payload = std::tuple<Stored<Args>...>;
+
+  const Producer producer;
+  if (!producer.running()) {
+    write(level, location,
+          std::vformat(format, std::make_format_args(args...)));
+    return;
+  }
+
+  if constexpr (sizeof(Payload) > payload_size ||
+                alignof(Payload) > alignof(std::max_align_t)) {
+    // Too large to capture inline: format here and queue the result.
+    enqueue(level, location, "{}",
+            std::vformat(format, std::make_format_args(args...)));
+  } else {
+    const std::optional<Claim<Record>> claimed = claim();
+    if (!claimed) return;
+    Record& record = *claimed->item;
+    record.level = level;
+    record.location = location;
+    record.format = format;
+    record.consume = &consume<Payload>;
+    try {
+      new (record.payload) Payload{std::forward<Args>(args)...};
+    } catch (...) {
+      // The slot is published empty, or it would hold back the queue.
+      record.consume = nullptr;
+      publish(claimed->position);
+      throw;
+    }
+    publish(claimed->position);
+  }
 }
 
-void log(int level, const src_loc& location, std::string_view format,
-         std::format_args&& args) {
-  const std::string message = std::vformat(format, args);
-  const std::filesystem::path full_path = location.file_name();
-  syslog(level, "%s:%d %s", full_path.filename().c_str(), location.line(),
-         message.c_str());
+template <int level>
+auto makeLogger(Format format, const src_loc& location) {
+  if constexpr (level > min_level) {
+    return [](auto&&...) {};
+  } else {
+    return [format, location](auto&&... args) {
+      enqueue(level, location, format.text,
+              std::forward<decltype(args)>(args)...);
+    };
+  }
 }
+}  // namespace detail
+
+// Starts the background thread that formats and writes queued messages.
+void open(std::string_view name);
+// Writes everything still queued and stops the background thread.
+void close();
+
+void setOverflow(Overflow overflow);
+// Messages lost because the queue was full, under Overflow::drop or while
+// close() was stopping the background thread.
+std::uint64_t dropped();
 
-auto logInfo(std::string_view format,
-             const src_loc& location = src_loc::current()) {
-  return [format, location](auto&&... args) {
-    log(LOG_INFO, location, format, std::make_format_args(args...));
-  };
+inline auto logInfo(Format format,
+                    const src_loc& location = src_loc::current()) {
+  return detail::makeLogger<LOG_INFO>(format, location);
 }
 
-auto logWarning(std::string_view format,
-                const src_loc& location = src_loc::current()) {
-  return [format, location](auto&&... args) {
-    log(LOG_WARNING, location, format, std::make_format_args(args...));
-  };
+inline auto logWarning(Format format,
+                       const src_loc& location = src_loc::current()) {
+  return detail::makeLogger<LOG_WARNING>(format, location);
 }
 
-auto logError(std::string_view format,
-              const src_loc& location = src_loc::current()) {
-  return [format, location](auto&&... args) {
-    log(LOG_ERR, location, format, std::make_format_args(args...));
-  };
+inline auto logError(Format format,
+                     const src_loc& location = src_loc::current()) {
+  return detail::makeLogger<LOG_ERR>(format, location);
 }
 
-auto logDebug(std::string_view format,
-              const src_loc& location = src_loc::current()) {
-  return [format, location](auto&&... args) {
-    log(LOG_DEBUG, location, format, std::make_format_args(args...));
-  };
+inline auto logDebug(Format format,
+                     const src_loc& location = src_loc::current()) {
+  return detail::makeLogger<LOG_DEBUG>(format, location);
 }
 }  // namespace logger
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <optional>
+
+namespace logger::detail {
+// A slot reserved by Ring::claim(), to fill and then publish.
+template <typename T>
+struct Claim {
+  T* item;
+  std::size_t position;
+};
+
+// Bounded multi-producer, single-consumer queue. Each slot's sequence number
+// says whose turn it is: producers claim a position with one CAS on `head`
+// and hand the slot over by bumping its sequence, so no thread ever locks.
+template <typename T, std::size_t capacity>
+class Ring {
+  static_assert((capacity & (capacity - 1)) == 0,
+                "Ring capacity must be a power of two");
+
+  struct alignas(64) Slot {
+    std::atomic<std::size_t> sequence;
+    T item;
+  };
+
+  std::array<Slot, capacity> slots;
+  alignas(64) std::atomic<std::size_t> head{0};
+  alignas(64) std::size_t tail = 0;
+
+ public:
+  Ring() {
+    for (std::size_t index = 0; index < slots.size(); index++) {
+      slots[index].sequence.store(index, std::memory_order_relaxed);
+    }
+  }
+
+  Ring(const Ring&) = delete;
+  Ring& operator=(const Ring&) = delete;
+
+  // Any thread. Nothing when the ring is full.
+  std::optional<Claim<T>> claim() {
+    std::size_t position = head.load(std::memory_order_relaxed);
+    while (true) {
+      Slot& slot = slots[position & (capacity - 1)];
+      const std::size_t sequence =
+          slot.sequence.load(std::memory_order_acquire);
+      const auto difference = static_cast<std::ptrdiff_t>(sequence - position);
+      if (difference == 0) {
+        if (head.compare_exchange_weak(position, position + 1,
+                                       std::memory_order_relaxed)) {
+          return Claim<T>{&slot.item, position};
+        }
+      } else if (difference < 0) {
+        return std::nullopt;
+      } else {
+        position = head.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  // Hands a claimed slot to the consumer. Slots are consumed in claim
+  // order, so an unpublished one holds back the ones claimed after it.
+  void publish(std::size_t position) {
+    slots[position & (capacity - 1)].sequence.store(
+        position + 1, std::memory_order_release);
+  }
+
+  // Consumer only. The oldest published item, or nullptr.
+  T* front() {
+    Slot& slot = slots[tail & (capacity - 1)];
+    if (slot.sequence.load(std::memory_order_acquire) != tail + 1) {
+      return nullptr;
+    }
+    return &slot.item;
+  }
+
+  // Consumer only. Frees the slot of front().
+  void pop() {
+    slots[tail & (capacity - 1)].sequence.store(tail + capacity,
+                                                std::memory_order_release);
+    tail++;
+  }
+};
+}  // namespace logger::detail
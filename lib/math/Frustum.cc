@@ -0,0 +1,242 @@
+#include "Frustum.hh"
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#include "Mat.hh"
+#include "simd.hh"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define MATH_FRUSTUM_X86 1
+#include <immintrin.h>
+#endif
+
+namespace math {
+namespace {
+float distance(const Vec4& plane, float x, float y, float z) {
+  return plane[0] * x + plane[1] * y + plane[2] * z + plane[3];
+}
+
+// Pointers to one cullSpheres() call's arrays.
+struct Spheres {
+  const float* x;
+  const float* y;
+  const float* z;
+  const float* radius;
+};
+
+std::size_t cullScalar(const std::array<Vec4, Frustum::plane_count>& planes,
+                       const Spheres& spheres, std::size_t begin,
+                       std::size_t end, std::uint32_t first,
+                       std::uint32_t* visible) {
+  std::size_t written = 0;
+  for (std::size_t i = begin; i < end; i++) {
+    bool inside = true;
+    for (const Vec4& plane : planes) {
+      inside &= distance(plane, spheres.x[i], spheres.y[i], spheres.z[i]) >=
+                -spheres.radius[i];
+    }
+    if (inside) visible[written++] = first + i;
+  }
+  return written;
+}
+
+// Writes the lanes set in `mask` as indices starting at `index`.
+std::size_t compact(unsigned mask, std::uint32_t index,
+                    std::uint32_t* visible) {
+  std::size_t written = 0;
+  while (mask != 0) {
+    visible[written++] = index + std::countr_zero(mask);
+    mask &= mask - 1;
+  }
+  return written;
+}
+
+#ifdef MATH_FRUSTUM_X86
+// Same operations in the same order as the scalar loop, so the lanes agree
+// with it exactly.
+std::size_t cullSse(const std::array<Vec4, Frustum::plane_count>& planes,
+                    const Spheres spheres, std::size_t count,
+                    std::uint32_t first, std::uint32_t* visible) {
+  const __m128 sign = _mm_set1_ps(-0.f);
+  std::size_t written = 0;
+  std::size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    const __m128 x = _mm_loadu_ps(spheres.x + i);
+    const __m128 y = _mm_loadu_ps(spheres.y + i);
+    const __m128 z = _mm_loadu_ps(spheres.z + i);
+    const __m128 limit = _mm_xor_ps(_mm_loadu_ps(spheres.radius + i), sign);
+    __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+    for (const Vec4& plane : planes) {
+      const __m128 d = _mm_add_ps(
+          _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(plane[0]), x),
+                                _mm_mul_ps(_mm_set1_ps(plane[1]), y)),
+                     _mm_mul_ps(_mm_set1_ps(plane[2]), z)),
+          _mm_set1_ps(plane[3]));
+      inside = _mm_and_ps(inside, _mm_cmpge_ps(d, limit));
+    }
+    written += compact(_mm_movemask_ps(inside), first + i, visible + written);
+  }
+  return written + cullScalar(planes, spheres, i, count, first,
+                              visible + written);
+}
+
+__attribute__((target("avx2"))) std::size_t cullAvx2(
+    const std::array<Vec4, Frustum::plane_count>& planes,
+    const Spheres spheres, std::size_t count, std::uint32_t first,
+    std::uint32_t* visible) {
+  const __m256 sign = _mm256_set1_ps(-0.f);
+  std::size_t written = 0;
+  std::size_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    const __m256 x = _mm256_loadu_ps(spheres.x + i);
+    const __m256 y = _mm256_loadu_ps(spheres.y + i);
+    const __m256 z = _mm256_loadu_ps(spheres.z + i);
+    const __m256 limit =
+        _mm256_xor_ps(_mm256_loadu_ps(spheres.radius + i), sign);
+    __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+    for (const Vec4& plane : planes) {
+      const __m256 d = _mm256_add_ps(
+          _mm256_add_ps(
+              _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(plane[0]), x),
+                            _mm256_mul_ps(_mm256_set1_ps(plane[1]), y)),
+              _mm256_mul_ps(_mm256_set1_ps(plane[2]), z)),
+          _mm256_set1_ps(plane[3]));
+      inside = _mm256_and_ps(inside, _mm256_cmp_ps(d, limit, _CMP_GE_OQ));
+    }
+    written +=
+        compact(_mm256_movemask_ps(inside), first + i, visible + written);
+  }
+  return written + cullScalar(planes, spheres, i, count, first,
+                              visible + written);
+}
+#endif
+}  // namespace
+
+Vec3 Aabb::center() const {
+  return Vec3{(min[0] + max[0]) / 2, (min[1] + max[1]) / 2,
+              (min[2] + max[2]) / 2};
+}
+
+Vec3 Aabb::extent() const {
+  return Vec3{(max[0] - min[0]) / 2, (max[1] - min[1]) / 2,
+              (max[2] - min[2]) / 2};
+}
+
+float Aabb::surfaceArea() const {
+  const float x = std::max(max[0] - min[0], 0.f);
+  const float y = std::max(max[1] - min[1], 0.f);
+  const float z = std::max(max[2] - min[2], 0.f);
+  return 2 * (x * y + y * z + z * x);
+}
+
+void Aabb::merge(const Aabb& other) {
+  for (unsigned axis = 0; axis < 3; axis++) {
+    min[axis] = std::min(min[axis], other.min[axis]);
+    max[axis] = std::max(max[axis], other.max[axis]);
+  }
+}
+
+// Arvo's method: the new half-size along each axis sums the old ones scaled
+// by the absolute matrix entries.
+Aabb transform(const Aabb& box, const Mat4& matrix) {
+  const Vec3 center = box.center();
+  const Vec3 extent = box.extent();
+  Aabb result;
+  for (unsigned j = 0; j < 3; j++) {
+    float moved = matrix(3, j);
+    float spread = 0;
+    for (unsigned i = 0; i < 3; i++) {
+      moved += center[i] * matrix(i, j);
+      spread += extent[i] * std::fabs(matrix(i, j));
+    }
+    result.min[j] = moved - spread;
+    result.max[j] = moved + spread;
+  }
+  return result;
+}
+
+// Gribb and Hartmann: with clip = p * M, clip coordinate j is the dot
+// product with column j, and each side of the clip cube, -w <= x <= w and
+// so on, is the sum or difference of two columns.
+Frustum::Frustum(const Mat4& view_projection) {
+  const auto column = [&](unsigned j) {
+    return Vec4{view_projection(0, j), view_projection(1, j),
+                view_projection(2, j), view_projection(3, j)};
+  };
+  const Vec4 w = column(3);
+  for (unsigned axis = 0; axis < 3; axis++) {
+    const Vec4 c = column(axis);
+    for (unsigned k = 0; k < 4; k++) {
+      planes[axis * 2](0, k) = w[k] + c[k];
+      planes[axis * 2 + 1](0, k) = w[k] - c[k];
+    }
+  }
+  for (Vec4& plane : planes) {
+    const float length = std::sqrt(plane[0] * plane[0] + plane[1] * plane[1] +
+                                   plane[2] * plane[2]);
+    for (unsigned k = 0; k < 4; k++) plane[k] /= length;
+  }
+}
+
+const Vec4& Frustum::plane(unsigned index) const { return planes[index]; }
+
+bool Frustum::intersects(const Sphere& sphere) const {
+  for (const Vec4& plane : planes) {
+    if (distance(plane, sphere.center[0], sphere.center[1],
+                 sphere.center[2]) < -sphere.radius) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// A box is outside once its corner furthest along a plane's normal is.
+bool Frustum::intersects(const Aabb& box) const {
+  for (const Vec4& plane : planes) {
+    if (distance(plane, plane[0] >= 0 ? box.max[0] : box.min[0],
+                 plane[1] >= 0 ? box.max[1] : box.min[1],
+                 plane[2] >= 0 ? box.max[2] : box.min[2]) < 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool Frustum::contains(const Aabb& box) const {
+  for (const Vec4& plane : planes) {
+    if (distance(plane, plane[0] >= 0 ? box.min[0] : box.max[0],
+                 plane[1] >= 0 ? box.min[1] : box.max[1],
+                 plane[2] >= 0 ? box.min[2] : box.max[2]) < 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+std::size_t cullSpheres(const Frustum& frustum, std::span<const float> x,
+                        std::span<const float> y, std::span<const float> z,
+                        std::span<const float> radius, std::uint32_t first,
+                        std::uint32_t* visible) {
+  assert(y.size() == x.size() && z.size() == x.size() &&
+         radius.size() == x.size());
+  std::array<Vec4, Frustum::plane_count> planes;
+  for (unsigned i = 0; i < planes.size(); i++) planes[i] = frustum.plane(i);
+  const Spheres spheres{x.data(), y.data(), z.data(), radius.data()};
+  switch (simd::active()) {
+#ifdef MATH_FRUSTUM_X86
+    case simd::Isa::avx2:
+      return cullAvx2(planes, spheres, x.size(), first, visible);
+    case simd::Isa::sse:
+      return cullSse(planes, spheres, x.size(), first, visible);
+#endif
+    default:
+      return cullScalar(planes, spheres, 0, x.size(), first, visible);
+  }
+}
+}  // namespace math
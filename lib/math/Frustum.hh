@@ -0,0 +1,64 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#include "Mat.hh"
+
+namespace math {
+// Axis-aligned bounding box. The default one is empty: merging anything
+// into it yields that thing.
+struct Aabb {
+  Vec3 min{1e30f, 1e30f, 1e30f};
+  Vec3 max{-1e30f, -1e30f, -1e30f};
+
+  Vec3 center() const;
+  // Half of the size along each axis.
+  Vec3 extent() const;
+  float surfaceArea() const;
+  void merge(const Aabb& other);
+};
+
+// Box around `box` after transforming it with `matrix` (row vectors, affine).
+Aabb transform(const Aabb& box, const Mat4& matrix);
+
+struct Sphere {
+  Vec3 center;
+  float radius = 0;
+};
+
+// View volume as six planes (a, b, c, d) with a * x + b * y + c * z + d >= 0
+// inside and (a, b, c) of unit length, so the left side is a signed
+// distance.
+class Frustum {
+ public:
+  enum Plane { left, right, bottom, top, near, far };
+  static constexpr unsigned plane_count = 6;
+
+  // Volume that `view_projection` maps into the OpenGL clip cube, in the
+  // space it maps from: world space for a view-projection matrix.
+  explicit Frustum(const Mat4& view_projection);
+
+  const Vec4& plane(unsigned index) const;
+
+  bool intersects(const Sphere& sphere) const;
+  bool intersects(const Aabb& box) const;
+  // Whether `box` lies entirely inside, so its contents need no testing.
+  bool contains(const Aabb& box) const;
+
+ private:
+  std::array<Vec4, plane_count> planes;
+};
+
+// Tests the spheres given as separate x, y, z and radius arrays and writes
+// `first + i` for every sphere i that intersects the frustum to `visible`,
+// which must hold x.size() entries. Returns the number written. Uses the
+// instruction set picked by math::simd::active(); every ISA returns the
+// same spheres.
+std::size_t cullSpheres(const Frustum& frustum, std::span<const float> x,
+                        std::span<const float> y, std::span<const float> z,
+                        std::span<const float> radius, std::uint32_t first,
+                        std::uint32_t* visible);
+}  // namespace math
@@ -0,0 +1,51 @@
+#include "Mat.hh"
+
+#include <cmath>
+
+#include "trig.hh"
+
+namespace math {
+Mat4 rotate4x4x(const float theta) {
+  const auto [sina, cosa] = sincos(theta);
+  return Mat4{{{1, 0, 0, 0},
+               {0, cosa, sina, 0},
+               {0, -sina, cosa, 0},
+               {0, 0, 0, 1}}};
+}
+
+Mat4 rotate4x4y(const float theta) {
+  const auto [sina, cosa] = sincos(theta);
+  return Mat4{{{cosa, 0, -sina, 0},
+               {0, 1, 0, 0},
+               {sina, 0, cosa, 0},
+               {0, 0, 0, 1}}};
+}
+
+Mat4 rotate4x4z(const float theta) {
+  const auto [sina, cosa] = sincos(theta);
+  return Mat4{{{cosa, sina, 0, 0},
+               {-sina, cosa, 0, 0},
+               {0, 0, 1, 0},
+               {0, 0, 0, 1}}};
+}
+
+Mat4 rotate4x4(float x, float y, float z, float theta) {
+  const auto [sina, cosa] = sincos(theta);
+  return Mat4{{{cosa + x * x * (1 - cosa), y * x * (1 - cosa) + z * sina,
+                z * x * (1 - cosa) - y * sina, 0},
+               {x * y * (1 - cosa) - z * sina, cosa + y * y * (1 - cosa),
+                z * y * (1 - cosa) + x * sina, 0},
+               {x * z * (1 - cosa) + y * sina, y * z * (1 - cosa) - x * sina,
+                cosa + z * z * (1 - cosa), 0},
+               {0, 0, 0, 1}}};
+}
+
+Mat4 perspective(float fov, float aspect, float near, float far) {
+  const float top = near * std::tan(fov / 2.0f);
+  const float right = top * aspect;
+  return Mat4{{{near / right, 0, 0, 0},
+               {0, near / top, 0, 0},
+               {0, 0, -(far + near) / (far - near), -1},
+               {0, 0, -(2 * far * near) / (far - near), 0}}};
+}
+}  // namespace math
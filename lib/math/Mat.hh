@@ -0,0 +1,138 @@
+#pragma once
+
+#include <array>
+
+#include "simd.hh"
+
+namespace math {
+// Fixed-size row-major matrix. Dimensions are part of the type, so storage
+// lives on the stack and mismatched products are rejected at compile time.
+template <unsigned rows, unsigned cols>
+class Mat {
+  std::array<float, rows * cols> data{};
+
+ public:
+  constexpr Mat() = default;
+
+  constexpr Mat(const float (&values)[rows][cols]) {
+    for (unsigned i = 0; i < rows; i++) {
+      for (unsigned j = 0; j < cols; j++) {
+        data[i * cols + j] = values[i][j];
+      }
+    }
+  }
+
+  template <typename... T>
+    requires(rows == 1 && sizeof...(T) == cols)
+  constexpr Mat(T... values) : data{static_cast<float>(values)...} {}
+
+  static constexpr Mat identity()
+    requires(rows == cols)
+  {
+    Mat result;
+    for (unsigned i = 0; i < rows; i++) result.data[i * cols + i] = 1;
+    return result;
+  }
+
+  static constexpr unsigned getRows() { return rows; }
+  static constexpr unsigned getCols() { return cols; }
+  static constexpr unsigned size() { return rows * cols; }
+
+  constexpr float& operator()(unsigned row, unsigned col) {
+    return data[row * cols + col];
+  }
+
+  constexpr float operator()(unsigned row, unsigned col) const {
+    return data[row * cols + col];
+  }
+
+  constexpr float& operator[](unsigned index)
+    requires(rows == 1)
+  {
+    return data[index];
+  }
+
+  constexpr float operator[](unsigned index) const
+    requires(rows == 1)
+  {
+    return data[index];
+  }
+
+  constexpr bool operator==(const Mat&) const = default;
+
+  constexpr const float* pointer() const { return data.data(); }
+  constexpr float* pointer() { return data.data(); }
+};
+
+template <unsigned n>
+using Vec = Mat<1, n>;
+
+using Mat3 = Mat<3, 3>;
+using Mat4 = Mat<4, 4>;
+using Vec3 = Vec<3>;
+using Vec4 = Vec<4>;
+
+template <unsigned n, unsigned m, unsigned p>
+constexpr Mat<n, p> operator*(const Mat<n, m>& left, const Mat<m, p>& right) {
+  Mat<n, p> result;
+  if !consteval {
+    if constexpr (m == 3 && p == 3) {
+      simd::transform3(left.pointer(), n, right.pointer(), result.pointer());
+      return result;
+    } else if constexpr (m == 4 && p == 4) {
+      simd::transform4(left.pointer(), n, right.pointer(), result.pointer());
+      return result;
+    }
+  }
+  for (unsigned i = 0; i < n; i++) {
+    for (unsigned j = 0; j < p; j++) {
+      float sum = 0.0f;
+      for (unsigned k = 0; k < m; k++) {
+        sum += left(i, k) * right(k, j);
+      }
+      result(i, j) = sum;
+    }
+  }
+  return result;
+}
+
+constexpr Mat3 scale3x3(const float x, const float y) {
+  return Mat3{{
+      {x, 0, 0},
+      {0, y, 0},
+      {0, 0, 1},
+  }};
+}
+
+constexpr Mat3 scale3x3(const float n) { return scale3x3(n, n); }
+
+constexpr Mat3 translate3x3(const float x, const float y) {
+  return Mat3{{{1, 0, 0}, {0, 1, 0}, {x, y, 1}}};
+}
+
+constexpr Mat4 scale4x4(const float x, const float y, const float z) {
+  return Mat4{{
+      {x, 0, 0, 0},
+      {0, y, 0, 0},
+      {0, 0, z, 0},
+      {0, 0, 0, 1},
+  }};
+}
+
+constexpr Mat4 scale4x4(const float n) { return scale4x4(n, n, n); }
+
+constexpr Mat4 translate4x4(const float x, const float y, const float z) {
+  return Mat4{{
+      {1, 0, 0, 0},
+      {0, 1, 0, 0},
+      {0, 0, 1, 0},
+      {x, y, z, 1},
+  }};
+}
+
+Mat4 rotate4x4x(const float theta);
+Mat4 rotate4x4y(const float theta);
+Mat4 rotate4x4z(const float theta);
+Mat4 rotate4x4(float x, float y, float z, float theta);
+Mat4 perspective(float fov, float aspect, float near, float far);
+}  // namespace math
@@ -1,17 +1,21 @@
 #include "Matrix.hh"
 
 #include <algorithm>
-#include <cmath>
 #include <initializer_list>
+#include <memory_resource>
 #include <stdexcept>
 #include <utility>
 #include <vector>
 
+#include "simd.hh"
+
 namespace math {
-Matrix::Matrix(std::vector<float> data, unsigned rows, unsigned cols)
+Matrix::Matrix(std::pmr::vector<float> data, unsigned rows, unsigned cols)
     : data{std::move(data)}, rows{rows}, cols{cols} {}
 
-Matrix::Matrix(std::initializer_list<std::initializer_list<float>> matrix) {
+Matrix::Matrix(std::initializer_list<std::initializer_list<float>> matrix,
+               allocator_type allocator)
+    : data{allocator} {
   if (matrix.size() == 0) {
     throw std::runtime_error{"Inpossible to create empty matrix"};
   }
@@ -31,114 +35,98 @@ Matrix::Matrix(std::initializer_list<std::initializer_list<float>> matrix) {
 unsigned Matrix::getRows() const { return rows; }
 unsigned Matrix::getCols() const { return cols; }
 
-Matrix Matrix::scale3x3(const float x, const float y) {
+Matrix Matrix::scale3x3(const float x, const float y,
+                        allocator_type allocator) {
   return Matrix{{
-      {x, 0, 0},
-      {0, y, 0},
-      {0, 0, 1},
-  }};
+                    {x, 0, 0},
+                    {0, y, 0},
+                    {0, 0, 1},
+                },
+                allocator};
 }
 
-Matrix Matrix::scale3x3(const float n) { return scale3x3(n, n); }
+Matrix Matrix::scale3x3(const float n, allocator_type allocator) {
+  return scale3x3(n, n, allocator);
+}
 
-Matrix Matrix::translate3x3(const float x, const float y) {
-  return Matrix{{{1, 0, 0}, {0, 1, 0}, {x, y, 1}}};
+Matrix Matrix::translate3x3(const float x, const float y,
+                            allocator_type allocator) {
+  return Matrix{{{1, 0, 0}, {0, 1, 0}, {x, y, 1}}, allocator};
 }
 
-Matrix Matrix::scale4x4(const float x, const float y, const float z) {
+Matrix Matrix::scale4x4(const float x, const float y, const float z,
+                        allocator_type allocator) {
   return Matrix{{
-      {x, 0, 0, 0},
-      {0, y, 0, 0},
-      {0, 0, z, 0},
-      {0, 0, 0, 1},
-  }};
+                    {x, 0, 0, 0},
+                    {0, y, 0, 0},
+                    {0, 0, z, 0},
+                    {0, 0, 0, 1},
+                },
+                allocator};
 }
 
-Matrix Matrix::scale4x4(const float n) { return scale4x4(n, n, n); }
+Matrix Matrix::scale4x4(const float n, allocator_type allocator) {
+  return scale4x4(n, n, n, allocator);
+}
 
-Matrix Matrix::translate4x4(const float x, const float y, const float z) {
+Matrix Matrix::translate4x4(const float x, const float y, const float z,
+                            allocator_type allocator) {
   return Matrix{{
-      {1, 0, 0, 0},
-      {0, 1, 0, 0},
-      {0, 0, 1, 0},
-      {x, y, z, 1},
-  }};
+                    {1, 0, 0, 0},
+                    {0, 1, 0, 0},
+                    {0, 0, 1, 0},
+                    {x, y, z, 1},
+                },
+                allocator};
 }
 
-Matrix Matrix::rotate4x4x(const float theta) {
-  return Matrix{{{1, 0, 0, 0},
-                 {0, std::cos(theta), std::sin(theta), 0},
-                 {0, -std::sin(theta), std::cos(theta), 0},
-                 {0, 0, 0, 1}}};
+Matrix Matrix::rotate4x4x(const float theta, allocator_type allocator) {
+  return Matrix{math::rotate4x4x(theta), allocator};
 }
 
-Matrix Matrix::rotate4x4y(const float theta) {
-  return Matrix{{{std::cos(theta), 0, -std::sin(theta), 0},
-                 {0, 1, 0, 0},
-                 {std::sin(theta), 0, std::cos(theta), 0},
-                 {0, 0, 0, 1}}};
+Matrix Matrix::rotate4x4y(const float theta, allocator_type allocator) {
+  return Matrix{math::rotate4x4y(theta), allocator};
 }
 
-Matrix Matrix::rotate4x4z(const float theta) {
-  return Matrix{{{std::cos(theta), std::sin(theta), 0, 0},
-                 {-std::sin(theta), std::cos(theta), 0, 0},
-                 {0, 0, 1, 0},
-                 {0, 0, 0, 1}}};
+Matrix Matrix::rotate4x4z(const float theta, allocator_type allocator) {
+  return Matrix{math::rotate4x4z(theta), allocator};
 }
 
-Matrix Matrix::rotate4x4(float x, float y, float z, float theta) {
-  const float sina = std::sin(theta);
-  const float cosa = std::cos(theta);
-  std::vector<float> matrix(16);
-  matrix[0] = cosa + x * x * (1 - cosa);
-  matrix[1] = y * x * (1 - cosa) + z * sina;
-  matrix[2] = z * x * (1 - cosa) - y * sina;
-  matrix[3] = 0.0f;
-  matrix[4] = x * y * (1 - cosa) - z * sina;
-  matrix[5] = cosa + y * y * (1 - cosa);
-  matrix[6] = z * y * (1 - cosa) + x * sina;
-  matrix[7] = 0.0f;
-  matrix[8] = x * z * (1 - cosa) + y * sina;
-  matrix[9] = y * z * (1 - cosa) - x * sina;
-  matrix[10] = cosa + z * z * (1 - cosa);
-  matrix[11] = 0.0f;
-  matrix[12] = 0.0f;
-  matrix[13] = 0.0f;
-  matrix[14] = 0.0f;
-  matrix[15] = 1.0f;
-  return Matrix{matrix, 4, 4};
+Matrix Matrix::rotate4x4(float x, float y, float z, float theta,
+                         allocator_type allocator) {
+  return Matrix{math::rotate4x4(x, y, z, theta), allocator};
 }
 
-Matrix Matrix::perspective(float fov, float aspect, float near, float far) {
-  const float top = near * std::tan(fov / 2.0f);
-  const float right = top * aspect;
-  return Matrix{{{near / right, 0, 0, 0},
-                 {0, near / top, 0, 0},
-                 {0, 0, -(far + near) / (far - near), -1},
-                 {0, 0, -(2 * far * near) / (far - near), 0}}};
+Matrix Matrix::perspective(float fov, float aspect, float near, float far,
+                           allocator_type allocator) {
+  return Matrix{math::perspective(fov, aspect, near, far), allocator};
 }
 
-Matrix Matrix::operator*(const Matrix& other) const {
-  if (getCols() != other.getRows()) {
-    throw std::runtime_error{"Invalid matrix size for multiplication"};
+void Matrix::multiply(const float* left, unsigned rows, unsigned inner,
+                      const float* right, unsigned cols, float* out) {
+  if (inner == 3 && cols == 3) {
+    simd::transform3(left, rows, right, out);
+    return;
+  }
+  if (inner == 4 && cols == 4) {
+    simd::transform4(left, rows, right, out);
+    return;
   }
 
-  const unsigned result_rows = getRows();
-  const unsigned result_cols = other.getCols();
-  std::vector<float> result_data(result_rows * result_cols, 0.f);
-
-  for (unsigned i = 0; i < result_rows; i++) {
-    for (unsigned j = 0; j < result_cols; j++) {
+  for (unsigned i = 0; i < rows; i++) {
+    for (unsigned j = 0; j < cols; j++) {
       float sum = 0.0f;
-      for (unsigned k = 0; k < getCols(); k++) {
-        sum += data[i * cols + k] * other.data[k * other.cols + j];
+      for (unsigned k = 0; k < inner; k++) {
+        sum += left[i * inner + k] * right[k * cols + j];
       }
-      result_data[i * result_cols + j] = sum;
+      out[i * cols + j] = sum;
     }
   }
-
-  return Matrix{std::move(result_data), result_rows, result_cols};
 }
 
 const float* Matrix::pointer() const { return data.data(); };
+
+Matrix::allocator_type Matrix::get_allocator() const {
+  return data.get_allocator();
+}
 }  // namespace math
@@ -1,36 +1,221 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <cstddef>
 #include <initializer_list>
+#include <limits>
+#include <memory_resource>
+#include <stdexcept>
+#include <utility>
 #include <vector>
 
+#include "Mat.hh"
+
 namespace math {
+template <std::size_t n>
+class Chain;
+
+// Dynamically sized row-major matrix.
+//
+// Storage comes from the allocator passed to the constructor or factory, the
+// default memory resource otherwise, so per-frame temporaries can live in a
+// utils::Arena. Copies use the default resource again; moves keep the
+// allocator, so a moved matrix must not outlive its arena's next reset.
 class Matrix {
-  std::vector<float> data;
+ public:
+  using allocator_type = std::pmr::polymorphic_allocator<float>;
+
+ private:
+  std::pmr::vector<float> data;
   unsigned rows, cols;
 
-  Matrix(std::vector<float> data, unsigned rows, unsigned cols);
+  Matrix(std::pmr::vector<float> data, unsigned rows, unsigned cols);
+
+  // out (rows x cols) = left (rows x inner) * right (inner x cols).
+  static void multiply(const float* left, unsigned rows, unsigned inner,
+                       const float* right, unsigned cols, float* out);
+
+  template <std::size_t n>
+  friend class Chain;
 
  public:
-  Matrix(std::initializer_list<std::initializer_list<float>> data);
+  Matrix(std::initializer_list<std::initializer_list<float>> data,
+         allocator_type allocator = {});
+
+  // Evaluates a product chain; see Chain.
+  template <std::size_t n>
+  Matrix(Chain<n>&& chain, allocator_type allocator = {})
+      : Matrix{std::move(chain).evaluate(allocator)} {}
+
+  template <unsigned n, unsigned m>
+  Matrix(const Mat<n, m>& matrix, allocator_type allocator = {})
+      : Matrix{std::pmr::vector<float>(matrix.pointer(),
+                                       matrix.pointer() + matrix.size(),
+                                       allocator),
+               n, m} {}
+
+  template <unsigned n, unsigned m>
+  Mat<n, m> toMat() const {
+    if (rows != n || cols != m) {
+      throw std::runtime_error{"Matrix size does not match the target Mat"};
+    }
+    Mat<n, m> result;
+    std::copy(data.begin(), data.end(), result.pointer());
+    return result;
+  }
 
   unsigned getRows() const;
   unsigned getCols() const;
 
-  static Matrix scale3x3(const float x, const float y);
-  static Matrix scale3x3(const float n);
-  static Matrix translate3x3(const float x, const float y);
+  static Matrix scale3x3(const float x, const float y,
+                          allocator_type allocator = {});
+  static Matrix scale3x3(const float n, allocator_type allocator = {});
+  static Matrix translate3x3(const float x, const float y,
+                              allocator_type allocator = {});
 
-  static Matrix scale4x4(const float x, const float y, const float z);
-  static Matrix scale4x4(const float n);
-  static Matrix translate4x4(const float x, const float y, const float z);
-  static Matrix rotate4x4x(const float theta);
-  static Matrix rotate4x4y(const float theta);
-  static Matrix rotate4x4z(const float theta);
-  static Matrix rotate4x4(float x, float y, float z, float theta);
-  static Matrix perspective(float fov, float aspect, float near, float far);
+  static Matrix scale4x4(const float x, const float y, const float z,
+                          allocator_type allocator = {});
+  static Matrix scale4x4(const float n, allocator_type allocator = {});
+  static Matrix translate4x4(const float x, const float y, const float z,
+                              allocator_type allocator = {});
+  static Matrix rotate4x4x(const float theta, allocator_type allocator = {});
+  static Matrix rotate4x4y(const float theta, allocator_type allocator = {});
+  static Matrix rotate4x4z(const float theta, allocator_type allocator = {});
+  static Matrix rotate4x4(float x, float y, float z, float theta,
+                           allocator_type allocator = {});
+  static Matrix perspective(float fov, float aspect, float near, float far,
+                             allocator_type allocator = {});
 
-  Matrix operator*(const Matrix& other) const;
+  Chain<2> operator*(const Matrix& other) const;
 
   const float* pointer() const;
+  allocator_type get_allocator() const;
+};
+
+// Lazy product of `n` matrices, built by chaining operator* and evaluated
+// when converted to Matrix. Evaluation picks the association order with the
+// fewest multiply-adds (matrix-chain ordering), so in
+// `vertices * rotate * translate * projection` the 4x4 transforms are folded
+// together first and the vertices are multiplied once, straight into the
+// result. Intermediate products live on the stack unless they are large.
+//
+// Factors are held by reference, so a chain only lives within the expression
+// that creates it: it cannot be copied, and only an rvalue extends, converts
+// or evaluates. Keeping one in an `auto` variable and converting it later
+// does not compile.
+template <std::size_t n>
+class Chain {
+  std::array<const Matrix*, n> factors;
+
+  // Dimensions, cheapest cost and best split of every subchain [i, j].
+  struct Plan {
+    std::array<unsigned, n + 1> dims;
+    std::array<std::array<std::size_t, n>, n> cost{};
+    std::array<std::array<unsigned, n>, n> split{};
+  };
+
+  // Intermediate products up to this many floats in total stay on the stack.
+  static constexpr std::size_t stack_scratch = 64;
+
+  Plan plan() const {
+    Plan result;
+    for (std::size_t i = 0; i < n; i++) {
+      result.dims[i] = factors[i]->getRows();
+      if (i + 1 < n && factors[i]->getCols() != factors[i + 1]->getRows()) {
+        throw std::runtime_error{"Invalid matrix size for multiplication"};
+      }
+    }
+    result.dims[n] = factors[n - 1]->getCols();
+
+    const auto& dims = result.dims;
+    for (std::size_t length = 2; length <= n; length++) {
+      for (std::size_t i = 0; i + length <= n; i++) {
+        const std::size_t j = i + length - 1;
+        result.cost[i][j] = std::numeric_limits<std::size_t>::max();
+        // Ties keep the leftmost split, i.e. plain left-to-right order.
+        for (std::size_t k = i; k < j; k++) {
+          const std::size_t cost =
+              result.cost[i][k] + result.cost[k + 1][j] +
+              std::size_t{dims[i]} * dims[k + 1] * dims[j + 1];
+          if (cost < result.cost[i][j]) {
+            result.cost[i][j] = cost;
+            result.split[i][j] = k;
+          }
+        }
+      }
+    }
+    return result;
+  }
+
+  // Floats needed for the intermediate products of subchain [i, j], whose
+  // own result goes elsewhere.
+  static std::size_t scratchSize(const Plan& plan, unsigned i, unsigned j) {
+    if (i == j) return 0;
+    const unsigned k = plan.split[i][j];
+    std::size_t size = scratchSize(plan, i, k) + scratchSize(plan, k + 1, j);
+    if (i != k) size += std::size_t{plan.dims[i]} * plan.dims[k + 1];
+    if (k + 1 != j) size += std::size_t{plan.dims[k + 1]} * plan.dims[j + 1];
+    return size;
+  }
+
+  // Computes subchain [i, j] into `out` and returns it, or returns the
+  // factor itself for a single matrix. `scratch` is bumped past every
+  // intermediate product.
+  const float* compute(const Plan& plan, unsigned i, unsigned j,
+                       float*& scratch, float* out) const {
+    if (i == j) return factors[i]->pointer();
+    const unsigned k = plan.split[i][j];
+    const auto operand = [&](unsigned first, unsigned last) {
+      if (first == last) return factors[first]->pointer();
+      float* buffer = scratch;
+      scratch += std::size_t{plan.dims[first]} * plan.dims[last + 1];
+      return compute(plan, first, last, scratch, buffer);
+    };
+    const float* left = operand(i, k);
+    const float* right = operand(k + 1, j);
+    Matrix::multiply(left, plan.dims[i], plan.dims[k + 1], right,
+                     plan.dims[j + 1], out);
+    return out;
+  }
+
+ public:
+  explicit Chain(const std::array<const Matrix*, n>& factors)
+      : factors{factors} {}
+
+  Chain(const Chain&) = delete;
+  Chain& operator=(const Chain&) = delete;
+
+  Chain<n + 1> operator*(const Matrix& other) && {
+    std::array<const Matrix*, n + 1> next;
+    std::copy(factors.begin(), factors.end(), next.begin());
+    next[n] = &other;
+    return Chain<n + 1>{next};
+  }
+
+  // Multiply-adds evaluation will perform.
+  std::size_t cost() && { return plan().cost[0][n - 1]; }
+
+  // The result, and intermediate products too large for the stack, come
+  // from `allocator`.
+  Matrix evaluate(Matrix::allocator_type allocator = {}) && {
+    const Plan chosen = plan();
+    std::array<float, stack_scratch> stack;
+    std::pmr::vector<float> heap{allocator};
+    const std::size_t needed = scratchSize(chosen, 0, n - 1);
+    float* scratch = stack.data();
+    if (needed > stack.size()) {
+      heap.resize(needed);
+      scratch = heap.data();
+    }
+    std::pmr::vector<float> result(
+        std::size_t{chosen.dims[0]} * chosen.dims[n], allocator);
+    compute(chosen, 0, n - 1, scratch, result.data());
+    return Matrix{std::move(result), chosen.dims[0], chosen.dims[n]};
+  }
 };
+
+inline Chain<2> Matrix::operator*(const Matrix& other) const {
+  return Chain<2>{{this, &other}};
+}
 }  // namespace math
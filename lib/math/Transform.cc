@@ -0,0 +1,617 @@
+#include "Transform.hh"
+
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <span>
+
+#include "Mat.hh"
+#include "simd.hh"
+#include "trig.hh"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define MATH_TRANSFORM_X86 1
+#include <immintrin.h>
+#endif
+
+namespace math {
+namespace {
+// Row-vector rotation matrix of `q` with row i scaled by scale[i]. The
+// batch kernels compute every entry with the same operations.
+void fillRows(const Quat& q, const Vec3& scale, float* out,
+              unsigned stride) {
+  const float xx = q.x * q.x;
+  const float yy = q.y * q.y;
+  const float zz = q.z * q.z;
+  const float xy = q.x * q.y;
+  const float xz = q.x * q.z;
+  const float yz = q.y * q.z;
+  const float wx = q.w * q.x;
+  const float wy = q.w * q.y;
+  const float wz = q.w * q.z;
+  float* row = out;
+  row[0] = (1 - 2 * (yy + zz)) * scale[0];
+  row[1] = 2 * (xy + wz) * scale[0];
+  row[2] = 2 * (xz - wy) * scale[0];
+  row += stride;
+  row[0] = 2 * (xy - wz) * scale[1];
+  row[1] = (1 - 2 * (xx + zz)) * scale[1];
+  row[2] = 2 * (yz + wx) * scale[1];
+  row += stride;
+  row[0] = 2 * (xz + wy) * scale[2];
+  row[1] = 2 * (yz - wx) * scale[2];
+  row[2] = (1 - 2 * (xx + yy)) * scale[2];
+}
+
+void multiplyScalar(QuatArrays<const float> left,
+                    QuatArrays<const float> right, QuatArrays<float> out,
+                    std::size_t begin) {
+  for (std::size_t i = begin; i < out.size(); i++) {
+    store(out, i, load(left, i) * load(right, i));
+  }
+}
+
+void nlerpScalar(QuatArrays<const float> from, QuatArrays<const float> to,
+                 float alpha, QuatArrays<float> out, std::size_t begin) {
+  for (std::size_t i = begin; i < out.size(); i++) {
+    store(out, i, nlerp(load(from, i), load(to, i), alpha));
+  }
+}
+
+void multiplyScalar(const TransformArrays<const float>& left,
+                    const TransformArrays<const float>& right,
+                    const TransformArrays<float>& out, std::size_t begin) {
+  for (std::size_t i = begin; i < out.size(); i++) {
+    store(out, i, load(left, i) * load(right, i));
+  }
+}
+
+void toMat4Scalar(const TransformArrays<const float>& transforms,
+                  std::span<Mat4> out, std::size_t begin) {
+  for (std::size_t i = begin; i < transforms.size(); i++) {
+    out[i] = toMat4(load(transforms, i));
+  }
+}
+
+#ifdef MATH_TRANSFORM_X86
+// Vector paths spell out the scalar expressions with one operation per
+// intrinsic, in the same order, so every lane matches the scalar result.
+__m128 add(__m128 a, __m128 b) { return _mm_add_ps(a, b); }
+__m128 sub(__m128 a, __m128 b) { return _mm_sub_ps(a, b); }
+__m128 mul(__m128 a, __m128 b) { return _mm_mul_ps(a, b); }
+
+struct Quat4 {
+  __m128 x, y, z, w;
+};
+
+Quat4 load4(QuatArrays<const float> q, std::size_t i) {
+  return {_mm_loadu_ps(q.x.data() + i), _mm_loadu_ps(q.y.data() + i),
+          _mm_loadu_ps(q.z.data() + i), _mm_loadu_ps(q.w.data() + i)};
+}
+
+void store4(QuatArrays<float> q, std::size_t i, const Quat4& value) {
+  _mm_storeu_ps(q.x.data() + i, value.x);
+  _mm_storeu_ps(q.y.data() + i, value.y);
+  _mm_storeu_ps(q.z.data() + i, value.z);
+  _mm_storeu_ps(q.w.data() + i, value.w);
+}
+
+Quat4 multiply4(const Quat4& a, const Quat4& b) {
+  const Quat4& l = b;
+  const Quat4& r = a;
+  return {sub(add(add(mul(l.w, r.x), mul(l.x, r.w)), mul(l.y, r.z)),
+              mul(l.z, r.y)),
+          add(add(sub(mul(l.w, r.y), mul(l.x, r.z)), mul(l.y, r.w)),
+              mul(l.z, r.x)),
+          add(sub(add(mul(l.w, r.z), mul(l.x, r.y)), mul(l.y, r.x)),
+              mul(l.z, r.w)),
+          sub(sub(sub(mul(l.w, r.w), mul(l.x, r.x)), mul(l.y, r.y)),
+              mul(l.z, r.z))};
+}
+
+__m128 dot4(const Quat4& a, const Quat4& b) {
+  return add(add(add(mul(a.x, b.x), mul(a.y, b.y)), mul(a.z, b.z)),
+             mul(a.w, b.w));
+}
+
+void multiplySse(QuatArrays<const float> left, QuatArrays<const float> right,
+                 QuatArrays<float> out) {
+  std::size_t i = 0;
+  for (; i + 4 <= out.size(); i += 4) {
+    store4(out, i, multiply4(load4(left, i), load4(right, i)));
+  }
+  multiplyScalar(left, right, out, i);
+}
+
+void nlerpSse(QuatArrays<const float> from, QuatArrays<const float> to,
+              float alpha, QuatArrays<float> out) {
+  const __m128 sign = _mm_set1_ps(-0.f);
+  const __m128 zero = _mm_setzero_ps();
+  const __m128 t = _mm_set1_ps(alpha);
+  std::size_t i = 0;
+  for (; i + 4 <= out.size(); i += 4) {
+    const Quat4 a = load4(from, i);
+    Quat4 b = load4(to, i);
+    const __m128 flip = _mm_and_ps(_mm_cmplt_ps(dot4(a, b), zero), sign);
+    b = {_mm_xor_ps(b.x, flip), _mm_xor_ps(b.y, flip), _mm_xor_ps(b.z, flip),
+         _mm_xor_ps(b.w, flip)};
+    const Quat4 blended{add(a.x, mul(t, sub(b.x, a.x))),
+                        add(a.y, mul(t, sub(b.y, a.y))),
+                        add(a.z, mul(t, sub(b.z, a.z))),
+                        add(a.w, mul(t, sub(b.w, a.w)))};
+    const __m128 length = _mm_sqrt_ps(dot4(blended, blended));
+    store4(out, i,
+           {_mm_div_ps(blended.x, length), _mm_div_ps(blended.y, length),
+            _mm_div_ps(blended.z, length), _mm_div_ps(blended.w, length)});
+  }
+  nlerpScalar(from, to, alpha, out, i);
+}
+
+void multiplySse(const TransformArrays<const float>& left,
+                 const TransformArrays<const float>& right,
+                 const TransformArrays<float>& out) {
+  const __m128 two = _mm_set1_ps(2);
+  std::size_t i = 0;
+  for (; i + 4 <= out.size(); i += 4) {
+    const Quat4 q = load4(right.rotation, i);
+    const __m128 sx = _mm_loadu_ps(right.sx.data() + i);
+    const __m128 sy = _mm_loadu_ps(right.sy.data() + i);
+    const __m128 sz = _mm_loadu_ps(right.sz.data() + i);
+    const __m128 vx = mul(_mm_loadu_ps(left.tx.data() + i), sx);
+    const __m128 vy = mul(_mm_loadu_ps(left.ty.data() + i), sy);
+    const __m128 vz = mul(_mm_loadu_ps(left.tz.data() + i), sz);
+    const __m128 tx = mul(two, sub(mul(q.y, vz), mul(q.z, vy)));
+    const __m128 ty = mul(two, sub(mul(q.z, vx), mul(q.x, vz)));
+    const __m128 tz = mul(two, sub(mul(q.x, vy), mul(q.y, vx)));
+    const __m128 mx =
+        add(add(vx, mul(q.w, tx)), sub(mul(q.y, tz), mul(q.z, ty)));
+    const __m128 my =
+        add(add(vy, mul(q.w, ty)), sub(mul(q.z, tx), mul(q.x, tz)));
+    const __m128 mz =
+        add(add(vz, mul(q.w, tz)), sub(mul(q.x, ty), mul(q.y, tx)));
+    const Quat4 rotation = multiply4(load4(left.rotation, i), q);
+    _mm_storeu_ps(out.tx.data() + i,
+                  add(mx, _mm_loadu_ps(right.tx.data() + i)));
+    _mm_storeu_ps(out.ty.data() + i,
+                  add(my, _mm_loadu_ps(right.ty.data() + i)));
+    _mm_storeu_ps(out.tz.data() + i,
+                  add(mz, _mm_loadu_ps(right.tz.data() + i)));
+    store4(out.rotation, i, rotation);
+    _mm_storeu_ps(out.sx.data() + i,
+                  mul(_mm_loadu_ps(left.sx.data() + i), sx));
+    _mm_storeu_ps(out.sy.data() + i,
+                  mul(_mm_loadu_ps(left.sy.data() + i), sy));
+    _mm_storeu_ps(out.sz.data() + i,
+                  mul(_mm_loadu_ps(left.sz.data() + i), sz));
+  }
+  multiplyScalar(left, right, out, i);
+}
+
+void toMat4Sse(const TransformArrays<const float>& transforms,
+               std::span<Mat4> out) {
+  const __m128 one = _mm_set1_ps(1);
+  const __m128 two = _mm_set1_ps(2);
+  const __m128 zero = _mm_setzero_ps();
+  std::size_t i = 0;
+  for (; i + 4 <= transforms.size(); i += 4) {
+    const Quat4 q = load4(transforms.rotation, i);
+    const __m128 sx = _mm_loadu_ps(transforms.sx.data() + i);
+    const __m128 sy = _mm_loadu_ps(transforms.sy.data() + i);
+    const __m128 sz = _mm_loadu_ps(transforms.sz.data() + i);
+    const __m128 xx = mul(q.x, q.x);
+    const __m128 yy = mul(q.y, q.y);
+    const __m128 zz = mul(q.z, q.z);
+    const __m128 xy = mul(q.x, q.y);
+    const __m128 xz = mul(q.x, q.z);
+    const __m128 yz = mul(q.y, q.z);
+    const __m128 wx = mul(q.w, q.x);
+    const __m128 wy = mul(q.w, q.y);
+    const __m128 wz = mul(q.w, q.z);
+    // Entry (row, col) of four matrices, one per lane.
+    __m128 m[4][4] = {
+        {mul(sub(one, mul(two, add(yy, zz))), sx),
+         mul(mul(two, add(xy, wz)), sx), mul(mul(two, sub(xz, wy)), sx),
+         zero},
+        {mul(mul(two, sub(xy, wz)), sy),
+         mul(sub(one, mul(two, add(xx, zz))), sy),
+         mul(mul(two, add(yz, wx)), sy), zero},
+        {mul(mul(two, add(xz, wy)), sz), mul(mul(two, sub(yz, wx)), sz),
+         mul(sub(one, mul(two, add(xx, yy))), sz), zero},
+        {_mm_loadu_ps(transforms.tx.data() + i),
+         _mm_loadu_ps(transforms.ty.data() + i),
+         _mm_loadu_ps(transforms.tz.data() + i), one}};
+    // Transposing a row's entries yields that row of each matrix.
+    for (unsigned row = 0; row < 4; row++) {
+      __m128* c = m[row];
+      _MM_TRANSPOSE4_PS(c[0], c[1], c[2], c[3]);
+      for (unsigned lane = 0; lane < 4; lane++) {
+        _mm_storeu_ps(out[i + lane].pointer() + row * 4, c[lane]);
+      }
+    }
+  }
+  toMat4Scalar(transforms, out, i);
+}
+
+__attribute__((target("avx2"))) __m256 add(__m256 a, __m256 b) {
+  return _mm256_add_ps(a, b);
+}
+__attribute__((target("avx2"))) __m256 sub(__m256 a, __m256 b) {
+  return _mm256_sub_ps(a, b);
+}
+__attribute__((target("avx2"))) __m256 mul(__m256 a, __m256 b) {
+  return _mm256_mul_ps(a, b);
+}
+
+struct Quat8 {
+  __m256 x, y, z, w;
+};
+
+__attribute__((target("avx2"))) Quat8 load8(QuatArrays<const float> q,
+                                            std::size_t i) {
+  return {_mm256_loadu_ps(q.x.data() + i), _mm256_loadu_ps(q.y.data() + i),
+          _mm256_loadu_ps(q.z.data() + i), _mm256_loadu_ps(q.w.data() + i)};
+}
+
+__attribute__((target("avx2"))) void store8(QuatArrays<float> q,
+                                            std::size_t i,
+                                            const Quat8& value) {
+  _mm256_storeu_ps(q.x.data() + i, value.x);
+  _mm256_storeu_ps(q.y.data() + i, value.y);
+  _mm256_storeu_ps(q.z.data() + i, value.z);
+  _mm256_storeu_ps(q.w.data() + i, value.w);
+}
+
+__attribute__((target("avx2"))) Quat8 multiply8(const Quat8& a,
+                                                const Quat8& b) {
+  const Quat8& l = b;
+  const Quat8& r = a;
+  return {sub(add(add(mul(l.w, r.x), mul(l.x, r.w)), mul(l.y, r.z)),
+              mul(l.z, r.y)),
+          add(add(sub(mul(l.w, r.y), mul(l.x, r.z)), mul(l.y, r.w)),
+              mul(l.z, r.x)),
+          add(sub(add(mul(l.w, r.z), mul(l.x, r.y)), mul(l.y, r.x)),
+              mul(l.z, r.w)),
+          sub(sub(sub(mul(l.w, r.w), mul(l.x, r.x)), mul(l.y, r.y)),
+              mul(l.z, r.z))};
+}
+
+__attribute__((target("avx2"))) __m256 dot8(const Quat8& a, const Quat8& b) {
+  return add(add(add(mul(a.x, b.x), mul(a.y, b.y)), mul(a.z, b.z)),
+             mul(a.w, b.w));
+}
+
+__attribute__((target("avx2"))) void multiplyAvx2(
+    QuatArrays<const float> left, QuatArrays<const float> right,
+    QuatArrays<float> out) {
+  std::size_t i = 0;
+  for (; i + 8 <= out.size(); i += 8) {
+    store8(out, i, multiply8(load8(left, i), load8(right, i)));
+  }
+  multiplyScalar(left, right, out, i);
+}
+
+__attribute__((target("avx2"))) void nlerpAvx2(QuatArrays<const float> from,
+                                               QuatArrays<const float> to,
+                                               float alpha,
+                                               QuatArrays<float> out) {
+  const __m256 sign = _mm256_set1_ps(-0.f);
+  const __m256 zero = _mm256_setzero_ps();
+  const __m256 t = _mm256_set1_ps(alpha);
+  std::size_t i = 0;
+  for (; i + 8 <= out.size(); i += 8) {
+    const Quat8 a = load8(from, i);
+    Quat8 b = load8(to, i);
+    const __m256 flip =
+        _mm256_and_ps(_mm256_cmp_ps(dot8(a, b), zero, _CMP_LT_OQ), sign);
+    b = {_mm256_xor_ps(b.x, flip), _mm256_xor_ps(b.y, flip),
+         _mm256_xor_ps(b.z, flip), _mm256_xor_ps(b.w, flip)};
+    const Quat8 blended{add(a.x, mul(t, sub(b.x, a.x))),
+                        add(a.y, mul(t, sub(b.y, a.y))),
+                        add(a.z, mul(t, sub(b.z, a.z))),
+                        add(a.w, mul(t, sub(b.w, a.w)))};
+    const __m256 length = _mm256_sqrt_ps(dot8(blended, blended));
+    store8(out, i,
+           {_mm256_div_ps(blended.x, length), _mm256_div_ps(blended.y, length),
+            _mm256_div_ps(blended.z, length),
+            _mm256_div_ps(blended.w, length)});
+  }
+  nlerpScalar(from, to, alpha, out, i);
+}
+
+__attribute__((target("avx2"))) void multiplyAvx2(
+    const TransformArrays<const float>& left,
+    const TransformArrays<const float>& right,
+    const TransformArrays<float>& out) {
+  const __m256 two = _mm256_set1_ps(2);
+  std::size_t i = 0;
+  for (; i + 8 <= out.size(); i += 8) {
+    const Quat8 q = load8(right.rotation, i);
+    const __m256 sx = _mm256_loadu_ps(right.sx.data() + i);
+    const __m256 sy = _mm256_loadu_ps(right.sy.data() + i);
+    const __m256 sz = _mm256_loadu_ps(right.sz.data() + i);
+    const __m256 vx = mul(_mm256_loadu_ps(left.tx.data() + i), sx);
+    const __m256 vy = mul(_mm256_loadu_ps(left.ty.data() + i), sy);
+    const __m256 vz = mul(_mm256_loadu_ps(left.tz.data() + i), sz);
+    const __m256 tx = mul(two, sub(mul(q.y, vz), mul(q.z, vy)));
+    const __m256 ty = mul(two, sub(mul(q.z, vx), mul(q.x, vz)));
+    const __m256 tz = mul(two, sub(mul(q.x, vy), mul(q.y, vx)));
+    const __m256 mx =
+        add(add(vx, mul(q.w, tx)), sub(mul(q.y, tz), mul(q.z, ty)));
+    const __m256 my =
+        add(add(vy, mul(q.w, ty)), sub(mul(q.z, tx), mul(q.x, tz)));
+    const __m256 mz =
+        add(add(vz, mul(q.w, tz)), sub(mul(q.x, ty), mul(q.y, tx)));
+    const Quat8 rotation = multiply8(load8(left.rotation, i), q);
+    _mm256_storeu_ps(out.tx.data() + i,
+                     add(mx, _mm256_loadu_ps(right.tx.data() + i)));
+    _mm256_storeu_ps(out.ty.data() + i,
+                     add(my, _mm256_loadu_ps(right.ty.data() + i)));
+    _mm256_storeu_ps(out.tz.data() + i,
+                     add(mz, _mm256_loadu_ps(right.tz.data() + i)));
+    store8(out.rotation, i, rotation);
+    _mm256_storeu_ps(out.sx.data() + i,
+                     mul(_mm256_loadu_ps(left.sx.data() + i), sx));
+    _mm256_storeu_ps(out.sy.data() + i,
+                     mul(_mm256_loadu_ps(left.sy.data() + i), sy));
+    _mm256_storeu_ps(out.sz.data() + i,
+                     mul(_mm256_loadu_ps(left.sz.data() + i), sz));
+  }
+  multiplyScalar(left, right, out, i);
+}
+
+__attribute__((target("avx2"))) void toMat4Avx2(
+    const TransformArrays<const float>& transforms, std::span<Mat4> out) {
+  const __m256 one = _mm256_set1_ps(1);
+  const __m256 two = _mm256_set1_ps(2);
+  const __m256 zero = _mm256_setzero_ps();
+  std::size_t i = 0;
+  for (; i + 8 <= transforms.size(); i += 8) {
+    const Quat8 q = load8(transforms.rotation, i);
+    const __m256 sx = _mm256_loadu_ps(transforms.sx.data() + i);
+    const __m256 sy = _mm256_loadu_ps(transforms.sy.data() + i);
+    const __m256 sz = _mm256_loadu_ps(transforms.sz.data() + i);
+    const __m256 xx = mul(q.x, q.x);
+    const __m256 yy = mul(q.y, q.y);
+    const __m256 zz = mul(q.z, q.z);
+    const __m256 xy = mul(q.x, q.y);
+    const __m256 xz = mul(q.x, q.z);
+    const __m256 yz = mul(q.y, q.z);
+    const __m256 wx = mul(q.w, q.x);
+    const __m256 wy = mul(q.w, q.y);
+    const __m256 wz = mul(q.w, q.z);
+    const __m256 m[4][4] = {
+        {mul(sub(one, mul(two, add(yy, zz))), sx),
+         mul(mul(two, add(xy, wz)), sx), mul(mul(two, sub(xz, wy)), sx),
+         zero},
+        {mul(mul(two, sub(xy, wz)), sy),
+         mul(sub(one, mul(two, add(xx, zz))), sy),
+         mul(mul(two, add(yz, wx)), sy), zero},
+        {mul(mul(two, add(xz, wy)), sz), mul(mul(two, sub(yz, wx)), sz),
+         mul(sub(one, mul(two, add(xx, yy))), sz), zero},
+        {_mm256_loadu_ps(transforms.tx.data() + i),
+         _mm256_loadu_ps(transforms.ty.data() + i),
+         _mm256_loadu_ps(transforms.tz.data() + i), one}};
+    // _MM_TRANSPOSE4_PS within each 128-bit half: the low halves hold rows
+    // of matrices 0 to 3, the high halves rows of matrices 4 to 7.
+    Mat4* matrices = out.data() + i;
+    for (unsigned row = 0; row < 4; row++) {
+      const __m256 t0 = _mm256_unpacklo_ps(m[row][0], m[row][1]);
+      const __m256 t1 = _mm256_unpackhi_ps(m[row][0], m[row][1]);
+      const __m256 t2 = _mm256_unpacklo_ps(m[row][2], m[row][3]);
+      const __m256 t3 = _mm256_unpackhi_ps(m[row][2], m[row][3]);
+      const __m256 lanes[4] = {_mm256_shuffle_ps(t0, t2, 0x44),
+                               _mm256_shuffle_ps(t0, t2, 0xEE),
+                               _mm256_shuffle_ps(t1, t3, 0x44),
+                               _mm256_shuffle_ps(t1, t3, 0xEE)};
+      for (unsigned lane = 0; lane < 4; lane++) {
+        _mm_storeu_ps(matrices[lane].pointer() + row * 4,
+                      _mm256_castps256_ps128(lanes[lane]));
+        _mm_storeu_ps(matrices[lane + 4].pointer() + row * 4,
+                      _mm256_extractf128_ps(lanes[lane], 1));
+      }
+    }
+  }
+  toMat4Scalar(transforms, out, i);
+}
+#endif
+
+template <typename T>
+bool sameSize(const QuatArrays<T>& q, std::size_t size) {
+  return q.x.size() == size && q.y.size() == size && q.z.size() == size &&
+         q.w.size() == size;
+}
+
+template <typename T>
+bool sameSize(const TransformArrays<T>& t, std::size_t size) {
+  return t.tx.size() == size && t.ty.size() == size && t.tz.size() == size &&
+         sameSize(t.rotation, size) && t.sx.size() == size &&
+         t.sy.size() == size && t.sz.size() == size;
+}
+}  // namespace
+
+Quat load(QuatArrays<const float> q, std::size_t i) {
+  return {q.x[i], q.y[i], q.z[i], q.w[i]};
+}
+
+void store(QuatArrays<float> q, std::size_t i, const Quat& value) {
+  q.x[i] = value.x;
+  q.y[i] = value.y;
+  q.z[i] = value.z;
+  q.w[i] = value.w;
+}
+
+Transform load(const TransformArrays<const float>& t, std::size_t i) {
+  return {Vec3{t.tx[i], t.ty[i], t.tz[i]}, load(t.rotation, i),
+          Vec3{t.sx[i], t.sy[i], t.sz[i]}};
+}
+
+void store(const TransformArrays<float>& t, std::size_t i,
+           const Transform& value) {
+  t.tx[i] = value.translation[0];
+  t.ty[i] = value.translation[1];
+  t.tz[i] = value.translation[2];
+  store(t.rotation, i, value.rotation);
+  t.sx[i] = value.scale[0];
+  t.sy[i] = value.scale[1];
+  t.sz[i] = value.scale[2];
+}
+
+Quat axisAngle(const float x, const float y, const float z,
+               const float theta) {
+  const auto [sina, cosa] = sincos(theta / 2);
+  return {x * sina, y * sina, z * sina, cosa};
+}
+
+Quat normalize(const Quat& q) {
+  const float length = std::sqrt(dot(q, q));
+  return {q.x / length, q.y / length, q.z / length, q.w / length};
+}
+
+// v + w t + u x t with t = 2 u x v, where u is the vector part: two cross
+// products instead of building the matrix.
+Vec3 rotate(const Quat& q, const Vec3& v) {
+  const float tx = 2 * (q.y * v[2] - q.z * v[1]);
+  const float ty = 2 * (q.z * v[0] - q.x * v[2]);
+  const float tz = 2 * (q.x * v[1] - q.y * v[0]);
+  return Vec3{v[0] + q.w * tx + (q.y * tz - q.z * ty),
+              v[1] + q.w * ty + (q.z * tx - q.x * tz),
+              v[2] + q.w * tz + (q.x * ty - q.y * tx)};
+}
+
+Mat3 toMat3(const Quat& q) {
+  Mat3 result;
+  fillRows(q, Vec3{1, 1, 1}, result.pointer(), 3);
+  return result;
+}
+
+Mat4 toMat4(const Quat& q) { return toMat4(Transform{.rotation = q}); }
+
+Quat nlerp(const Quat& from, const Quat& to, const float alpha) {
+  const float sign = dot(from, to) < 0 ? -1.f : 1.f;
+  return normalize(Quat{from.x + alpha * (to.x * sign - from.x),
+                        from.y + alpha * (to.y * sign - from.y),
+                        from.z + alpha * (to.z * sign - from.z),
+                        from.w + alpha * (to.w * sign - from.w)});
+}
+
+Quat slerp(const Quat& from, const Quat& to, const float alpha) {
+  float cosine = dot(from, to);
+  Quat target = to;
+  if (cosine < 0) {
+    cosine = -cosine;
+    target = Quat{-to.x, -to.y, -to.z, -to.w};
+  }
+  // Dividing by the sine of a tiny angle loses everything; the chord and
+  // the arc agree there anyway.
+  if (cosine > 0.9995f) return nlerp(from, target, alpha);
+  const float angle = std::acos(cosine);
+  const float sine = std::sin(angle);
+  const float a = std::sin((1 - alpha) * angle) / sine;
+  const float b = std::sin(alpha * angle) / sine;
+  return {a * from.x + b * target.x, a * from.y + b * target.y,
+          a * from.z + b * target.z, a * from.w + b * target.w};
+}
+
+Transform operator*(const Transform& a, const Transform& b) {
+  const Vec3 scaled{a.translation[0] * b.scale[0],
+                    a.translation[1] * b.scale[1],
+                    a.translation[2] * b.scale[2]};
+  const Vec3 moved = rotate(b.rotation, scaled);
+  return {Vec3{moved[0] + b.translation[0], moved[1] + b.translation[1],
+               moved[2] + b.translation[2]},
+          a.rotation * b.rotation,
+          Vec3{a.scale[0] * b.scale[0], a.scale[1] * b.scale[1],
+               a.scale[2] * b.scale[2]}};
+}
+
+Vec3 transform(const Transform& t, const Vec3& point) {
+  const Vec3 moved =
+      rotate(t.rotation, Vec3{point[0] * t.scale[0], point[1] * t.scale[1],
+                              point[2] * t.scale[2]});
+  return Vec3{moved[0] + t.translation[0], moved[1] + t.translation[1],
+              moved[2] + t.translation[2]};
+}
+
+Mat4 toMat4(const Transform& t) {
+  Mat4 result;
+  fillRows(t.rotation, t.scale, result.pointer(), 4);
+  for (unsigned j = 0; j < 3; j++) result(3, j) = t.translation[j];
+  result(3, 3) = 1;
+  return result;
+}
+
+Transform interpolate(const Transform& from, const Transform& to,
+                      const float alpha) {
+  Transform result{.rotation = nlerp(from.rotation, to.rotation, alpha)};
+  for (unsigned i = 0; i < 3; i++) {
+    result.translation[i] =
+        from.translation[i] + alpha * (to.translation[i] - from.translation[i]);
+    result.scale[i] = from.scale[i] + alpha * (to.scale[i] - from.scale[i]);
+  }
+  return result;
+}
+
+void multiply(QuatArrays<const float> left, QuatArrays<const float> right,
+              QuatArrays<float> out) {
+  assert(sameSize(left, out.size()) && sameSize(right, out.size()) &&
+         sameSize(out, out.size()));
+  switch (simd::active()) {
+#ifdef MATH_TRANSFORM_X86
+    case simd::Isa::avx2:
+      return multiplyAvx2(left, right, out);
+    case simd::Isa::sse:
+      return multiplySse(left, right, out);
+#endif
+    default:
+      return multiplyScalar(left, right, out, 0);
+  }
+}
+
+void nlerp(QuatArrays<const float> from, QuatArrays<const float> to,
+           const float alpha, QuatArrays<float> out) {
+  assert(sameSize(from, out.size()) && sameSize(to, out.size()) &&
+         sameSize(out, out.size()));
+  switch (simd::active()) {
+#ifdef MATH_TRANSFORM_X86
+    case simd::Isa::avx2:
+      return nlerpAvx2(from, to, alpha, out);
+    case simd::Isa::sse:
+      return nlerpSse(from, to, alpha, out);
+#endif
+    default:
+      return nlerpScalar(from, to, alpha, out, 0);
+  }
+}
+
+void multiply(TransformArrays<const float> left,
+              TransformArrays<const float> right,
+              TransformArrays<float> out) {
+  assert(sameSize(left, out.size()) && sameSize(right, out.size()) &&
+         sameSize(out, out.size()));
+  switch (simd::active()) {
+#ifdef MATH_TRANSFORM_X86
+    case simd::Isa::avx2:
+      return multiplyAvx2(left, right, out);
+    case simd::Isa::sse:
+      return multiplySse(left, right, out);
+#endif
+    default:
+      return multiplyScalar(left, right, out, 0);
+  }
+}
+
+void toMat4(TransformArrays<const float> transforms, std::span<Mat4> out) {
+  assert(sameSize(transforms, transforms.size()) &&
+         out.size() >= transforms.size());
+  switch (simd::active()) {
+#ifdef MATH_TRANSFORM_X86
+    case simd::Isa::avx2:
+      return toMat4Avx2(transforms, out);
+    case simd::Isa::sse:
+      return toMat4Sse(transforms, out);
+#endif
+    default:
+      return toMat4Scalar(transforms, out, 0);
+  }
+}
+}  // namespace math
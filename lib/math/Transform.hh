@@ -0,0 +1,139 @@
+#pragma once
+
+#include <cstddef>
+#include <span>
+#include <type_traits>
+
+#include "Mat.hh"
+
+namespace math {
+// Rotation as a unit quaternion x i + y j + z k + w. Quaternions rotate row
+// vectors like the matrices in Mat.hh and compose in the same order: a * b
+// rotates by a, then by b, so toMat4(a * b) equals toMat4(a) * toMat4(b) up
+// to rounding.
+struct Quat {
+  float x = 0;
+  float y = 0;
+  float z = 0;
+  float w = 1;
+
+  constexpr bool operator==(const Quat&) const = default;
+};
+
+// Rotation by `theta` radians about the unit axis (x, y, z): the one
+// rotate4x4(x, y, z, theta) builds.
+Quat axisAngle(float x, float y, float z, float theta);
+
+// Hamilton product b a, since with row vectors the first rotation is the
+// left operand. 16 multiplies against 64 for a 4x4 product.
+constexpr Quat operator*(const Quat& a, const Quat& b) {
+  const Quat& l = b;
+  const Quat& r = a;
+  return {l.w * r.x + l.x * r.w + l.y * r.z - l.z * r.y,
+          l.w * r.y - l.x * r.z + l.y * r.w + l.z * r.x,
+          l.w * r.z + l.x * r.y - l.y * r.x + l.z * r.w,
+          l.w * r.w - l.x * r.x - l.y * r.y - l.z * r.z};
+}
+
+constexpr float dot(const Quat& a, const Quat& b) {
+  return a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w;
+}
+
+// Inverse rotation of a unit quaternion.
+constexpr Quat conjugate(const Quat& q) { return {-q.x, -q.y, -q.z, q.w}; }
+
+// Rescales to unit length. Products of unit quaternions drift away from it
+// slowly; renormalizing every few thousand products keeps them rotations.
+Quat normalize(const Quat& q);
+
+Vec3 rotate(const Quat& q, const Vec3& v);
+Mat3 toMat3(const Quat& q);
+Mat4 toMat4(const Quat& q);
+
+// Blends along the shorter arc. nlerp normalizes the straight blend: it
+// costs no trigonometry and, for steps of up to 0.2 radians like those
+// between two animation ticks, stays within 1e-3 radians of slerp.
+Quat nlerp(const Quat& from, const Quat& to, float alpha);
+Quat slerp(const Quat& from, const Quat& to, float alpha);
+
+// Scale, then rotation, then translation, applied to row vectors, with the
+// rotation kept as a quaternion.
+struct Transform {
+  Vec3 translation{0, 0, 0};
+  Quat rotation;
+  Vec3 scale{1, 1, 1};
+};
+
+// `a` followed by `b`, like toMat4(a) * toMat4(b). Exact when b's scale is
+// uniform; otherwise the product would shear, which a Transform cannot
+// hold, and only the scale along each axis is kept.
+Transform operator*(const Transform& a, const Transform& b);
+
+Vec3 transform(const Transform& t, const Vec3& point);
+Mat4 toMat4(const Transform& t);
+
+// Linear blend of translation and scale, nlerp of the rotation.
+Transform interpolate(const Transform& from, const Transform& to,
+                      float alpha);
+
+// Batches keep one array per component, so that consecutive quaternions
+// load into vector lanes. All arrays of a batch have the same size.
+template <typename T>
+struct QuatArrays {
+  std::span<T> x;
+  std::span<T> y;
+  std::span<T> z;
+  std::span<T> w;
+
+  std::size_t size() const { return w.size(); }
+
+  // Writable arrays can be passed where read-only ones are expected.
+  operator QuatArrays<const T>() const
+    requires(!std::is_const_v<T>)
+  {
+    return {x, y, z, w};
+  }
+};
+
+template <typename T>
+struct TransformArrays {
+  std::span<T> tx;
+  std::span<T> ty;
+  std::span<T> tz;
+  QuatArrays<T> rotation;
+  std::span<T> sx;
+  std::span<T> sy;
+  std::span<T> sz;
+
+  std::size_t size() const { return tx.size(); }
+
+  operator TransformArrays<const T>() const
+    requires(!std::is_const_v<T>)
+  {
+    return {tx, ty, tz, rotation, sx, sy, sz};
+  }
+};
+
+// Element `i` of a batch.
+Quat load(QuatArrays<const float> q, std::size_t i);
+void store(QuatArrays<float> q, std::size_t i, const Quat& value);
+Transform load(const TransformArrays<const float>& t, std::size_t i);
+void store(const TransformArrays<float>& t, std::size_t i,
+           const Transform& value);
+
+// Batch versions of the functions above. They use the instruction set
+// picked by math::simd::active() and, like the other math::simd kernels,
+// never fuse multiplies and adds, so every ISA returns exactly what the
+// single-element functions do. `out` may be one of the inputs, but must
+// not partially overlap them.
+
+// out[i] = left[i] * right[i]
+void multiply(QuatArrays<const float> left, QuatArrays<const float> right,
+              QuatArrays<float> out);
+void nlerp(QuatArrays<const float> from, QuatArrays<const float> to,
+           float alpha, QuatArrays<float> out);
+void multiply(TransformArrays<const float> left,
+              TransformArrays<const float> right, TransformArrays<float> out);
+// Meant for upload time: `out` must hold transforms.size() matrices.
+void toMat4(TransformArrays<const float> transforms, std::span<Mat4> out);
+}  // namespace math
@@ -0,0 +1,172 @@
+#include "simd.hh"
+
+#include <algorithm>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define MATH_SIMD_X86 1
+#include <immintrin.h>
+#endif
+
+namespace math::simd {
+namespace {
+void transform3Scalar(const float* vertices, unsigned count,
+                      const float* matrix, float* out) {
+  for (unsigned i = 0; i < count; i++) {
+    const float* vertex = vertices + i * 3;
+    for (unsigned j = 0; j < 3; j++) {
+      float sum = 0.0f;
+      for (unsigned k = 0; k < 3; k++) sum += vertex[k] * matrix[k * 3 + j];
+      out[i * 3 + j] = sum;
+    }
+  }
+}
+
+void transform4Scalar(const float* vertices, unsigned count,
+                      const float* matrix, float* out) {
+  for (unsigned i = 0; i < count; i++) {
+    const float* vertex = vertices + i * 4;
+    for (unsigned j = 0; j < 4; j++) {
+      float sum = 0.0f;
+      for (unsigned k = 0; k < 4; k++) sum += vertex[k] * matrix[k * 4 + j];
+      out[i * 4 + j] = sum;
+    }
+  }
+}
+
+#ifdef MATH_SIMD_X86
+// Every output row is a linear combination of the matrix rows weighted by the
+// vertex components; accumulating from zero keeps the scalar rounding order.
+void transform3Sse(const float* vertices, unsigned count, const float* matrix,
+                   float* out) {
+  const __m128 row0 = _mm_setr_ps(matrix[0], matrix[1], matrix[2], 0);
+  const __m128 row1 = _mm_setr_ps(matrix[3], matrix[4], matrix[5], 0);
+  const __m128 row2 = _mm_setr_ps(matrix[6], matrix[7], matrix[8], 0);
+
+  for (unsigned i = 0; i < count; i++) {
+    const float* vertex = vertices + i * 3;
+    __m128 sum = _mm_setzero_ps();
+    sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(vertex[0]), row0));
+    sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(vertex[1]), row1));
+    sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(vertex[2]), row2));
+    if (i + 1 < count) {
+      // The fourth lane spills into the next vertex, which is written later.
+      _mm_storeu_ps(out + i * 3, sum);
+    } else {
+      alignas(16) float last[4];
+      _mm_store_ps(last, sum);
+      std::copy(last, last + 3, out + i * 3);
+    }
+  }
+}
+
+void transform4Sse(const float* vertices, unsigned count, const float* matrix,
+                   float* out) {
+  const __m128 row0 = _mm_loadu_ps(matrix);
+  const __m128 row1 = _mm_loadu_ps(matrix + 4);
+  const __m128 row2 = _mm_loadu_ps(matrix + 8);
+  const __m128 row3 = _mm_loadu_ps(matrix + 12);
+
+  for (unsigned i = 0; i < count; i++) {
+    const __m128 vertex = _mm_loadu_ps(vertices + i * 4);
+    __m128 sum = _mm_setzero_ps();
+    sum = _mm_add_ps(
+        sum, _mm_mul_ps(_mm_shuffle_ps(vertex, vertex, 0x00), row0));
+    sum = _mm_add_ps(
+        sum, _mm_mul_ps(_mm_shuffle_ps(vertex, vertex, 0x55), row1));
+    sum = _mm_add_ps(
+        sum, _mm_mul_ps(_mm_shuffle_ps(vertex, vertex, 0xAA), row2));
+    sum = _mm_add_ps(
+        sum, _mm_mul_ps(_mm_shuffle_ps(vertex, vertex, 0xFF), row3));
+    _mm_storeu_ps(out + i * 4, sum);
+  }
+}
+
+// Two vertices per register: each 128-bit lane holds one vertex, and the
+// in-lane shuffle broadcasts its components against duplicated matrix rows.
+__attribute__((target("avx2"))) void transform4Avx2(const float* vertices,
+                                                    unsigned count,
+                                                    const float* matrix,
+                                                    float* out) {
+  const __m256 row0 = _mm256_broadcast_ps(
+      reinterpret_cast<const __m128*>(matrix));
+  const __m256 row1 = _mm256_broadcast_ps(
+      reinterpret_cast<const __m128*>(matrix + 4));
+  const __m256 row2 = _mm256_broadcast_ps(
+      reinterpret_cast<const __m128*>(matrix + 8));
+  const __m256 row3 = _mm256_broadcast_ps(
+      reinterpret_cast<const __m128*>(matrix + 12));
+
+  unsigned i = 0;
+  for (; i + 2 <= count; i += 2) {
+    const __m256 pair = _mm256_loadu_ps(vertices + i * 4);
+    __m256 sum = _mm256_setzero_ps();
+    sum = _mm256_add_ps(
+        sum, _mm256_mul_ps(_mm256_shuffle_ps(pair, pair, 0x00), row0));
+    sum = _mm256_add_ps(
+        sum, _mm256_mul_ps(_mm256_shuffle_ps(pair, pair, 0x55), row1));
+    sum = _mm256_add_ps(
+        sum, _mm256_mul_ps(_mm256_shuffle_ps(pair, pair, 0xAA), row2));
+    sum = _mm256_add_ps(
+        sum, _mm256_mul_ps(_mm256_shuffle_ps(pair, pair, 0xFF), row3));
+    _mm256_storeu_ps(out + i * 4, sum);
+  }
+  if (i < count) {
+    transform4Sse(vertices + i * 4, count - i, matrix, out + i * 4);
+  }
+}
+#endif
+
+using TransformKernel = void (*)(const float*, unsigned, const float*, float*);
+
+struct Kernels {
+  Isa isa;
+  TransformKernel transform3;
+  TransformKernel transform4;
+};
+
+Kernels select(Isa isa) {
+#ifdef MATH_SIMD_X86
+  if (isa == Isa::avx2) return {Isa::avx2, transform3Sse, transform4Avx2};
+  if (isa == Isa::sse) return {Isa::sse, transform3Sse, transform4Sse};
+#endif
+  return {Isa::scalar, transform3Scalar, transform4Scalar};
+}
+
+// Function-local so kernels are usable from other static initializers.
+Kernels& current() {
+  static Kernels kernels = select(detect());
+  return kernels;
+}
+}  // namespace
+
+Isa detect() {
+#ifdef MATH_SIMD_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2")) return Isa::avx2;
+  if (__builtin_cpu_supports("sse2")) return Isa::sse;
+#endif
+  return Isa::scalar;
+}
+
+Isa active() { return current().isa; }
+
+void setIsa(Isa isa) { current() = select(std::min(isa, detect())); }
+
+void multiply3x3(const float* left, const float* right, float* out) {
+  current().transform3(left, 3, right, out);
+}
+
+void multiply4x4(const float* left, const float* right, float* out) {
+  current().transform4(left, 4, right, out);
+}
+
+void transform3(const float* vertices, unsigned count, const float* matrix,
+                float* out) {
+  current().transform3(vertices, count, matrix, out);
+}
+
+void transform4(const float* vertices, unsigned count, const float* matrix,
+                float* out) {
+  current().transform4(vertices, count, matrix, out);
+}
+}  // namespace math::simd
@@ -0,0 +1,28 @@
+#pragma once
+
+namespace math::simd {
+enum class Isa { scalar, sse, avx2 };
+
+// Best instruction set supported by the running CPU.
+Isa detect();
+
+// Instruction set used by the kernels below. Defaults to detect(); can be
+// lowered (e.g. to compare paths in tests) but never raised above it.
+Isa active();
+void setIsa(Isa isa);
+
+// All kernels use row vectors and row-major matrices, i.e. out = in * matrix,
+// and require `out` not to alias the inputs. Vector paths multiply and add in
+// the same order as the scalar loop and never fuse, so every ISA produces
+// bit-identical results (0 ULP), unless the whole build enables FMA
+// contraction (e.g. -march=native), in which case the scalar fallback may
+// differ from the vector paths by 1 ULP per accumulated term.
+void multiply3x3(const float* left, const float* right, float* out);
+void multiply4x4(const float* left, const float* right, float* out);
+
+// Transforms `count` tightly packed 3- or 4-component vertices.
+void transform3(const float* vertices, unsigned count, const float* matrix,
+                float* out);
+void transform4(const float* vertices, unsigned count, const float* matrix,
+                float* out);
+}  // namespace math::simd
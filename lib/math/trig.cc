@@ -0,0 +1,263 @@
+#include "trig.hh"
+
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <span>
+
+#include "simd.hh"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define MATH_TRIG_X86 1
+#include <immintrin.h>
+#endif
+
+namespace math {
+namespace {
+constexpr float two_over_pi = 0.636619772367581343f;
+// pi/2 split so that quadrant * pi_2_a is exact for every quadrant within
+// trig_range (Cody-Waite reduction); the fast level drops the third part.
+constexpr float pi_2_a = 1.5703125f;
+constexpr float pi_2_b = 4.837512969970703125e-4f;
+constexpr float pi_2_c = 7.54978995489188216e-8f;
+constexpr float fast_pi_2_b = 4.83826794e-4f;
+
+// Minimax coefficients for [-pi/4, pi/4] from Cephes sinf/cosf.
+constexpr float sin_0 = -1.6666654611e-1f;
+constexpr float sin_1 = 8.3321608736e-3f;
+constexpr float sin_2 = -1.9515295891e-4f;
+constexpr float cos_0 = 4.166664568298827e-2f;
+constexpr float cos_1 = -1.388731625493765e-3f;
+constexpr float cos_2 = 2.443315711809948e-5f;
+
+// Taylor coefficients for the fast level.
+constexpr float fast_sin_0 = -1.f / 6.f;
+constexpr float fast_sin_1 = 1.f / 120.f;
+constexpr float fast_cos_0 = 1.f / 24.f;
+constexpr float fast_cos_1 = -1.f / 720.f;
+
+// The vector kernels below perform exactly these operations in this order.
+template <Accuracy accuracy>
+SinCos evaluate(float angle) {
+  if (!(std::fabs(angle) <= trig_range)) {
+    return {std::sin(angle), std::cos(angle)};
+  }
+  const int quadrant = static_cast<int>(std::lrint(angle * two_over_pi));
+  const float j = static_cast<float>(quadrant);
+  float r = angle - j * pi_2_a;
+  if constexpr (accuracy == Accuracy::precise) {
+    r = (r - j * pi_2_b) - j * pi_2_c;
+  } else {
+    r = r - j * fast_pi_2_b;
+  }
+  const float z = r * r;
+  float s;
+  float c;
+  if constexpr (accuracy == Accuracy::precise) {
+    s = ((sin_2 * z + sin_1) * z + sin_0) * z * r + r;
+    c = ((cos_2 * z + cos_1) * z + cos_0) * z * z - 0.5f * z + 1.f;
+  } else {
+    s = (fast_sin_1 * z + fast_sin_0) * z * r + r;
+    c = ((fast_cos_1 * z + fast_cos_0) * z - 0.5f) * z + 1.f;
+  }
+
+  // angle = quadrant * pi/2 + r: odd quadrants swap sine and cosine, and
+  // the signs follow the quadrant's position on the circle.
+  SinCos result = quadrant & 1 ? SinCos{c, s} : SinCos{s, c};
+  if (quadrant & 2) result.sin = -result.sin;
+  if ((quadrant + 1) & 2) result.cos = -result.cos;
+  return result;
+}
+
+template <Accuracy accuracy>
+void sincosScalar(const float* angles, std::size_t begin, std::size_t end,
+                  float* sines, float* cosines) {
+  for (std::size_t i = begin; i < end; i++) {
+    const SinCos result = evaluate<accuracy>(angles[i]);
+    sines[i] = result.sin;
+    cosines[i] = result.cos;
+  }
+}
+
+#ifdef MATH_TRIG_X86
+template <Accuracy accuracy>
+void sincosSse(const float* angles, std::size_t count, float* sines,
+               float* cosines) {
+  const __m128 scale = _mm_set1_ps(two_over_pi);
+  const __m128 range = _mm_set1_ps(trig_range);
+  const __m128 sign = _mm_set1_ps(-0.f);
+  const __m128 half = _mm_set1_ps(0.5f);
+  const __m128 one = _mm_set1_ps(1.f);
+  const __m128i odd = _mm_set1_epi32(1);
+  const __m128i negative = _mm_set1_epi32(2);
+
+  std::size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    const __m128 angle = _mm_loadu_ps(angles + i);
+    const __m128i quadrant = _mm_cvtps_epi32(_mm_mul_ps(angle, scale));
+    const __m128 j = _mm_cvtepi32_ps(quadrant);
+
+    __m128 r = _mm_sub_ps(angle, _mm_mul_ps(j, _mm_set1_ps(pi_2_a)));
+    __m128 s;
+    __m128 c;
+    if constexpr (accuracy == Accuracy::precise) {
+      r = _mm_sub_ps(r, _mm_mul_ps(j, _mm_set1_ps(pi_2_b)));
+      r = _mm_sub_ps(r, _mm_mul_ps(j, _mm_set1_ps(pi_2_c)));
+      const __m128 z = _mm_mul_ps(r, r);
+      s = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(sin_2), z), _mm_set1_ps(sin_1));
+      s = _mm_add_ps(_mm_mul_ps(s, z), _mm_set1_ps(sin_0));
+      s = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(s, z), r), r);
+      c = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(cos_2), z), _mm_set1_ps(cos_1));
+      c = _mm_add_ps(_mm_mul_ps(c, z), _mm_set1_ps(cos_0));
+      c = _mm_sub_ps(_mm_mul_ps(_mm_mul_ps(c, z), z), _mm_mul_ps(half, z));
+      c = _mm_add_ps(c, one);
+    } else {
+      r = _mm_sub_ps(r, _mm_mul_ps(j, _mm_set1_ps(fast_pi_2_b)));
+      const __m128 z = _mm_mul_ps(r, r);
+      s = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(fast_sin_1), z),
+                     _mm_set1_ps(fast_sin_0));
+      s = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(s, z), r), r);
+      c = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(fast_cos_1), z),
+                     _mm_set1_ps(fast_cos_0));
+      c = _mm_sub_ps(_mm_mul_ps(c, z), half);
+      c = _mm_add_ps(_mm_mul_ps(c, z), one);
+    }
+
+    const __m128 swap = _mm_castsi128_ps(
+        _mm_cmpeq_epi32(_mm_and_si128(quadrant, odd), odd));
+    const __m128 sin_sign = _mm_castsi128_ps(
+        _mm_slli_epi32(_mm_and_si128(quadrant, negative), 30));
+    const __m128 cos_sign = _mm_castsi128_ps(_mm_slli_epi32(
+        _mm_and_si128(_mm_add_epi32(quadrant, odd), negative), 30));
+    const __m128 sine = _mm_or_ps(_mm_and_ps(swap, c), _mm_andnot_ps(swap, s));
+    const __m128 cosine =
+        _mm_or_ps(_mm_and_ps(swap, s), _mm_andnot_ps(swap, c));
+    _mm_storeu_ps(sines + i, _mm_xor_ps(sine, sin_sign));
+    _mm_storeu_ps(cosines + i, _mm_xor_ps(cosine, cos_sign));
+
+    // Also true for NaN, like the scalar check.
+    const int outside =
+        _mm_movemask_ps(_mm_cmpnle_ps(_mm_andnot_ps(sign, angle), range));
+    if (outside) {
+      alignas(16) float lanes[4];
+      _mm_store_ps(lanes, angle);
+      for (unsigned lane = 0; lane < 4; lane++) {
+        if (!(outside & (1 << lane))) continue;
+        sines[i + lane] = std::sin(lanes[lane]);
+        cosines[i + lane] = std::cos(lanes[lane]);
+      }
+    }
+  }
+  sincosScalar<accuracy>(angles, i, count, sines, cosines);
+}
+
+template <Accuracy accuracy>
+__attribute__((target("avx2"))) void sincosAvx2(const float* angles,
+                                                std::size_t count,
+                                                float* sines,
+                                                float* cosines) {
+  const __m256 scale = _mm256_set1_ps(two_over_pi);
+  const __m256 range = _mm256_set1_ps(trig_range);
+  const __m256 sign = _mm256_set1_ps(-0.f);
+  const __m256 half = _mm256_set1_ps(0.5f);
+  const __m256 one = _mm256_set1_ps(1.f);
+  const __m256i odd = _mm256_set1_epi32(1);
+  const __m256i negative = _mm256_set1_epi32(2);
+
+  std::size_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    const __m256 angle = _mm256_loadu_ps(angles + i);
+    const __m256i quadrant = _mm256_cvtps_epi32(_mm256_mul_ps(angle, scale));
+    const __m256 j = _mm256_cvtepi32_ps(quadrant);
+
+    __m256 r = _mm256_sub_ps(angle, _mm256_mul_ps(j, _mm256_set1_ps(pi_2_a)));
+    __m256 s;
+    __m256 c;
+    if constexpr (accuracy == Accuracy::precise) {
+      r = _mm256_sub_ps(r, _mm256_mul_ps(j, _mm256_set1_ps(pi_2_b)));
+      r = _mm256_sub_ps(r, _mm256_mul_ps(j, _mm256_set1_ps(pi_2_c)));
+      const __m256 z = _mm256_mul_ps(r, r);
+      s = _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(sin_2), z),
+                        _mm256_set1_ps(sin_1));
+      s = _mm256_add_ps(_mm256_mul_ps(s, z), _mm256_set1_ps(sin_0));
+      s = _mm256_add_ps(_mm256_mul_ps(_mm256_mul_ps(s, z), r), r);
+      c = _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(cos_2), z),
+                        _mm256_set1_ps(cos_1));
+      c = _mm256_add_ps(_mm256_mul_ps(c, z), _mm256_set1_ps(cos_0));
+      c = _mm256_sub_ps(_mm256_mul_ps(_mm256_mul_ps(c, z), z),
+                        _mm256_mul_ps(half, z));
+      c = _mm256_add_ps(c, one);
+    } else {
+      r = _mm256_sub_ps(r, _mm256_mul_ps(j, _mm256_set1_ps(fast_pi_2_b)));
+      const __m256 z = _mm256_mul_ps(r, r);
+      s = _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(fast_sin_1), z),
+                        _mm256_set1_ps(fast_sin_0));
+      s = _mm256_add_ps(_mm256_mul_ps(_mm256_mul_ps(s, z), r), r);
+      c = _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(fast_cos_1), z),
+                        _mm256_set1_ps(fast_cos_0));
+      c = _mm256_sub_ps(_mm256_mul_ps(c, z), half);
+      c = _mm256_add_ps(_mm256_mul_ps(c, z), one);
+    }
+
+    const __m256 swap = _mm256_castsi256_ps(
+        _mm256_cmpeq_epi32(_mm256_and_si256(quadrant, odd), odd));
+    const __m256 sin_sign = _mm256_castsi256_ps(
+        _mm256_slli_epi32(_mm256_and_si256(quadrant, negative), 30));
+    const __m256 cos_sign = _mm256_castsi256_ps(_mm256_slli_epi32(
+        _mm256_and_si256(_mm256_add_epi32(quadrant, odd), negative), 30));
+    _mm256_storeu_ps(sines + i,
+                     _mm256_xor_ps(_mm256_blendv_ps(s, c, swap), sin_sign));
+    _mm256_storeu_ps(cosines + i,
+                     _mm256_xor_ps(_mm256_blendv_ps(c, s, swap), cos_sign));
+
+    const int outside = _mm256_movemask_ps(
+        _mm256_cmp_ps(_mm256_andnot_ps(sign, angle), range, _CMP_NLE_UQ));
+    if (outside) {
+      alignas(32) float lanes[8];
+      _mm256_store_ps(lanes, angle);
+      for (unsigned lane = 0; lane < 8; lane++) {
+        if (!(outside & (1 << lane))) continue;
+        sines[i + lane] = std::sin(lanes[lane]);
+        cosines[i + lane] = std::cos(lanes[lane]);
+      }
+    }
+  }
+  sincosScalar<accuracy>(angles, i, count, sines, cosines);
+}
+#endif
+
+template <Accuracy accuracy>
+void dispatch(const float* angles, std::size_t count, float* sines,
+              float* cosines) {
+  switch (simd::active()) {
+#ifdef MATH_TRIG_X86
+    case simd::Isa::avx2:
+      sincosAvx2<accuracy>(angles, count, sines, cosines);
+      return;
+    case simd::Isa::sse:
+      sincosSse<accuracy>(angles, count, sines, cosines);
+      return;
+#endif
+    default:
+      sincosScalar<accuracy>(angles, 0, count, sines, cosines);
+  }
+}
+}  // namespace
+
+SinCos sincos(float angle, Accuracy accuracy) {
+  return accuracy == Accuracy::precise ? evaluate<Accuracy::precise>(angle)
+                                       : evaluate<Accuracy::fast>(angle);
+}
+
+void sincos(std::span<const float> angles, std::span<float> sines,
+            std::span<float> cosines, Accuracy accuracy) {
+  assert(sines.size() >= angles.size() && cosines.size() >= angles.size());
+  if (accuracy == Accuracy::precise) {
+    dispatch<Accuracy::precise>(angles.data(), angles.size(), sines.data(),
+                                cosines.data());
+  } else {
+    dispatch<Accuracy::fast>(angles.data(), angles.size(), sines.data(),
+                             cosines.data());
+  }
+}
+}  // namespace math
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <span>
+
+namespace math {
+// Polynomial sine and cosine evaluated together, sharing one range
+// reduction. Angles are reduced to [-pi/4, pi/4] around the nearest multiple
+// of pi/2 and both polynomials are evaluated there.
+//
+// Maximum absolute error against the exact values for |angle| <= trig_range:
+//   precise  8e-8, under 1.5 ulp for results between 0.5 and 1.
+//   fast     3.7e-5, from a degree 5 sine and a degree 6 cosine.
+// Beyond trig_range, and for NaN or infinity, both levels fall back to
+// std::sin and std::cos.
+//
+// Batch versions use the instruction set picked by math::simd::active() and
+// process 4 (SSE) or 8 (AVX2) angles per step. Like the other math::simd
+// kernels they never fuse multiplies and adds, so every ISA and the scalar
+// function return bit-identical results.
+enum class Accuracy { fast, precise };
+
+struct SinCos {
+  float sin;
+  float cos;
+};
+
+inline constexpr float trig_range = 8192.f;
+
+SinCos sincos(float angle, Accuracy accuracy = Accuracy::precise);
+
+// Writes the sine and cosine of every angle. `sines` and `cosines` must hold
+// at least angles.size() floats; either one may be `angles` itself.
+void sincos(std::span<const float> angles, std::span<float> sines,
+            std::span<float> cosines, Accuracy accuracy = Accuracy::precise);
+}  // namespace math
@@ -0,0 +1,173 @@
+#include "File.hh"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <utils/fs.hh>
+
+#include "Mesh.hh"
+
+namespace mesh {
+namespace {
+static_assert(std::endian::native == std::endian::little,
+              "Mesh files are read in place and stored little-endian");
+
+constexpr std::uint32_t float_stride = 3 * sizeof(float);
+constexpr std::uint32_t quantized_stride = 4 * sizeof(std::uint16_t);
+constexpr float quantized_max = std::numeric_limits<std::uint16_t>::max();
+
+std::uint64_t alignUp(std::uint64_t offset) {
+  return (offset + file_alignment - 1) / file_alignment * file_alignment;
+}
+
+void writeBlock(std::ofstream& out, std::uint64_t offset,
+                std::span<const std::byte> block) {
+  static constexpr std::array<char, file_alignment> zeros{};
+  const auto position = static_cast<std::uint64_t>(out.tellp());
+  out.write(zeros.data(), static_cast<std::streamsize>(offset - position));
+  out.write(reinterpret_cast<const char*>(block.data()),
+            static_cast<std::streamsize>(block.size()));
+}
+
+std::vector<std::uint16_t> quantizePositions(const Geometry& geometry,
+                                             const FileHeader& header) {
+  std::vector<std::uint16_t> result(geometry.vertices() * 4);
+  for (std::size_t vertex = 0; vertex < geometry.vertices(); vertex++) {
+    for (unsigned axis = 0; axis < 3; axis++) {
+      const float low = header.bounds_min[axis];
+      const float extent = header.bounds_max[axis] - low;
+      const float value = geometry.positions[vertex * 3 + axis];
+      const float unit = extent > 0 ? (value - low) / extent : 0;
+      result[vertex * 4 + axis] =
+          static_cast<std::uint16_t>(std::lround(unit * quantized_max));
+    }
+    result[vertex * 4 + 3] = static_cast<std::uint16_t>(quantized_max);
+  }
+  return result;
+}
+}  // namespace
+
+void writeFile(const std::filesystem::path& path, const Geometry& geometry,
+               bool quantize) {
+  if (geometry.positions.size() % 3 != 0 || geometry.indices.size() % 3 != 0) {
+    throw std::runtime_error{"Incomplete vertex or triangle in mesh for " +
+                             path.string()};
+  }
+  if (geometry.vertices() > std::numeric_limits<std::uint32_t>::max() ||
+      geometry.indices.size() > std::numeric_limits<std::uint32_t>::max()) {
+    throw std::runtime_error{"Mesh too large for " + path.string()};
+  }
+
+  FileHeader header{};
+  header.magic = file_magic;
+  header.version = file_version;
+  header.flags = quantize ? quantized_flag : 0;
+  header.vertex_count = static_cast<std::uint32_t>(geometry.vertices());
+  header.index_count = static_cast<std::uint32_t>(geometry.indices.size());
+  header.vertex_stride = quantize ? quantized_stride : float_stride;
+  header.index_size = geometry.vertices() <= 65536 ? sizeof(std::uint16_t)
+                                                   : sizeof(std::uint32_t);
+  header.vertex_offset = alignUp(sizeof(FileHeader));
+  header.index_offset =
+      alignUp(header.vertex_offset +
+              std::uint64_t{header.vertex_count} * header.vertex_stride);
+  if (geometry.vertices() > 0) {
+    header.bounds_min.fill(std::numeric_limits<float>::max());
+    header.bounds_max.fill(std::numeric_limits<float>::lowest());
+  }
+  for (std::size_t i = 0; i < geometry.positions.size(); i++) {
+    float& low = header.bounds_min[i % 3];
+    float& high = header.bounds_max[i % 3];
+    low = std::min(low, geometry.positions[i]);
+    high = std::max(high, geometry.positions[i]);
+  }
+
+  std::ofstream out{path, std::ios::binary | std::ios::trunc};
+  if (!out) throw std::runtime_error{"Cannot open " + path.string()};
+  out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+  if (quantize) {
+    const std::vector<std::uint16_t> quantized =
+        quantizePositions(geometry, header);
+    writeBlock(out, header.vertex_offset, std::as_bytes(std::span{quantized}));
+  } else {
+    writeBlock(out, header.vertex_offset,
+               std::as_bytes(std::span{geometry.positions}));
+  }
+  if (header.index_size == sizeof(std::uint32_t)) {
+    writeBlock(out, header.index_offset,
+               std::as_bytes(std::span{geometry.indices}));
+  } else {
+    const std::vector<std::uint16_t> narrow(geometry.indices.begin(),
+                                            geometry.indices.end());
+    writeBlock(out, header.index_offset, std::as_bytes(std::span{narrow}));
+  }
+  if (!out) throw std::runtime_error{"Error while writing " + path.string()};
+}
+
+File::File(const std::filesystem::path& path)
+    : mapping{path, utils::MappedFile::Access::sequential} {
+  const auto fail = [&](const std::string& reason) {
+    throw std::runtime_error{reason + " in mesh " + path.string()};
+  };
+  if (mapping.size() < sizeof(FileHeader)) fail("Truncated header");
+  const FileHeader& info = header();
+  if (info.magic != file_magic) fail("Missing magic number");
+  if (info.version != file_version) {
+    fail("Unsupported version " + std::to_string(info.version));
+  }
+  if ((info.flags & ~quantized_flag) != 0) fail("Unknown flags");
+  if (info.vertex_stride != (quantized() ? quantized_stride : float_stride)) {
+    fail("Unexpected vertex stride");
+  }
+  if (info.index_size != sizeof(std::uint16_t) &&
+      info.index_size != sizeof(std::uint32_t)) {
+    fail("Unexpected index size");
+  }
+  if (info.index_count % 3 != 0) fail("Incomplete triangle");
+  const std::size_t size = mapping.size();
+  const auto fits = [&](std::uint64_t offset, std::uint64_t bytes) {
+    return offset % file_alignment == 0 && offset <= size &&
+           bytes <= size - offset;
+  };
+  if (!fits(info.vertex_offset,
+            std::uint64_t{info.vertex_count} * info.vertex_stride) ||
+      !fits(info.index_offset,
+            std::uint64_t{info.index_count} * info.index_size)) {
+    fail("Block out of bounds");
+  }
+}
+
+// The mapping is page aligned and the header is 64 bytes of plain fields.
+const FileHeader& File::header() const {
+  return *reinterpret_cast<const FileHeader*>(mapping.bytes().data());
+}
+
+bool File::quantized() const {
+  return (header().flags & quantized_flag) != 0;
+}
+
+std::span<const std::byte> File::vertices() const {
+  const FileHeader& info = header();
+  return mapping.bytes().subspan(
+      info.vertex_offset, std::size_t{info.vertex_count} * info.vertex_stride);
+}
+
+std::span<const std::byte> File::indices() const {
+  const FileHeader& info = header();
+  return mapping.bytes().subspan(
+      info.index_offset, std::size_t{info.index_count} * info.index_size);
+}
+}  // namespace mesh
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+
+#include <utils/fs.hh>
+
+#include "Mesh.hh"
+
+namespace mesh {
+// Binary mesh file, laid out to be drawn straight from a memory mapping:
+//
+//   FileHeader   64 bytes
+//   vertices     vertex_count * vertex_stride bytes at vertex_offset
+//   indices      index_count * index_size bytes at index_offset
+//
+// Both blocks start on a file_alignment boundary and all values are
+// little-endian. Vertices are x, y, z floats or, with the quantized flag,
+// x, y, z, w unsigned shorts spanning the bounding box, where w is always
+// 65535 so normalized reads see w = 1. Indices are 16-bit when the vertices
+// allow it and 32-bit otherwise.
+struct FileHeader {
+  std::array<char, 4> magic;
+  std::uint16_t version;
+  std::uint16_t flags;
+  std::uint32_t vertex_count;
+  std::uint32_t index_count;
+  std::uint32_t vertex_stride;
+  std::uint32_t index_size;
+  std::uint64_t vertex_offset;
+  std::uint64_t index_offset;
+  std::array<float, 3> bounds_min;
+  std::array<float, 3> bounds_max;
+};
+
+static_assert(sizeof(FileHeader) == 64);
+
+inline constexpr std::array<char, 4> file_magic{'M', 'E', 'S', 'H'};
+// Bumped on any layout change; readers reject other versions.
+inline constexpr std::uint16_t file_version = 1;
+inline constexpr std::size_t file_alignment = 64;
+inline constexpr std::uint16_t quantized_flag = 1;
+
+// Writes `geometry` to `path`. Quantizing halves the vertex block at the cost
+// of 1/65535 of the bounding box in precision.
+void writeFile(const std::filesystem::path& path, const Geometry& geometry,
+               bool quantize = false);
+
+// Read-only memory mapping of a mesh file, advised for sequential reads.
+// The header and block bounds are validated when opening; indices are not
+// checked against the vertex count, which would fault in the whole index
+// block.
+class File {
+ public:
+  File() = delete;
+  explicit File(const std::filesystem::path& path);
+
+  const FileHeader& header() const;
+  bool quantized() const;
+  std::span<const std::byte> vertices() const;
+  std::span<const std::byte> indices() const;
+
+ private:
+  utils::MappedFile mapping;
+};
+}  // namespace mesh
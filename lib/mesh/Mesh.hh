@@ -0,0 +1,181 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <numbers>
+#include <vector>
+
+#include <math/Mat.hh>
+#include <math/trig.hh>
+
+namespace mesh {
+using Index = std::uint16_t;
+
+// Indexed triangle list: every distinct vertex is stored once in `positions`
+// and each three `indices` form a triangle, counter-clockwise when seen from
+// outside. Positions are homogeneous, (x, y, 1) in 2D and (x, y, z, 1) in 3D.
+template <unsigned vertex_count, unsigned index_count, unsigned components>
+struct Mesh {
+  math::Mat<vertex_count, components> positions;
+  std::array<Index, index_count> indices{};
+
+  static constexpr unsigned vertices = vertex_count;
+  static constexpr unsigned triangles = index_count / 3;
+};
+
+// Triangle list sized at run time, as read from model files: x, y, z per
+// vertex, three indices per triangle wound like Mesh.
+struct Geometry {
+  std::vector<float> positions;
+  std::vector<std::uint32_t> indices;
+
+  std::size_t vertices() const { return positions.size() / 3; }
+  std::size_t triangles() const { return indices.size() / 3; }
+};
+
+// std::sin and std::cos only become constexpr in C++26. Taylor series in
+// double after reducing the angle to [-pi, pi], exact to float precision.
+constexpr math::SinCos constantSinCos(double angle) {
+  constexpr double turn = 2 * std::numbers::pi;
+  const double turns = angle / turn;
+  angle -= turn * static_cast<long long>(turns + (turns < 0 ? -0.5 : 0.5));
+
+  double sin = 0;
+  double cos = 0;
+  double term = 1;
+  for (unsigned power = 0; power < 30; power++) {
+    const double value = (power / 2 % 2 == 0) ? term : -term;
+    if (power % 2 == 0) {
+      cos += value;
+    } else {
+      sin += value;
+    }
+    term *= angle / (power + 1);
+  }
+  return {static_cast<float>(sin), static_cast<float>(cos)};
+}
+
+// Regular polygon around the origin with a vertex at `start_angle`,
+// triangulated as a fan from vertex 0.
+template <unsigned sides>
+  requires(sides >= 3)
+constexpr Mesh<sides, 3 * (sides - 2), 3> polygon(float radius,
+                                                  float start_angle = 0) {
+  Mesh<sides, 3 * (sides - 2), 3> result;
+  for (unsigned i = 0; i < sides; i++) {
+    const auto [sin, cos] =
+        constantSinCos(start_angle + 2 * std::numbers::pi * i / sides);
+    result.positions(i, 0) = radius * cos;
+    result.positions(i, 1) = radius * sin;
+    result.positions(i, 2) = 1;
+  }
+  for (unsigned i = 1; i + 1 < sides; i++) {
+    const unsigned triangle = 3 * (i - 1);
+    result.indices[triangle] = 0;
+    result.indices[triangle + 1] = i;
+    result.indices[triangle + 2] = i + 1;
+  }
+  return result;
+}
+
+// Pyramid over a regular polygon lying in the y = low plane, with the apex
+// above the polygon's center at y = high. The apex is the last vertex.
+template <unsigned sides>
+  requires(sides >= 3)
+constexpr Mesh<sides + 1, 6 * sides - 6, 4> pyramid(float radius, float low,
+                                                    float high,
+                                                    float start_angle = 0) {
+  Mesh<sides + 1, 6 * sides - 6, 4> result;
+  const auto base = polygon<sides>(radius, start_angle);
+  for (unsigned i = 0; i < sides; i++) {
+    result.positions(i, 0) = base.positions(i, 0);
+    result.positions(i, 1) = low;
+    result.positions(i, 2) = base.positions(i, 1);
+    result.positions(i, 3) = 1;
+  }
+  result.positions(sides, 1) = high;
+  result.positions(sides, 3) = 1;
+
+  // The polygon's fan faces +z; mapped to xz it faces down, out of the base.
+  unsigned next = 0;
+  for (const Index index : base.indices) result.indices[next++] = index;
+  for (unsigned i = 0; i < sides; i++) {
+    result.indices[next++] = (i + 1) % sides;
+    result.indices[next++] = i;
+    result.indices[next++] = sides;
+  }
+  return result;
+}
+
+// Axis-aligned cube around the origin. Bits 0, 1 and 2 of a vertex number
+// select +x, +y and +z.
+constexpr Mesh<8, 36, 4> cube(float half_size) {
+  Mesh<8, 36, 4> result;
+  for (unsigned i = 0; i < 8; i++) {
+    result.positions(i, 0) = i & 1 ? half_size : -half_size;
+    result.positions(i, 1) = i & 2 ? half_size : -half_size;
+    result.positions(i, 2) = i & 4 ? half_size : -half_size;
+    result.positions(i, 3) = 1;
+  }
+  // One counter-clockwise quad per face: -x, +x, -y, +y, -z, +z.
+  constexpr Index faces[6][4] = {{0, 4, 6, 2}, {1, 3, 7, 5}, {0, 1, 5, 4},
+                                 {2, 6, 7, 3}, {0, 2, 3, 1}, {4, 5, 7, 6}};
+  unsigned next = 0;
+  for (const auto& face : faces) {
+    for (const unsigned corner : {0, 1, 2, 0, 2, 3}) {
+      result.indices[next++] = face[corner];
+    }
+  }
+  return result;
+}
+
+// UV sphere around the origin: `rings` bands of latitude between the poles
+// and `segments` vertices around each inner ring. Vertex 0 is the north
+// (+y) pole and the last one the south pole.
+template <unsigned rings, unsigned segments>
+  requires(rings >= 2 && segments >= 3)
+constexpr Mesh<(rings - 1) * segments + 2, 6 * segments * (rings - 1), 4>
+sphere(float radius) {
+  constexpr unsigned south = (rings - 1) * segments + 1;
+  Mesh<south + 1, 6 * segments * (rings - 1), 4> result;
+  result.positions(0, 1) = radius;
+  result.positions(0, 3) = 1;
+  for (unsigned ring = 1; ring < rings; ring++) {
+    const auto [sin_latitude, cos_latitude] =
+        constantSinCos(std::numbers::pi * ring / rings);
+    for (unsigned segment = 0; segment < segments; segment++) {
+      const auto [sin_longitude, cos_longitude] =
+          constantSinCos(2 * std::numbers::pi * segment / segments);
+      const unsigned vertex = 1 + (ring - 1) * segments + segment;
+      result.positions(vertex, 0) = radius * sin_latitude * cos_longitude;
+      result.positions(vertex, 1) = radius * cos_latitude;
+      result.positions(vertex, 2) = radius * sin_latitude * sin_longitude;
+      result.positions(vertex, 3) = 1;
+    }
+  }
+  result.positions(south, 1) = -radius;
+  result.positions(south, 3) = 1;
+
+  const auto at = [](unsigned ring, unsigned segment) {
+    return static_cast<Index>(1 + (ring - 1) * segments + segment % segments);
+  };
+  unsigned next = 0;
+  const auto triangle = [&](Index a, Index b, Index c) {
+    result.indices[next++] = a;
+    result.indices[next++] = b;
+    result.indices[next++] = c;
+  };
+  for (unsigned segment = 0; segment < segments; segment++) {
+    triangle(0, at(1, segment + 1), at(1, segment));
+    for (unsigned ring = 1; ring + 1 < rings; ring++) {
+      triangle(at(ring, segment), at(ring, segment + 1),
+               at(ring + 1, segment + 1));
+      triangle(at(ring, segment), at(ring + 1, segment + 1),
+               at(ring + 1, segment));
+    }
+    triangle(south, at(rings - 1, segment), at(rings - 1, segment + 1));
+  }
+  return result;
+}
+}  // namespace mesh
@@ -0,0 +1,179 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <span>
+#include <vector>
+
+#include "Mesh.hh"
+
+namespace mesh {
+// Post-transform vertex cache size the reordering optimizes for.
+inline constexpr unsigned cache_size = 32;
+
+namespace detail {
+constexpr float squareRoot(float value) {
+  if (value <= 0) return 0;
+  float root = value > 1 ? value : 1;
+  for (unsigned i = 0; i < 16; i++) root = 0.5f * (root + value / root);
+  return root;
+}
+
+// Tom Forsyth's vertex score, tabulated: vertices used by the last triangle
+// score a fixed value so its neighbours do not always win, older cache
+// entries decay with their position, and vertices with few triangles left get
+// a boost so they are finished off instead of being left stranded.
+struct Scores {
+  static constexpr unsigned max_valence = 32;
+  std::array<float, cache_size> position{};
+  std::array<float, max_valence + 1> valence{};
+
+  constexpr Scores() {
+    for (unsigned i = 0; i < cache_size; i++) {
+      const float fraction = 1.f - (i - 3.f) / (cache_size - 3);
+      position[i] = i < 3 ? 0.75f : fraction * squareRoot(fraction);
+    }
+    for (unsigned i = 1; i <= max_valence; i++) {
+      valence[i] = 2.f / squareRoot(static_cast<float>(i));
+    }
+  }
+
+  // `cache_position` is -1 outside the cache.
+  constexpr float operator()(int cache_position, unsigned remaining) const {
+    if (remaining == 0) return -1;
+    return (cache_position < 0 ? 0 : position[cache_position]) +
+           valence[std::min(remaining, max_valence)];
+  }
+};
+}  // namespace detail
+
+// Vertex shader invocations per triangle for a FIFO cache with `size`
+// entries: 3 for a cache that never hits, 0.5 is the ideal for large grids.
+template <typename Index>
+constexpr float acmr(std::span<const Index> indices, unsigned size = 16) {
+  if (indices.empty()) return 0;
+  std::vector<Index> fifo;
+  unsigned misses = 0;
+  for (const Index index : indices) {
+    if (std::find(fifo.begin(), fifo.end(), index) != fifo.end()) continue;
+    misses++;
+    fifo.push_back(index);
+    if (fifo.size() > size) fifo.erase(fifo.begin());
+  }
+  return static_cast<float>(misses) / (indices.size() / 3);
+}
+
+// Reorders the triangles of `indices` so consecutive ones reuse vertices
+// that are still in the vertex cache, following Forsyth's "Linear-Speed
+// Vertex Cache Optimisation". Each triangle keeps its vertex order, so
+// winding is preserved. Usable in constant expressions, where compilers'
+// evaluation step limits allow meshes up to a few hundred triangles.
+template <typename Index>
+constexpr void optimizeVertexCache(std::span<Index> indices,
+                                   std::size_t vertex_count) {
+  const std::size_t triangle_count = indices.size() / 3;
+  if (triangle_count < 2) return;
+  const std::vector<Index> source(indices.begin(), indices.end());
+
+  // Triangles of every vertex, packed: vertex v owns
+  // adjacent[first[v], first[v] + remaining[v]), unemitted ones first.
+  std::vector<unsigned> remaining(vertex_count);
+  for (const Index index : source) remaining[index]++;
+  std::vector<std::size_t> first(vertex_count + 1);
+  for (std::size_t v = 0; v < vertex_count; v++) {
+    first[v + 1] = first[v] + remaining[v];
+  }
+  std::vector<std::size_t> adjacent(source.size());
+  {
+    std::vector<std::size_t> filled(first.begin(), first.end() - 1);
+    for (std::size_t i = 0; i < source.size(); i++) {
+      adjacent[filled[source[i]]++] = i / 3;
+    }
+  }
+
+  constexpr detail::Scores score;
+  std::vector<int> position(vertex_count, -1);
+  std::vector<float> vertex_score(vertex_count);
+  for (std::size_t v = 0; v < vertex_count; v++) {
+    vertex_score[v] = score(-1, remaining[v]);
+  }
+  std::vector<float> triangle_score(triangle_count);
+  std::vector<bool> emitted(triangle_count);
+  for (std::size_t t = 0; t < triangle_count; t++) {
+    for (unsigned corner = 0; corner < 3; corner++) {
+      triangle_score[t] += vertex_score[source[t * 3 + corner]];
+    }
+  }
+
+  std::vector<Index> lru;
+  std::vector<Index> next_lru;
+  std::size_t best = 0;
+  for (std::size_t t = 1; t < triangle_count; t++) {
+    if (triangle_score[t] > triangle_score[best]) best = t;
+  }
+  std::size_t scan = 0;
+  for (std::size_t output = 0; output < triangle_count; output++) {
+    if (best == triangle_count) {
+      // Nothing in the cache touches an unemitted triangle: take the best
+      // remaining one. Emitted triangles never come back, so the scan
+      // resumes where it stopped.
+      while (emitted[scan]) scan++;
+      best = scan;
+      for (std::size_t t = scan + 1; t < triangle_count; t++) {
+        if (!emitted[t] && triangle_score[t] > triangle_score[best]) best = t;
+      }
+    }
+
+    emitted[best] = true;
+    next_lru.clear();
+    for (unsigned corner = 0; corner < 3; corner++) {
+      const Index vertex = source[best * 3 + corner];
+      indices[output * 3 + corner] = vertex;
+      next_lru.push_back(vertex);
+      // Move the triangle past the vertex's unemitted ones.
+      const auto begin = adjacent.begin() + first[vertex];
+      const auto end = begin + remaining[vertex];
+      std::iter_swap(std::find(begin, end, best), end - 1);
+      remaining[vertex]--;
+    }
+    for (const Index vertex : lru) {
+      if (std::find(next_lru.begin(), next_lru.end(), vertex) ==
+          next_lru.end()) {
+        next_lru.push_back(vertex);
+      }
+    }
+    std::swap(lru, next_lru);
+
+    // Rescore the cache, and the evicted vertices past its end.
+    for (std::size_t i = 0; i < lru.size(); i++) {
+      position[lru[i]] = i < cache_size ? static_cast<int>(i) : -1;
+      vertex_score[lru[i]] = score(position[lru[i]], remaining[lru[i]]);
+    }
+    best = triangle_count;
+    float best_score = -1;
+    for (const Index vertex : lru) {
+      for (std::size_t i = 0; i < remaining[vertex]; i++) {
+        const std::size_t t = adjacent[first[vertex] + i];
+        triangle_score[t] = vertex_score[source[t * 3]] +
+                            vertex_score[source[t * 3 + 1]] +
+                            vertex_score[source[t * 3 + 2]];
+        if (triangle_score[t] > best_score) {
+          best_score = triangle_score[t];
+          best = t;
+        }
+      }
+    }
+    if (lru.size() > cache_size) lru.resize(cache_size);
+  }
+}
+
+// Copy of `mesh` with its triangles in vertex cache order, e.g. to build
+// constexpr meshes that are ready to draw.
+template <unsigned vertex_count, unsigned index_count, unsigned components>
+constexpr Mesh<vertex_count, index_count, components> optimized(
+    Mesh<vertex_count, index_count, components> mesh) {
+  optimizeVertexCache(std::span<Index>{mesh.indices}, vertex_count);
+  return mesh;
+}
+}  // namespace mesh
@@ -0,0 +1,92 @@
+#include "obj.hh"
+
+#include <algorithm>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+
+#include "Mesh.hh"
+
+namespace mesh {
+namespace {
+constexpr std::string_view blanks = " \t\r";
+
+// Splits off the next blank-separated token of `line`.
+std::string_view nextToken(std::string_view& line) {
+  const std::size_t begin =
+      std::min(line.find_first_not_of(blanks), line.size());
+  const std::size_t end =
+      std::min(line.find_first_of(blanks, begin), line.size());
+  const std::string_view token = line.substr(begin, end - begin);
+  line.remove_prefix(end);
+  return token;
+}
+
+template <typename T>
+bool parse(std::string_view token, T& value) {
+  const auto [end, error] =
+      std::from_chars(token.data(), token.data() + token.size(), value);
+  return error == std::errc{} && end == token.data() + token.size();
+}
+}  // namespace
+
+Geometry parseObj(std::string_view text) {
+  Geometry result;
+  std::size_t line_number = 0;
+  const auto fail = [&](std::string_view reason) {
+    throw std::runtime_error{std::string{reason} + " on OBJ line " +
+                             std::to_string(line_number)};
+  };
+
+  while (!text.empty()) {
+    line_number++;
+    const std::size_t end = std::min(text.find('\n'), text.size());
+    std::string_view line = text.substr(0, end);
+    text.remove_prefix(std::min(end + 1, text.size()));
+    line = line.substr(0, std::min(line.find('#'), line.size()));
+
+    const std::string_view keyword = nextToken(line);
+    if (keyword == "v") {
+      for (unsigned axis = 0; axis < 3; axis++) {
+        float value;
+        if (!parse(nextToken(line), value)) fail("Invalid vertex");
+        result.positions.push_back(value);
+      }
+    } else if (keyword == "f") {
+      const std::size_t vertices = result.vertices();
+      std::uint32_t first = 0;
+      std::uint32_t previous = 0;
+      unsigned corners = 0;
+      for (std::string_view token = nextToken(line); !token.empty();
+           token = nextToken(line)) {
+        // v, v/vt, v//vn or v/vt/vn: only the position is used.
+        long long reference;
+        if (!parse(token.substr(0, token.find('/')), reference)) {
+          fail("Invalid face");
+        }
+        const long long index =
+            reference < 0 ? static_cast<long long>(vertices) + reference
+                          : reference - 1;
+        if (index < 0 || index >= static_cast<long long>(vertices)) {
+          fail("Vertex reference out of range");
+        }
+        const auto corner = static_cast<std::uint32_t>(index);
+        if (corners == 0) {
+          first = corner;
+        } else if (corners >= 2) {
+          result.indices.insert(result.indices.end(),
+                                {first, previous, corner});
+        }
+        previous = corner;
+        corners++;
+      }
+      if (corners < 3) fail("Face with less than 3 corners");
+    }
+  }
+  return result;
+}
+}  // namespace mesh
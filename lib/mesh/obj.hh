@@ -0,0 +1,14 @@
+#pragma once
+
+#include <string_view>
+
+#include "Mesh.hh"
+
+namespace mesh {
+// Reads the vertex positions and faces of a Wavefront OBJ model. Polygons
+// are split into fans from their first corner, texture and normal references
+// are skipped, and negative indices count back from the last vertex. Other
+// statements (normals, groups, materials, ...) are ignored. Throws on
+// malformed `v` and `f` lines, naming the line number.
+Geometry parseObj(std::string_view text);
+}  // namespace mesh
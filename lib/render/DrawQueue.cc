@@ -0,0 +1,111 @@
+#include "DrawQueue.hh"
+
+#include <glad/glad.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+
+#include "StateCache.hh"
+
+namespace render {
+namespace {
+unsigned floatCount(DrawQueue::UniformType type) {
+  switch (type) {
+    case DrawQueue::UniformType::vector3:
+      return 3;
+    case DrawQueue::UniformType::matrix3x3:
+      return 9;
+    case DrawQueue::UniformType::matrix4x4:
+      return 16;
+  }
+  return 0;
+}
+
+std::uint64_t field(unsigned value, unsigned bits) {
+  return value & ((std::uint64_t{1} << bits) - 1);
+}
+}  // namespace
+
+std::uint64_t DrawQueue::key(const Sort& sort) {
+  constexpr unsigned state_bits =
+      program_bits + vertex_array_bits + material_bits;
+  static_assert(layer_bits + translucent_bits + state_bits + depth_bits == 64);
+  constexpr unsigned depth_steps = (1u << depth_bits) - 1;
+  const float clamped = sort.depth > 0 ? std::min(sort.depth, 1.f) : 0.f;
+  const auto quantized = static_cast<unsigned>(clamped * depth_steps);
+  std::uint64_t state = field(sort.program, program_bits);
+  state = state << vertex_array_bits |
+          field(sort.vertex_array, vertex_array_bits);
+  state = state << material_bits | field(sort.material, material_bits);
+
+  std::uint64_t key = field(sort.layer, layer_bits);
+  key = key << translucent_bits | sort.translucent;
+  if (sort.translucent) {
+    // Depth before state, farthest first.
+    key = key << depth_bits | field(depth_steps - quantized, depth_bits);
+    return key << state_bits | state;
+  }
+  key = key << state_bits | state;
+  return key << depth_bits | field(quantized, depth_bits);
+}
+
+void DrawQueue::submit(const std::uint64_t key, const Draw& draw,
+                       std::initializer_list<Uniform> submitted) {
+  keys.push_back(key);
+  packets.push_back({draw, static_cast<std::uint32_t>(uniforms.size()),
+                     static_cast<std::uint32_t>(submitted.size())});
+  for (const Uniform& uniform : submitted) {
+    uniforms.push_back({uniform.location, uniform.type,
+                        static_cast<std::uint32_t>(values.size())});
+    values.insert(values.end(), uniform.data,
+                  uniform.data + floatCount(uniform.type));
+  }
+}
+
+std::size_t DrawQueue::execute(StateCache& state) {
+  for (const std::uint32_t index : sorter.sort(keys)) {
+    const Packet& packet = packets[index];
+    const Draw& draw = packet.draw;
+    state.useProgram(draw.program);
+    state.bindVertexArray(draw.vertex_array);
+    for (std::uint32_t i = 0; i < packet.uniform_count; i++) {
+      const StoredUniform& uniform = uniforms[packet.first_uniform + i];
+      const float* data = values.data() + uniform.offset;
+      switch (uniform.type) {
+        case UniformType::vector3:
+          state.uniformVector3(uniform.location, data[0], data[1], data[2]);
+          break;
+        case UniformType::matrix3x3:
+          state.uniformMatrix3x3(uniform.location, data);
+          break;
+        case UniformType::matrix4x4:
+          state.uniformMatrix4x4(uniform.location, data);
+          break;
+      }
+    }
+
+    const bool instanced = draw.instances != 1;
+    if (draw.index_type != 0 && instanced) {
+      glDrawElementsInstanced(draw.mode, draw.count, draw.index_type, nullptr,
+                              draw.instances);
+    } else if (draw.index_type != 0) {
+      glDrawElements(draw.mode, draw.count, draw.index_type, nullptr);
+    } else if (instanced) {
+      glDrawArraysInstanced(draw.mode, 0, draw.count, draw.instances);
+    } else {
+      glDrawArrays(draw.mode, 0, draw.count);
+    }
+  }
+
+  const std::size_t drawn = packets.size();
+  keys.clear();
+  packets.clear();
+  uniforms.clear();
+  values.clear();
+  return drawn;
+}
+
+std::size_t DrawQueue::size() const { return packets.size(); }
+}  // namespace render
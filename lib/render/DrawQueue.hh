@@ -0,0 +1,99 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <vector>
+
+#include <utils/sort.hh>
+
+#include "StateCache.hh"
+
+namespace render {
+// Draw calls collected over a frame and issued in state order. Each one is
+// submitted with a 64-bit key; execute() radix-sorts the keys and issues the
+// draws through a StateCache, so draws sharing a program and vertex array
+// are issued back to back and their bindings are set once.
+class DrawQueue {
+ public:
+  // Key fields, most significant first. Only the low bits of each field
+  // take part: names beyond them still draw correctly, just not grouped.
+  static constexpr unsigned layer_bits = 2;
+  static constexpr unsigned translucent_bits = 1;
+  static constexpr unsigned program_bits = 13;
+  static constexpr unsigned vertex_array_bits = 13;
+  static constexpr unsigned material_bits = 11;
+  static constexpr unsigned depth_bits = 24;
+
+  struct Sort {
+    // Passes drawn in order, e.g. world, then effects, then overlay.
+    unsigned layer = 0;
+    // Blended draws, issued after the layer's opaque ones.
+    bool translucent = false;
+    unsigned program = 0;
+    unsigned vertex_array = 0;
+    // Whatever groups uniform values, e.g. a texture set.
+    unsigned material = 0;
+    // View depth in [0, 1]; values outside it, and NaN, are clamped.
+    float depth = 0;
+  };
+
+  // Sorts by layer, then opaque draws by program, vertex array and
+  // material, front to back among equal state so that early depth tests
+  // reject hidden fragments. Translucent draws follow, back to front so
+  // that they blend correctly, and only then by state.
+  static std::uint64_t key(const Sort& sort);
+
+  enum class UniformType { vector3, matrix3x3, matrix4x4 };
+
+  // Values are copied on submission.
+  struct Uniform {
+    int location;
+    UniformType type;
+    const float* data;
+  };
+
+  struct Draw {
+    unsigned program = 0;
+    unsigned vertex_array = 0;
+    unsigned mode = GL_TRIANGLES;
+    unsigned count = 0;
+    // glDrawElements* when set, glDrawArrays* otherwise.
+    unsigned index_type = 0;
+    // Any other count than 1 makes an instanced call, so 0 draws nothing.
+    unsigned instances = 1;
+  };
+
+  void submit(std::uint64_t key, const Draw& draw,
+              std::initializer_list<Uniform> uniforms = {});
+
+  // Issues every submitted draw in key order, submission order among equal
+  // keys, and empties the queue. Returns the number of draws. Buffers are
+  // kept, so a frame that submits no more than the previous ones does not
+  // allocate.
+  std::size_t execute(StateCache& state);
+
+  std::size_t size() const;
+
+ private:
+  struct Packet {
+    Draw draw;
+    std::uint32_t first_uniform;
+    std::uint32_t uniform_count;
+  };
+
+  struct StoredUniform {
+    int location;
+    UniformType type;
+    std::uint32_t offset;
+  };
+
+  std::vector<std::uint64_t> keys;
+  std::vector<Packet> packets;
+  std::vector<StoredUniform> uniforms;
+  std::vector<float> values;
+  utils::RadixSorter sorter;
+};
+}  // namespace render
@@ -0,0 +1,132 @@
+#include "FrameReader.hh"
+
+#include <glad/glad.h>
+
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace render {
+namespace {
+constexpr GLuint64 wait_timeout_ns = 1'000'000'000;
+constexpr std::size_t bytes_per_pixel = 4;
+}  // namespace
+
+FrameReader::FrameReader(int width, int height, Consumer consumer,
+                         unsigned slots)
+    : width{width},
+      height{height},
+      frame_size{static_cast<std::size_t>(width) * height * bytes_per_pixel},
+      consumer{std::move(consumer)},
+      slots(slots) {
+  if (slots == 0) {
+    throw std::runtime_error{"Frame reader needs at least one slot"};
+  }
+  for (Slot& slot : this->slots) {
+    glGenBuffers(1, &slot.buffer);
+    if (slot.buffer == 0) {
+      throw std::runtime_error{"Error while allocating pixel buffer"};
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+    glBufferData(GL_PIXEL_PACK_BUFFER, frame_size, nullptr, GL_STREAM_READ);
+  }
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+}
+
+FrameReader::~FrameReader() {
+  for (Slot& slot : slots) {
+    if (slot.fence != nullptr) glDeleteSync(slot.fence);
+    if (slot.buffer != 0) glDeleteBuffers(1, &slot.buffer);
+  }
+}
+
+void FrameReader::read(unsigned long number) {
+  if (pending == slots.size()) {
+    stall_count++;
+    complete(true);
+  }
+
+  Slot& slot = slots[next];
+  slot.number = number;
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+  glPixelStorei(GL_PACK_ALIGNMENT, 1);
+  glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+  slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+  next = (next + 1) % slots.size();
+  pending++;
+}
+
+void FrameReader::poll() {
+  while (pending > 0 && complete(false)) {
+  }
+}
+
+void FrameReader::finish() {
+  while (pending > 0) complete(true);
+}
+
+bool FrameReader::complete(bool wait) {
+  Slot& slot = slots[(next + slots.size() - pending) % slots.size()];
+
+  GLenum status = glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+  while (wait && status == GL_TIMEOUT_EXPIRED) {
+    status = glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT,
+                              wait_timeout_ns);
+  }
+  if (status == GL_TIMEOUT_EXPIRED) return false;
+  glDeleteSync(slot.fence);
+  slot.fence = nullptr;
+  pending--;
+  if (status == GL_WAIT_FAILED) {
+    throw std::runtime_error{"Error while waiting for frame readback"};
+  }
+
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+  const void* pixels =
+      glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, frame_size, GL_MAP_READ_BIT);
+  if (pixels == nullptr) {
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    throw std::runtime_error{"Error while mapping pixel buffer"};
+  }
+  try {
+    consumer(Frame{slot.number, width, height,
+                   {static_cast<const std::byte*>(pixels), frame_size}});
+  } catch (...) {
+    glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    throw;
+  }
+  glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+  return true;
+}
+
+unsigned long FrameReader::stalls() const { return stall_count; }
+
+void writePpm(const std::filesystem::path& path,
+              const FrameReader::Frame& frame) {
+  std::ofstream out{path, std::ios::binary};
+  if (!out) {
+    throw std::runtime_error{"Cannot open " + path.string() + " for writing"};
+  }
+  out << "P6\n" << frame.width << ' ' << frame.height << "\n255\n";
+
+  const std::size_t stride = frame.width * bytes_per_pixel;
+  std::vector<char> row(frame.width * 3);
+  for (int y = frame.height - 1; y >= 0; y--) {
+    const std::byte* source = frame.pixels.data() + y * stride;
+    for (int x = 0; x < frame.width; x++) {
+      row[x * 3] = static_cast<char>(source[x * bytes_per_pixel]);
+      row[x * 3 + 1] = static_cast<char>(source[x * bytes_per_pixel + 1]);
+      row[x * 3 + 2] = static_cast<char>(source[x * bytes_per_pixel + 2]);
+    }
+    out.write(row.data(), row.size());
+  }
+  if (!out) throw std::runtime_error{"Error while writing " + path.string()};
+}
+}  // namespace render
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <cstddef>
+#include <filesystem>
+#include <functional>
+#include <span>
+#include <vector>
+
+namespace render {
+// Reads rendered frames back through a ring of pixel buffer objects.
+// glReadPixels into a bound pack buffer returns immediately; the pixels are
+// mapped a few frames later, once the fence placed after the copy signals,
+// so the render loop does not wait for the GPU to finish the frame.
+//
+// Usage per frame: draw, read(), then poll(); finish() at the end hands over
+// the frames still in flight.
+class FrameReader {
+ public:
+  // RGBA8 pixels, rows bottom to top as GL stores them.
+  struct Frame {
+    unsigned long number;
+    int width;
+    int height;
+    std::span<const std::byte> pixels;
+  };
+
+  using Consumer = std::function<void(const Frame&)>;
+
+  static constexpr unsigned default_slots = 3;
+
+  FrameReader() = delete;
+  FrameReader(int width, int height, Consumer consumer,
+              unsigned slots = default_slots);
+
+  FrameReader(const FrameReader&) = delete;
+  FrameReader& operator=(const FrameReader&) = delete;
+
+  ~FrameReader();
+
+  // Starts copying the bound read framebuffer. With every slot in flight it
+  // first waits for the oldest one.
+  void read(unsigned long number);
+  // Hands finished frames to the consumer without waiting.
+  void poll();
+  // Waits for every frame in flight and hands it to the consumer.
+  void finish();
+
+  // Number of read() calls that had to wait for the GPU.
+  unsigned long stalls() const;
+
+ private:
+  struct Slot {
+    unsigned buffer = 0;
+    GLsync fence = nullptr;
+    unsigned long number = 0;
+  };
+
+  int width;
+  int height;
+  std::size_t frame_size;
+  Consumer consumer;
+  std::vector<Slot> slots;
+  unsigned next = 0;
+  unsigned pending = 0;
+  unsigned long stall_count = 0;
+
+  // Hands over the oldest frame in flight; false if `wait` is not set and
+  // the copy has not finished yet.
+  bool complete(bool wait);
+};
+
+// Writes a frame as a binary PPM, flipped so the top row comes first.
+void writePpm(const std::filesystem::path& path,
+              const FrameReader::Frame& frame);
+}  // namespace render
@@ -0,0 +1,76 @@
+#include "Framebuffer.hh"
+
+#include <glad/glad.h>
+
+#include <stdexcept>
+#include <utility>
+
+namespace render {
+Framebuffer::Framebuffer(int width, int height)
+    : width{width}, height{height} {
+  glGenFramebuffers(1, &framebuffer);
+  glGenRenderbuffers(1, &color);
+  glGenRenderbuffers(1, &depth);
+  if (framebuffer == 0 || color == 0 || depth == 0) {
+    release();
+    throw std::runtime_error{"Error while allocating framebuffer"};
+  }
+
+  glBindRenderbuffer(GL_RENDERBUFFER, color);
+  glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+  glBindRenderbuffer(GL_RENDERBUFFER, depth);
+  glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+  glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+  glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+  glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
+                            GL_RENDERBUFFER, color);
+  glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT,
+                            GL_RENDERBUFFER, depth);
+  const GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+  glBindFramebuffer(GL_FRAMEBUFFER, 0);
+  if (status != GL_FRAMEBUFFER_COMPLETE) {
+    release();
+    throw std::runtime_error{"Framebuffer is incomplete"};
+  }
+}
+
+Framebuffer::Framebuffer(Framebuffer&& other) noexcept
+    : framebuffer{std::exchange(other.framebuffer, 0)},
+      color{std::exchange(other.color, 0)},
+      depth{std::exchange(other.depth, 0)},
+      width{other.width},
+      height{other.height} {}
+
+Framebuffer& Framebuffer::operator=(Framebuffer&& other) noexcept {
+  if (this != &other) {
+    release();
+    framebuffer = std::exchange(other.framebuffer, 0);
+    color = std::exchange(other.color, 0);
+    depth = std::exchange(other.depth, 0);
+    width = other.width;
+    height = other.height;
+  }
+  return *this;
+}
+
+Framebuffer::~Framebuffer() { release(); }
+
+void Framebuffer::release() {
+  if (framebuffer != 0) glDeleteFramebuffers(1, &framebuffer);
+  if (color != 0) glDeleteRenderbuffers(1, &color);
+  if (depth != 0) glDeleteRenderbuffers(1, &depth);
+  framebuffer = color = depth = 0;
+}
+
+void Framebuffer::bind() {
+  glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+  glViewport(0, 0, width, height);
+}
+
+unsigned Framebuffer::id() const { return framebuffer; }
+
+int Framebuffer::getWidth() const { return width; }
+
+int Framebuffer::getHeight() const { return height; }
+}  // namespace render
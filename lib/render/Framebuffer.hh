@@ -0,0 +1,34 @@
+#pragma once
+
+namespace render {
+// Offscreen render target with an RGBA8 color and a depth-stencil
+// renderbuffer, for rendering without a default framebuffer.
+class Framebuffer {
+  unsigned framebuffer = 0;
+  unsigned color = 0;
+  unsigned depth = 0;
+  int width;
+  int height;
+
+  void release();
+
+ public:
+  Framebuffer() = delete;
+  Framebuffer(int width, int height);
+
+  Framebuffer(const Framebuffer&) = delete;
+  Framebuffer& operator=(const Framebuffer&) = delete;
+
+  Framebuffer(Framebuffer&& other) noexcept;
+  Framebuffer& operator=(Framebuffer&& other) noexcept;
+
+  ~Framebuffer();
+
+  // Binds it for drawing and reading and sets the viewport to cover it.
+  void bind();
+
+  unsigned id() const;
+  int getWidth() const;
+  int getHeight() const;
+};
+}  // namespace render
@@ -0,0 +1,88 @@
+#include "MeshStream.hh"
+
+#include <glad/glad.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+
+#include <mesh/File.hh>
+
+namespace render {
+namespace {
+// Copies the next part of `block` after `uploaded` bytes into `buffer`, at
+// most `budget` bytes. Returns the number of bytes copied.
+std::size_t uploadPart(unsigned buffer, std::span<const std::byte> block,
+                       std::size_t& uploaded, std::size_t budget) {
+  const std::size_t size = std::min(block.size() - uploaded, budget);
+  if (size == 0) return 0;
+  glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+  glBufferSubData(GL_COPY_WRITE_BUFFER, uploaded, size,
+                  block.data() + uploaded);
+  uploaded += size;
+  return size;
+}
+}  // namespace
+
+MeshStream::MeshStream(const mesh::File& file, std::size_t chunk_size)
+    : file{file}, chunk_size{std::max<std::size_t>(chunk_size, 1)} {
+  unsigned buffers[2];
+  glGenBuffers(2, buffers);
+  vertex_buffer = buffers[0];
+  element_buffer = buffers[1];
+  if (vertex_buffer == 0 || element_buffer == 0) {
+    throw std::runtime_error{"Error while allocating mesh buffers"};
+  }
+  glBindBuffer(GL_COPY_WRITE_BUFFER, vertex_buffer);
+  glBufferData(GL_COPY_WRITE_BUFFER, file.vertices().size(), nullptr,
+               GL_STATIC_DRAW);
+  glBindBuffer(GL_COPY_WRITE_BUFFER, element_buffer);
+  glBufferData(GL_COPY_WRITE_BUFFER, file.indices().size(), nullptr,
+               GL_STATIC_DRAW);
+}
+
+MeshStream::~MeshStream() {
+  const unsigned buffers[2] = {vertex_buffer, element_buffer};
+  glDeleteBuffers(2, buffers);
+}
+
+void MeshStream::attach(unsigned location) const {
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, element_buffer);
+  glBindBuffer(GL_ARRAY_BUFFER, vertex_buffer);
+  const mesh::FileHeader& header = file.header();
+  if (file.quantized()) {
+    glVertexAttribPointer(location, 4, GL_UNSIGNED_SHORT, GL_TRUE,
+                          header.vertex_stride, nullptr);
+  } else {
+    glVertexAttribPointer(location, 3, GL_FLOAT, GL_FALSE,
+                          header.vertex_stride, nullptr);
+  }
+  glEnableVertexAttribArray(location);
+}
+
+bool MeshStream::upload() {
+  std::size_t budget = chunk_size;
+  budget -=
+      uploadPart(vertex_buffer, file.vertices(), vertices_uploaded, budget);
+  uploadPart(element_buffer, file.indices(), indices_uploaded, budget);
+  return complete();
+}
+
+bool MeshStream::complete() const {
+  return vertices_uploaded == file.vertices().size() &&
+         indices_uploaded == file.indices().size();
+}
+
+unsigned MeshStream::drawableIndices() const {
+  if (vertices_uploaded < file.vertices().size()) return 0;
+  const std::size_t indices = indices_uploaded / file.header().index_size;
+  return static_cast<unsigned>(indices - indices % 3);
+}
+
+unsigned MeshStream::indexType() const {
+  return file.header().index_size == sizeof(std::uint16_t) ? GL_UNSIGNED_SHORT
+                                                            : GL_UNSIGNED_INT;
+}
+}  // namespace render
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstddef>
+
+#include <mesh/File.hh>
+
+namespace render {
+// Vertex and element buffers filled from a mesh::File a chunk at a time,
+// straight from its mapping. Vertices go first, then indices, and
+// drawableIndices() grows with every complete triangle that arrives, so
+// large models show up progressively instead of delaying the first frame.
+// `file` must outlive the stream.
+//
+// Uploads go through GL_COPY_WRITE_BUFFER and leave the vertex array and
+// buffer bindings untouched.
+class MeshStream {
+ public:
+  static constexpr std::size_t default_chunk_size = 4 << 20;
+
+  MeshStream() = delete;
+  explicit MeshStream(const mesh::File& file,
+                      std::size_t chunk_size = default_chunk_size);
+
+  MeshStream(const MeshStream&) = delete;
+  MeshStream& operator=(const MeshStream&) = delete;
+
+  ~MeshStream();
+
+  // Binds the element buffer to the bound vertex array and sources
+  // attribute `location` from the positions, normalized for quantized files.
+  void attach(unsigned location) const;
+
+  // Uploads up to one chunk; returns true once the whole mesh is resident.
+  bool upload();
+  bool complete() const;
+
+  unsigned drawableIndices() const;
+  // GL_UNSIGNED_SHORT or GL_UNSIGNED_INT.
+  unsigned indexType() const;
+
+ private:
+  const mesh::File& file;
+  std::size_t chunk_size;
+  unsigned vertex_buffer = 0;
+  unsigned element_buffer = 0;
+  std::size_t vertices_uploaded = 0;
+  std::size_t indices_uploaded = 0;
+};
+}  // namespace render
@@ -0,0 +1,316 @@
+#include "Profiler.hh"
+
+#include <glad/glad.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace render {
+namespace {
+constexpr float no_sample = std::numeric_limits<float>::quiet_NaN();
+
+std::string_view kindName(Profiler::Kind kind) {
+  switch (kind) {
+    case Profiler::Kind::cpu:
+      return "cpu";
+    case Profiler::Kind::gpu:
+      return "gpu";
+    case Profiler::Kind::count:
+      return "count";
+  }
+  return "unknown";
+}
+
+// Nearest-rank percentile of sorted values.
+double percentile(const std::vector<float>& sorted, double fraction) {
+  const auto rank =
+      static_cast<std::size_t>(std::ceil(fraction * sorted.size()));
+  return sorted[std::max<std::size_t>(rank, 1) - 1];
+}
+}  // namespace
+
+Profiler::Scope::Scope(Profiler& profiler, Zone zone)
+    : profiler{profiler}, zone{zone} {
+  profiler.begin(zone);
+}
+
+Profiler::Scope::~Scope() { profiler.end(zone); }
+
+Profiler::Profiler(std::size_t window, bool keep_history)
+    : window_size{std::max<std::size_t>(window, 1)},
+      keep_history{keep_history},
+      frame_started{clock::now()},
+      track_heap{heap::installed()},
+      frame_heap_started{heap::thread()} {
+  zone("frame");
+}
+
+Profiler::~Profiler() {
+  for (ZoneData& zone : zones) {
+    if (zone.kind == Kind::gpu) glDeleteQueries(2, zone.queries.data());
+  }
+}
+
+Profiler::Zone Profiler::zone(std::string_view name, Kind kind) {
+  ZoneData& zone = zones.emplace_back();
+  zone.name = name;
+  zone.kind = kind;
+  zone.current = no_sample;
+  zone.window.resize(window_size);
+  if (kind == Kind::gpu) {
+    glGenQueries(2, zone.queries.data());
+    if (zone.queries[0] == 0 || zone.queries[1] == 0) {
+      throw std::runtime_error{"Error while allocating timer queries"};
+    }
+  }
+  return zones.size() - 1;
+}
+
+Profiler::Scope Profiler::scope(Zone zone) { return Scope{*this, zone}; }
+
+void Profiler::begin(Zone index) {
+  ZoneData& zone = zones[index];
+  assert(zone.kind != Kind::count && "Count zones are not timed");
+  if (zone.kind == Kind::gpu) {
+    const unsigned slot = frame_index & 1;
+    assert(!zone.issued[slot] && "GPU zone entered twice in one frame");
+    glBeginQuery(GL_TIME_ELAPSED, zone.queries[slot]);
+    zone.issued[slot] = true;
+  } else {
+    if (track_heap) zone.heap_entered = heap::thread();
+    zone.started = clock::now();
+  }
+}
+
+void Profiler::end(Zone index) {
+  ZoneData& zone = zones[index];
+  if (zone.kind == Kind::gpu) {
+    glEndQuery(GL_TIME_ELAPSED);
+    return;
+  }
+  const std::chrono::duration<double, std::milli> elapsed =
+      clock::now() - zone.started;
+  if (track_heap) zone.heap_current += heap::thread() - zone.heap_entered;
+  // A zone entered several times in a frame reports the total.
+  zone.current = std::isnan(zone.current) ? elapsed.count()
+                                          : zone.current + elapsed.count();
+}
+
+void Profiler::count(Zone index, double amount) {
+  ZoneData& zone = zones[index];
+  assert(zone.kind == Kind::count && "Not a count zone");
+  zone.current = std::isnan(zone.current) ? amount : zone.current + amount;
+}
+
+void Profiler::record(ZoneData& zone, unsigned long row,
+                      double milliseconds) {
+  zone.window[zone.next] = milliseconds;
+  zone.next = (zone.next + 1) % window_size;
+  zone.filled = std::min(zone.filled + 1, window_size);
+  if (keep_history) {
+    if (zone.history.size() <= row) zone.history.resize(row + 1, no_sample);
+    zone.history[row] = milliseconds;
+  }
+}
+
+void Profiler::recordHeap(ZoneData& zone) {
+  const std::uint64_t allocations = zone.heap_current.allocations;
+  const std::uint64_t bytes = zone.heap_current.allocated_bytes;
+  zone.heap_frames++;
+  zone.heap_allocations += allocations;
+  zone.heap_max_allocations = std::max(zone.heap_max_allocations, allocations);
+  zone.heap_bytes += bytes;
+  zone.heap_max_bytes = std::max(zone.heap_max_bytes, bytes);
+}
+
+void Profiler::endFrame() {
+  const clock::time_point now = clock::now();
+  zones[frame].current =
+      std::chrono::duration<double, std::milli>{now - frame_started}.count();
+  frame_started = now;
+  if (track_heap) {
+    const heap::Counters counters = heap::thread();
+    zones[frame].heap_current = counters - frame_heap_started;
+    frame_heap_started = counters;
+    if (frame_index == 0) first_frame_rss = heap::peakRss();
+  }
+
+  // Queries of the previous frame; they are reused by the next one.
+  const unsigned slot = (frame_index + 1) & 1;
+  for (ZoneData& zone : zones) {
+    if (zone.kind != Kind::gpu) {
+      if (track_heap && zone.kind == Kind::cpu && !std::isnan(zone.current)) {
+        // The first frame fills caches and buffers; it is left out.
+        if (frame_index > 0) recordHeap(zone);
+        zone.heap_current = {};
+      }
+      if (!std::isnan(zone.current)) record(zone, frame_index, zone.current);
+      zone.current = no_sample;
+      continue;
+    }
+    if (!zone.issued[slot]) continue;
+    zone.issued[slot] = false;
+    int available = 0;
+    glGetQueryObjectiv(zone.queries[slot], GL_QUERY_RESULT_AVAILABLE,
+                       &available);
+    if (!available) {
+      missed_count++;
+      continue;
+    }
+    GLuint64 nanoseconds = 0;
+    glGetQueryObjectui64v(zone.queries[slot], GL_QUERY_RESULT, &nanoseconds);
+    record(zone, frame_index - 1, nanoseconds / 1e6);
+  }
+  frame_index++;
+}
+
+Profiler::Stats Profiler::stats(Zone index) const {
+  const ZoneData& zone = zones[index];
+  Stats result;
+  result.samples = zone.filled;
+  if (zone.filled == 0) return result;
+
+  std::vector<float> sorted(zone.window.begin(),
+                            zone.window.begin() + zone.filled);
+  std::ranges::sort(sorted);
+  double sum = 0;
+  for (const float sample : sorted) sum += sample;
+  result.min = sorted.front();
+  result.mean = sum / sorted.size();
+  result.p50 = percentile(sorted, 0.5);
+  result.p99 = percentile(sorted, 0.99);
+  return result;
+}
+
+std::string Profiler::summary() const {
+  std::string result;
+  for (Zone index = 0; index < zones.size(); index++) {
+    if (zones[index].kind == Kind::count) continue;
+    const Stats zone_stats = stats(index);
+    if (zone_stats.samples == 0) continue;
+    if (!result.empty()) result += ", ";
+    std::format_to(std::back_inserter(result),
+                   "{}{} {:.2f}/{:.2f}/{:.2f}/{:.2f}",
+                   zones[index].kind == Kind::gpu ? "gpu " : "",
+                   zones[index].name, zone_stats.min, zone_stats.mean,
+                   zone_stats.p50, zone_stats.p99);
+  }
+  return result;
+}
+
+std::string Profiler::counts() const {
+  std::string result;
+  for (Zone index = 0; index < zones.size(); index++) {
+    if (zones[index].kind != Kind::count) continue;
+    const Stats zone_stats = stats(index);
+    if (zone_stats.samples == 0) continue;
+    if (!result.empty()) result += ", ";
+    std::format_to(std::back_inserter(result), "{} {:.0f}", zones[index].name,
+                   zone_stats.mean);
+  }
+  return result;
+}
+
+Profiler::HeapStats Profiler::heapStats(Zone index) const {
+  const ZoneData& zone = zones[index];
+  HeapStats result;
+  result.frames = zone.heap_frames;
+  if (zone.heap_frames == 0) return result;
+  result.mean_allocations =
+      static_cast<double>(zone.heap_allocations) / zone.heap_frames;
+  result.max_allocations = zone.heap_max_allocations;
+  result.mean_bytes = static_cast<double>(zone.heap_bytes) / zone.heap_frames;
+  result.max_bytes = zone.heap_max_bytes;
+  return result;
+}
+
+std::string Profiler::heapSummary() const {
+  if (!track_heap) return {};
+  std::string result;
+  for (Zone index = 0; index < zones.size(); index++) {
+    const HeapStats zone_stats = heapStats(index);
+    if (zone_stats.frames == 0) continue;
+    if (!result.empty()) result += ", ";
+    std::format_to(std::back_inserter(result), "{} {:.1f}/{} {:.0f}/{}",
+                   zones[index].name, zone_stats.mean_allocations,
+                   zone_stats.max_allocations, zone_stats.mean_bytes,
+                   zone_stats.max_bytes);
+  }
+  const std::size_t rss = heap::peakRss();
+  std::format_to(std::back_inserter(result),
+                 "; peak RSS {:.1f} MiB, {:+.1f} MiB after the first frame",
+                 rss / 1048576.0,
+                 (static_cast<double>(rss) - first_frame_rss) / 1048576.0);
+  return result;
+}
+
+unsigned long Profiler::missed() const { return missed_count; }
+
+void Profiler::exportSamples(const std::filesystem::path& path) const {
+  std::ofstream out{path};
+  if (!out) {
+    throw std::runtime_error{"Cannot open " + path.string() + " for writing"};
+  }
+  if (path.extension() == ".json") {
+    exportJson(out);
+  } else {
+    exportCsv(out);
+  }
+  if (!out) throw std::runtime_error{"Error while writing " + path.string()};
+}
+
+void Profiler::exportCsv(std::ostream& out) const {
+  out << "frame";
+  for (const ZoneData& zone : zones) {
+    out << ',' << zone.name << '_' << kindName(zone.kind);
+  }
+  out << '\n';
+
+  for (unsigned long row = 0; row < frame_index; row++) {
+    out << row;
+    for (const ZoneData& zone : zones) {
+      out << ',';
+      if (row < zone.history.size() && !std::isnan(zone.history[row])) {
+        out << std::format("{:.4f}", zone.history[row]);
+      }
+    }
+    out << '\n';
+  }
+}
+
+void Profiler::exportJson(std::ostream& out) const {
+  out << "{\"frames\":" << frame_index << ",\"zones\":[";
+  for (Zone index = 0; index < zones.size(); index++) {
+    const ZoneData& zone = zones[index];
+    const Stats zone_stats = stats(index);
+    out << (index == 0 ? "" : ",") << '\n';
+    out << std::format(
+        "{{\"name\":\"{}\",\"kind\":\"{}\",\"stats\":{{\"min\":{:.4f},"
+        "\"mean\":{:.4f},\"p50\":{:.4f},\"p99\":{:.4f}}},\"samples\":[",
+        zone.name, kindName(zone.kind), zone_stats.min, zone_stats.mean,
+        zone_stats.p50, zone_stats.p99);
+    for (unsigned long row = 0; row < frame_index; row++) {
+      if (row > 0) out << ',';
+      if (row < zone.history.size() && !std::isnan(zone.history[row])) {
+        out << std::format("{:.4f}", zone.history[row]);
+      } else {
+        out << "null";
+      }
+    }
+    out << "]}";
+  }
+  out << "\n]}\n";
+}
+}  // namespace render
@@ -0,0 +1,142 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <iosfwd>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <heap/counters.hh>
+
+namespace render {
+// Per-frame timings of named CPU and GPU zones with rolling statistics.
+//
+// Usage: register zones once with zone(), wrap the work of every frame in
+// scope() and call endFrame() after swapping buffers. The frame time itself
+// is always recorded as zone `frame`. Count zones record per-frame totals
+// passed to count() instead of times, e.g. how many objects were drawn.
+//
+// GPU zones are GL_TIME_ELAPSED queries. Each zone owns two of them and
+// alternates between frames, so a result is read one frame after it was
+// issued; results that are still pending then are skipped, never waited for.
+// GL allows one such query at a time, so GPU zones must not nest.
+//
+// When the program links heap-hooks, CPU zones and the frame also count the
+// heap operations of the thread that runs them; see heapSummary().
+class Profiler {
+ public:
+  enum class Kind { cpu, gpu, count };
+  using Zone = unsigned;
+
+  // Milliseconds over the rolling window, or totals for count zones.
+  struct Stats {
+    double min = 0;
+    double mean = 0;
+    double p50 = 0;
+    double p99 = 0;
+    std::size_t samples = 0;
+  };
+
+  // Heap operations per frame in which the zone was entered, from the
+  // second frame on.
+  struct HeapStats {
+    std::uint64_t frames = 0;
+    double mean_allocations = 0;
+    std::uint64_t max_allocations = 0;
+    double mean_bytes = 0;
+    std::uint64_t max_bytes = 0;
+  };
+
+  class Scope {
+    Profiler& profiler;
+    Zone zone;
+
+   public:
+    Scope(Profiler& profiler, Zone zone);
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+    ~Scope();
+  };
+
+  static constexpr Zone frame = 0;
+  static constexpr std::size_t default_window = 240;
+
+  // With `keep_history` every sample is kept for export().
+  explicit Profiler(std::size_t window = default_window,
+                    bool keep_history = false);
+
+  Profiler(const Profiler&) = delete;
+  Profiler& operator=(const Profiler&) = delete;
+
+  ~Profiler();
+
+  Zone zone(std::string_view name, Kind kind = Kind::cpu);
+  Scope scope(Zone zone);
+  // Adds `amount` to a count zone's total for this frame.
+  void count(Zone zone, double amount);
+  void endFrame();
+
+  Stats stats(Zone zone) const;
+  // "name min/mean/p50/p99" of every timed zone with samples, in
+  // milliseconds.
+  std::string summary() const;
+  // "name mean" of every count zone with samples.
+  std::string counts() const;
+  HeapStats heapStats(Zone zone) const;
+  // "name mean/max allocations, mean/max bytes" of every CPU zone with
+  // samples and the peak RSS; empty unless heap::installed().
+  std::string heapSummary() const;
+  // GPU results that were not ready in time and were dropped.
+  unsigned long missed() const;
+
+  // Writes every kept sample as JSON if `path` ends in .json, CSV otherwise.
+  void exportSamples(const std::filesystem::path& path) const;
+
+ private:
+  using clock = std::chrono::steady_clock;
+
+  struct ZoneData {
+    std::string name;
+    Kind kind;
+    std::array<unsigned, 2> queries{};
+    std::array<bool, 2> issued{};
+    clock::time_point started;
+    // Accumulated over the current frame; NaN until the zone is entered.
+    double current;
+    std::vector<float> window;
+    std::size_t next = 0;
+    std::size_t filled = 0;
+    // Indexed by frame, NaN where the zone has no sample.
+    std::vector<float> history;
+    heap::Counters heap_entered;
+    heap::Counters heap_current;
+    std::uint64_t heap_frames = 0;
+    std::uint64_t heap_allocations = 0;
+    std::uint64_t heap_max_allocations = 0;
+    std::uint64_t heap_bytes = 0;
+    std::uint64_t heap_max_bytes = 0;
+  };
+
+  std::vector<ZoneData> zones;
+  std::size_t window_size;
+  bool keep_history;
+  unsigned long frame_index = 0;
+  unsigned long missed_count = 0;
+  clock::time_point frame_started;
+  bool track_heap;
+  heap::Counters frame_heap_started;
+  // Peak RSS when the first frame ended, to tell start-up from growth.
+  std::size_t first_frame_rss = 0;
+
+  void begin(Zone zone);
+  void end(Zone zone);
+  void record(ZoneData& zone, unsigned long row, double milliseconds);
+  void recordHeap(ZoneData& zone);
+  void exportCsv(std::ostream& out) const;
+  void exportJson(std::ostream& out) const;
+};
+}  // namespace render
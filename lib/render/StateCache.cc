@@ -0,0 +1,117 @@
+#include "StateCache.hh"
+
+#include <glad/glad.h>
+
+#include <algorithm>
+#include <cstdint>
+
+namespace render {
+void StateCache::useProgram(const unsigned program) {
+  const bool issued = program != this->program;
+  if (issued) {
+    glUseProgram(program);
+    this->program = program;
+  }
+  count(issued);
+}
+
+void StateCache::bindVertexArray(const unsigned vertex_array) {
+  const bool issued = vertex_array != this->vertex_array;
+  if (issued) {
+    glBindVertexArray(vertex_array);
+    this->vertex_array = vertex_array;
+  }
+  count(issued);
+}
+
+void StateCache::bindBuffer(const unsigned target, const unsigned buffer) {
+  Binding* slot = nullptr;
+  if (target != GL_ELEMENT_ARRAY_BUFFER) {
+    for (Binding& binding : buffers) {
+      if (binding.target == target || binding.target == 0) {
+        slot = &binding;
+        break;
+      }
+    }
+  }
+  const bool issued = slot == nullptr || slot->buffer != buffer;
+  if (issued) {
+    glBindBuffer(target, buffer);
+    if (slot != nullptr) *slot = Binding{target, buffer};
+  }
+  count(issued);
+}
+
+void StateCache::uniformMatrix3x3(const int location, const float* data) {
+  if (location == -1) return;
+  const bool issued = changed(location, data, 9);
+  if (issued) glUniformMatrix3fv(location, 1, GL_TRUE, data);
+  count(issued);
+}
+
+void StateCache::uniformMatrix4x4(const int location, const float* data) {
+  if (location == -1) return;
+  const bool issued = changed(location, data, 16);
+  if (issued) glUniformMatrix4fv(location, 1, GL_TRUE, data);
+  count(issued);
+}
+
+void StateCache::uniformVector3(const int location, const float x,
+                                const float y, const float z) {
+  if (location == -1) return;
+  const float values[] = {x, y, z};
+  const bool issued = changed(location, values, 3);
+  if (issued) glUniform3f(location, x, y, z);
+  count(issued);
+}
+
+void StateCache::invalidate() {
+  program = unknown;
+  vertex_array = unknown;
+  buffers = {};
+  uniforms.clear();
+}
+
+void StateCache::invalidate(const unsigned target) {
+  for (Binding& binding : buffers) {
+    if (binding.target == target) binding.buffer = unknown;
+  }
+}
+
+const StateCache::Counts& StateCache::counts() const { return current; }
+
+StateCache::Counts StateCache::takeCounts() {
+  const Counts taken = current;
+  current = {};
+  return taken;
+}
+
+bool StateCache::changed(const int location, const float* values,
+                         const unsigned size) {
+  // Without a known program there is nothing to attribute the value to.
+  if (program == unknown) return true;
+  const auto found = std::find_if(
+      uniforms.begin(), uniforms.end(), [&](const Uniform& uniform) {
+        return uniform.program == program && uniform.location == location;
+      });
+  if (found != uniforms.end() && found->size == size &&
+      std::equal(values, values + size, found->values.begin())) {
+    return false;
+  }
+  Uniform& uniform =
+      found != uniforms.end() ? *found : uniforms.emplace_back();
+  uniform.program = program;
+  uniform.location = location;
+  uniform.size = size;
+  std::copy(values, values + size, uniform.values.begin());
+  return true;
+}
+
+void StateCache::count(const bool issued) {
+  if (issued) {
+    current.issued++;
+  } else {
+    current.skipped++;
+  }
+}
+}  // namespace render
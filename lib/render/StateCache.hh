@@ -0,0 +1,72 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace render {
+// Shadow copy of the GL bindings and uniform values set through it. Each
+// setter only reaches GL when the value differs from the last one it
+// passed on, and counts issued and skipped calls so redundant state changes
+// show up in the profile.
+//
+// GL calls made around the cache leave it stale: call invalidate() after
+// them, e.g. once a hot reload has swapped programs, since GL may hand a new
+// program a deleted one's name.
+class StateCache {
+ public:
+  struct Counts {
+    unsigned long issued = 0;
+    unsigned long skipped = 0;
+  };
+
+  void useProgram(unsigned program);
+  void bindVertexArray(unsigned vertex_array);
+  // The element array binding belongs to the vertex array and is left
+  // alone; other targets are tracked while they fit a few slots.
+  void bindBuffer(unsigned target, unsigned buffer);
+
+  // Uniforms of the program in use, with matrices in row-major order like
+  // ShaderProgram's setters. Values are remembered per program.
+  void uniformMatrix3x3(int location, const float* data);
+  void uniformMatrix4x4(int location, const float* data);
+  void uniformVector3(int location, float x, float y, float z);
+
+  // Forgets everything, so the next call of each setter reaches GL.
+  void invalidate();
+  // Forgets one buffer binding, e.g. after a StreamBuffer bound its own.
+  void invalidate(unsigned target);
+
+  // Calls since the last takeCounts(), which starts a new count.
+  const Counts& counts() const;
+  Counts takeCounts();
+
+ private:
+  static constexpr unsigned unknown = ~0u;
+  static constexpr unsigned buffer_slots = 4;
+
+  struct Binding {
+    unsigned target = 0;
+    unsigned buffer = unknown;
+  };
+
+  // Last value sent to one uniform of one program.
+  struct Uniform {
+    unsigned program;
+    int location;
+    unsigned size;
+    std::array<float, 16> values;
+  };
+
+  unsigned program = unknown;
+  unsigned vertex_array = unknown;
+  std::array<Binding, buffer_slots> buffers{};
+  std::vector<Uniform> uniforms;
+  Counts current;
+
+  // Whether `values` differ from what the uniform last received; records
+  // them if so.
+  bool changed(int location, const float* values, unsigned size);
+  void count(bool issued);
+};
+}  // namespace render
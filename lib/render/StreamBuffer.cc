@@ -0,0 +1,210 @@
+#include "StreamBuffer.hh"
+
+#include <glad/glad.h>
+
+#include <cstddef>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace render {
+namespace {
+constexpr std::size_t region_alignment = 256;
+constexpr GLuint64 wait_timeout_ns = 1'000'000'000;
+
+std::size_t alignUp(std::size_t size) {
+  return (size + region_alignment - 1) / region_alignment * region_alignment;
+}
+}  // namespace
+
+bool StreamBuffer::persistentSupported() {
+#ifdef GL_VERSION_4_4
+  return GLAD_GL_VERSION_4_4;
+#else
+  return false;
+#endif
+}
+
+StreamBuffer::Strategy StreamBuffer::parseStrategy(std::string_view name) {
+  if (name == "auto") return Strategy::automatic;
+  if (name == "persistent") return Strategy::persistent;
+  if (name == "unsynchronized") return Strategy::unsynchronized;
+  if (name == "orphan") return Strategy::orphan;
+  throw std::runtime_error{"Unknown stream buffer strategy " +
+                           std::string{name}};
+}
+
+std::string_view StreamBuffer::strategyName(Strategy strategy) {
+  switch (strategy) {
+    case Strategy::automatic:
+      return "auto";
+    case Strategy::persistent:
+      return "persistent";
+    case Strategy::unsynchronized:
+      return "unsynchronized";
+    case Strategy::orphan:
+      return "orphan";
+  }
+  return "unknown";
+}
+
+StreamBuffer::StreamBuffer(unsigned target, std::size_t region_size,
+                           Strategy strategy, unsigned regions)
+    : target{target},
+      region_size{alignUp(region_size)},
+      regions{regions},
+      strategy{strategy} {
+  if (strategy == Strategy::automatic) {
+    this->strategy =
+        persistentSupported() ? Strategy::persistent : Strategy::orphan;
+  }
+  if (this->strategy == Strategy::persistent && !persistentSupported()) {
+    throw std::runtime_error{"Persistent mapping requires OpenGL 4.4"};
+  }
+  if (this->strategy == Strategy::orphan) this->regions = 1;
+  if (this->regions == 0) {
+    throw std::runtime_error{"Stream buffer needs at least one region"};
+  }
+  fences.resize(this->regions, nullptr);
+
+  glGenBuffers(1, &buffer);
+  if (buffer == 0) {
+    throw std::runtime_error{"Error while allocating stream buffer"};
+  }
+  glBindBuffer(target, buffer);
+  const std::size_t total_size = this->region_size * this->regions;
+
+  if (this->strategy == Strategy::persistent) {
+#ifdef GL_VERSION_4_4
+    constexpr GLbitfield flags =
+        GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    glBufferStorage(target, total_size, nullptr, flags);
+    persistent_pointer =
+        static_cast<std::byte*>(glMapBufferRange(target, 0, total_size, flags));
+#endif
+    if (persistent_pointer == nullptr) {
+      release();
+      throw std::runtime_error{"Error while mapping stream buffer"};
+    }
+  } else {
+    glBufferData(target, total_size, nullptr, GL_STREAM_DRAW);
+  }
+}
+
+StreamBuffer::StreamBuffer(StreamBuffer&& other) noexcept
+    : buffer{std::exchange(other.buffer, 0)},
+      target{other.target},
+      region_size{other.region_size},
+      regions{other.regions},
+      current{other.current},
+      strategy{other.strategy},
+      persistent_pointer{std::exchange(other.persistent_pointer, nullptr)},
+      fences{std::move(other.fences)},
+      stall_count{other.stall_count} {}
+
+StreamBuffer& StreamBuffer::operator=(StreamBuffer&& other) noexcept {
+  if (this != &other) {
+    release();
+    buffer = std::exchange(other.buffer, 0);
+    target = other.target;
+    region_size = other.region_size;
+    regions = other.regions;
+    current = other.current;
+    strategy = other.strategy;
+    persistent_pointer = std::exchange(other.persistent_pointer, nullptr);
+    fences = std::move(other.fences);
+    stall_count = other.stall_count;
+  }
+  return *this;
+}
+
+StreamBuffer::~StreamBuffer() { release(); }
+
+void StreamBuffer::release() {
+  for (GLsync& fence : fences) {
+    if (fence != nullptr) glDeleteSync(fence);
+    fence = nullptr;
+  }
+  if (buffer != 0) {
+    if (persistent_pointer != nullptr) {
+      glBindBuffer(target, buffer);
+      glUnmapBuffer(target);
+      persistent_pointer = nullptr;
+    }
+    glDeleteBuffers(1, &buffer);
+    buffer = 0;
+  }
+}
+
+void StreamBuffer::waitForRegion() {
+  GLsync& fence = fences[current];
+  if (fence == nullptr) return;
+
+  GLenum status = glClientWaitSync(fence, 0, 0);
+  if (status == GL_TIMEOUT_EXPIRED) {
+    stall_count++;
+    do {
+      status =
+          glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, wait_timeout_ns);
+    } while (status == GL_TIMEOUT_EXPIRED);
+  }
+  glDeleteSync(fence);
+  fence = nullptr;
+
+  if (status == GL_WAIT_FAILED) {
+    throw std::runtime_error{"Error while waiting for stream buffer fence"};
+  }
+}
+
+std::span<std::byte> StreamBuffer::map() {
+  glBindBuffer(target, buffer);
+  const std::size_t offset = current * region_size;
+
+  switch (strategy) {
+    case Strategy::persistent:
+      waitForRegion();
+      return {persistent_pointer + offset, region_size};
+    case Strategy::unsynchronized: {
+      waitForRegion();
+      void* pointer = glMapBufferRange(
+          target, offset, region_size,
+          GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT |
+              GL_MAP_INVALIDATE_RANGE_BIT);
+      if (pointer == nullptr) break;
+      return {static_cast<std::byte*>(pointer), region_size};
+    }
+    case Strategy::orphan:
+    case Strategy::automatic: {
+      glBufferData(target, region_size, nullptr, GL_STREAM_DRAW);
+      void* pointer =
+          glMapBufferRange(target, 0, region_size,
+                           GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+      if (pointer == nullptr) break;
+      return {static_cast<std::byte*>(pointer), region_size};
+    }
+  }
+  throw std::runtime_error{"Error while mapping stream buffer"};
+}
+
+std::size_t StreamBuffer::unmap() {
+  if (strategy != Strategy::persistent) {
+    glBindBuffer(target, buffer);
+    glUnmapBuffer(target);
+  }
+  return current * region_size;
+}
+
+void StreamBuffer::fence() {
+  if (strategy == Strategy::orphan) return;
+  fences[current] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+  current = (current + 1) % regions;
+}
+
+unsigned StreamBuffer::id() const { return buffer; }
+
+StreamBuffer::Strategy StreamBuffer::getStrategy() const { return strategy; }
+
+unsigned long StreamBuffer::stalls() const { return stall_count; }
+}  // namespace render
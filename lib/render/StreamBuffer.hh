@@ -0,0 +1,72 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <cstddef>
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace render {
+// Buffer for data rewritten every frame. It is split into several regions so
+// the CPU fills one while the GPU may still read the previous ones; fences
+// tell when a region can be reused.
+//
+// Usage per frame: map(), write, unmap() (returns the byte offset to source
+// from), issue the draws, then fence().
+class StreamBuffer {
+ public:
+  enum class Strategy {
+    // persistent when supported, orphan otherwise
+    automatic,
+    // glBufferStorage + one coherent persistent mapping (GL 4.4)
+    persistent,
+    // glMapBufferRange(GL_MAP_UNSYNCHRONIZED_BIT) per region, fenced
+    unsynchronized,
+    // single region reallocated with glBufferData(nullptr) every frame
+    orphan,
+  };
+
+  static constexpr unsigned default_regions = 3;
+
+  static bool persistentSupported();
+  static Strategy parseStrategy(std::string_view name);
+  static std::string_view strategyName(Strategy strategy);
+
+  StreamBuffer() = delete;
+  StreamBuffer(unsigned target, std::size_t region_size,
+               Strategy strategy = Strategy::automatic,
+               unsigned regions = default_regions);
+
+  StreamBuffer(const StreamBuffer&) = delete;
+  StreamBuffer& operator=(const StreamBuffer&) = delete;
+
+  StreamBuffer(StreamBuffer&& other) noexcept;
+  StreamBuffer& operator=(StreamBuffer&& other) noexcept;
+
+  ~StreamBuffer();
+
+  std::span<std::byte> map();
+  std::size_t unmap();
+  void fence();
+
+  unsigned id() const;
+  Strategy getStrategy() const;
+  // Number of map() calls that had to wait for the GPU.
+  unsigned long stalls() const;
+
+ private:
+  unsigned buffer = 0;
+  unsigned target;
+  std::size_t region_size;
+  unsigned regions;
+  unsigned current = 0;
+  Strategy strategy;
+  std::byte* persistent_pointer = nullptr;
+  std::vector<GLsync> fences;
+  unsigned long stall_count = 0;
+
+  void waitForRegion();
+  void release();
+};
+}  // namespace render
@@ -0,0 +1,252 @@
+#include "Bvh.hh"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <numeric>
+#include <span>
+#include <vector>
+
+#include <math/Frustum.hh>
+#include <utils/jobs.hh>
+
+namespace scene {
+namespace {
+constexpr unsigned bin_count = 12;
+// Subtrees handed to each thread, so uneven ones balance out.
+constexpr unsigned subtrees_per_thread = 4;
+
+struct Bin {
+  math::Aabb bounds;
+  std::uint32_t count = 0;
+};
+}  // namespace
+
+void Bvh::build(std::span<const math::Aabb> boxes) {
+  nodes.clear();
+  order.resize(boxes.size());
+  std::iota(order.begin(), order.end(), 0);
+  if (!boxes.empty()) {
+    nodes.push_back({{}, 0, static_cast<std::uint32_t>(boxes.size()), 0});
+    // Children are appended after their parent, so one forward pass over
+    // the growing array splits every node.
+    for (std::uint32_t node = 0; node < nodes.size(); node++) {
+      split(node, boxes);
+    }
+  }
+  updateSpheres(boxes);
+}
+
+// Splits where the surface area heuristic, summed over bins of object
+// centers along the widest axis, is lowest. Objects whose centers cannot be
+// told apart are halved by position in `order`.
+void Bvh::split(std::uint32_t index, std::span<const math::Aabb> boxes) {
+  const std::uint32_t begin = nodes[index].begin;
+  const std::uint32_t end = nodes[index].end;
+  math::Aabb bounds;
+  math::Aabb centers;
+  for (std::uint32_t i = begin; i < end; i++) {
+    const math::Aabb& box = boxes[order[i]];
+    bounds.merge(box);
+    const math::Vec3 center = box.center();
+    centers.merge({center, center});
+  }
+  nodes[index].bounds = bounds;
+  if (end - begin <= max_leaf_size) return;
+
+  unsigned axis = 0;
+  const math::Vec3 spread = centers.extent();
+  for (unsigned i = 1; i < 3; i++) {
+    if (spread[i] > spread[axis]) axis = i;
+  }
+  const float low = centers.min[axis];
+  const float width = centers.max[axis] - low;
+  const auto binOf = [&](Object object) {
+    const float center = boxes[object].center()[axis];
+    const auto bin = static_cast<unsigned>((center - low) / width * bin_count);
+    return std::min(bin, bin_count - 1);
+  };
+
+  std::uint32_t middle = begin + (end - begin) / 2;
+  if (width > 0) {
+    std::array<Bin, bin_count> bins;
+    for (std::uint32_t i = begin; i < end; i++) {
+      Bin& bin = bins[binOf(order[i])];
+      bin.bounds.merge(boxes[order[i]]);
+      bin.count++;
+    }
+    // Cost of putting bins [0, cut) left, for every cut.
+    std::array<float, bin_count> cost{};
+    math::Aabb left;
+    std::uint32_t left_count = 0;
+    for (unsigned cut = 1; cut < bin_count; cut++) {
+      left.merge(bins[cut - 1].bounds);
+      left_count += bins[cut - 1].count;
+      cost[cut] = left.surfaceArea() * left_count;
+    }
+    math::Aabb right;
+    std::uint32_t right_count = 0;
+    for (unsigned cut = bin_count - 1; cut > 0; cut--) {
+      right.merge(bins[cut].bounds);
+      right_count += bins[cut].count;
+      cost[cut] += right.surfaceArea() * right_count;
+    }
+    // Only once both sides are in: cut 1 holds its left side alone before.
+    unsigned best = 1;
+    for (unsigned cut = 2; cut < bin_count; cut++) {
+      if (cost[cut] < cost[best]) best = cut;
+    }
+    const auto first_right =
+        std::partition(order.begin() + begin, order.begin() + end,
+                       [&](Object object) { return binOf(object) < best; });
+    const auto cut = static_cast<std::uint32_t>(first_right - order.begin());
+    if (cut != begin && cut != end) middle = cut;
+  }
+
+  const auto left = static_cast<std::uint32_t>(nodes.size());
+  nodes[index].left = left;
+  nodes.push_back({{}, begin, middle, 0});
+  nodes.push_back({{}, middle, end, 0});
+}
+
+void Bvh::refit(std::span<const math::Aabb> boxes) {
+  for (std::size_t index = nodes.size(); index-- > 0;) {
+    Node& node = nodes[index];
+    node.bounds = {};
+    if (node.leaf()) {
+      for (std::uint32_t i = node.begin; i < node.end; i++) {
+        node.bounds.merge(boxes[order[i]]);
+      }
+    } else {
+      node.bounds.merge(nodes[node.left].bounds);
+      node.bounds.merge(nodes[node.left + 1].bounds);
+    }
+  }
+  updateSpheres(boxes);
+}
+
+void Bvh::updateSpheres(std::span<const math::Aabb> boxes) {
+  x.resize(order.size());
+  y.resize(order.size());
+  z.resize(order.size());
+  radius.resize(order.size());
+  for (std::size_t i = 0; i < order.size(); i++) {
+    const math::Aabb& box = boxes[order[i]];
+    const math::Vec3 center = box.center();
+    const math::Vec3 extent = box.extent();
+    x[i] = center[0];
+    y[i] = center[1];
+    z[i] = center[2];
+    radius[i] = std::sqrt(extent[0] * extent[0] + extent[1] * extent[1] +
+                          extent[2] * extent[2]);
+  }
+}
+
+void Bvh::cull(const math::Frustum& frustum, std::vector<Object>& visible,
+               utils::JobSystem* jobs) {
+  if (nodes.empty()) return;
+  const unsigned threads = jobs ? jobs->threads() : 1;
+  const std::size_t start = visible.size();
+  if (threads <= 1) {
+    visible.resize(start + order.size());
+    const Object* end = cullFrom(frustum, 0, visible.data() + start);
+    visible.resize(end - visible.data());
+    return;
+  }
+
+  // Breadth-first expansion keeps the subtrees in tree order.
+  subtrees.assign(1, 0);
+  while (subtrees.size() < threads * subtrees_per_thread) {
+    next_subtrees.clear();
+    for (const std::uint32_t node : subtrees) {
+      if (nodes[node].leaf()) {
+        next_subtrees.push_back(node);
+      } else {
+        next_subtrees.push_back(nodes[node].left);
+        next_subtrees.push_back(nodes[node].left + 1);
+      }
+    }
+    if (next_subtrees.size() == subtrees.size()) break;
+    subtrees.swap(next_subtrees);
+  }
+
+  // A subtree yields its own objects at most, so each one writes to their
+  // range of `culled` and no buffer depends on what is visible.
+  culled.resize(order.size());
+  culled_ends.resize(subtrees.size());
+  jobs->parallelFor(0, subtrees.size(),
+                    [&](std::size_t begin, std::size_t end) {
+                      for (std::size_t i = begin; i < end; i++) {
+                        const std::uint32_t node = subtrees[i];
+                        culled_ends[i] = cullFrom(
+                            frustum, node, culled.data() + nodes[node].begin);
+                      }
+                    },
+                    1);
+  for (std::size_t i = 0; i < subtrees.size(); i++) {
+    visible.insert(visible.end(), culled.data() + nodes[subtrees[i]].begin,
+                   culled_ends[i]);
+  }
+}
+
+Bvh::Object* Bvh::cullFrom(const math::Frustum& frustum, std::uint32_t index,
+                           Object* visible) const {
+  const Node& node = nodes[index];
+  if (!frustum.intersects(node.bounds)) return visible;
+  if (frustum.contains(node.bounds)) {
+    return std::copy(order.begin() + node.begin, order.begin() + node.end,
+                     visible);
+  }
+  if (node.leaf()) return cullLeaf(frustum, node, visible);
+  visible = cullFrom(frustum, node.left, visible);
+  return cullFrom(frustum, node.left + 1, visible);
+}
+
+Bvh::Object* Bvh::cullLeaf(const math::Frustum& frustum, const Node& node,
+                           Object* visible) const {
+  const std::size_t count = node.end - node.begin;
+  std::array<std::uint32_t, max_leaf_size> found;
+  const std::size_t written = math::cullSpheres(
+      frustum, std::span{x}.subspan(node.begin, count),
+      std::span{y}.subspan(node.begin, count),
+      std::span{z}.subspan(node.begin, count),
+      std::span{radius}.subspan(node.begin, count), node.begin,
+      found.data());
+  for (std::size_t i = 0; i < written; i++) {
+    *visible++ = order[found[i]];
+  }
+  return visible;
+}
+
+float Bvh::cost() const {
+  if (nodes.empty()) return 0;
+  const float root = nodes[0].bounds.surfaceArea();
+  if (root == 0) return 0;
+  float sum = 0;
+  for (const Node& node : nodes) {
+    const float weight = node.leaf() ? node.end - node.begin : 1;
+    sum += node.bounds.surfaceArea() / root * weight;
+  }
+  return sum;
+}
+
+std::size_t Bvh::size() const { return order.size(); }
+
+std::size_t Bvh::nodeCount() const { return nodes.size(); }
+
+unsigned Bvh::depth() const {
+  // Children come after their parent, so one pass sees every parent first.
+  std::vector<unsigned> depths(nodes.size(), 1);
+  unsigned deepest = 0;
+  for (std::size_t index = 0; index < nodes.size(); index++) {
+    const Node& node = nodes[index];
+    if (!node.leaf()) {
+      depths[node.left] = depths[node.left + 1] = depths[index] + 1;
+    }
+    deepest = std::max(deepest, depths[index]);
+  }
+  return deepest;
+}
+}  // namespace scene
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include <math/Frustum.hh>
+#include <utils/jobs.hh>
+
+namespace scene {
+// Bounding volume hierarchy over object boxes, for frustum culling.
+//
+// build() splits the objects top-down with a binned surface area heuristic.
+// Moving objects are handled by refit(), which keeps the tree and only
+// recomputes bounds; the tree then loosens as objects drift from where they
+// were built, and cost() tells when a rebuild pays off again (e.g. once it
+// grows 50% over its value right after build()).
+//
+// Culling skips subtrees outside the frustum, takes subtrees inside it
+// without further tests and checks the objects of the remaining leaves with
+// math::cullSpheres(), eight at a time with AVX2.
+class Bvh {
+ public:
+  using Object = std::uint32_t;
+  static constexpr unsigned max_leaf_size = 8;
+
+  void build(std::span<const math::Aabb> boxes);
+  // `boxes` must hold as many objects as the last build().
+  void refit(std::span<const math::Aabb> boxes);
+
+  // Appends the objects that may be visible to `visible`, in tree order.
+  // Without `jobs` they are written in place, so `visible` needs room for
+  // size() more objects not to allocate. With `jobs` the upper levels are
+  // split into subtrees that are culled in parallel; worth it for tens of
+  // thousands of objects. Not const: that path keeps its buffers in the Bvh
+  // between calls.
+  void cull(const math::Frustum& frustum, std::vector<Object>& visible,
+            utils::JobSystem* jobs = nullptr);
+
+  // Expected number of node and object tests for a random ray or view,
+  // relative to the root: the sum of node areas over the root area, leaves
+  // weighted by their object count.
+  float cost() const;
+
+  std::size_t size() const;
+  std::size_t nodeCount() const;
+  // Nodes on the longest path from the root to a leaf.
+  unsigned depth() const;
+
+ private:
+  // Children of inner nodes are stored next to each other, at `left` and
+  // `left + 1`, always after their parent. Every node covers the objects
+  // order[begin, end).
+  struct Node {
+    math::Aabb bounds;
+    std::uint32_t begin;
+    std::uint32_t end;
+    std::uint32_t left;
+
+    bool leaf() const { return left == 0; }
+  };
+
+  std::vector<Node> nodes;
+  std::vector<Object> order;
+  // Bounding spheres in `order`, one array per component.
+  std::vector<float> x;
+  std::vector<float> y;
+  std::vector<float> z;
+  std::vector<float> radius;
+  // Scratch of the parallel cull(), kept so that steady calls do not
+  // allocate.
+  std::vector<std::uint32_t> subtrees;
+  std::vector<std::uint32_t> next_subtrees;
+  std::vector<Object> culled;
+  std::vector<Object*> culled_ends;
+
+  void split(std::uint32_t node, std::span<const math::Aabb> boxes);
+  void updateSpheres(std::span<const math::Aabb> boxes);
+  // Write the objects that may be visible to `visible`, which has room for
+  // all of the node's, and return the end of what they wrote.
+  Object* cullFrom(const math::Frustum& frustum, std::uint32_t node,
+                   Object* visible) const;
+  Object* cullLeaf(const math::Frustum& frustum, const Node& node,
+                   Object* visible) const;
+};
+}  // namespace scene
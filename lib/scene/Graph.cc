@@ -0,0 +1,132 @@
+#include "Graph.hh"
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+#include <math/Mat.hh>
+#include <math/Transform.hh>
+
+namespace scene {
+void Graph::Transforms::push(const math::Transform& transform) {
+  const std::size_t index = components[0].size();
+  resize(index + 1);
+  math::store(view(0, index + 1), index, transform);
+}
+
+void Graph::Transforms::resize(const std::size_t size) {
+  for (std::vector<float>& component : components) component.resize(size);
+}
+
+math::TransformArrays<float> Graph::Transforms::view(
+    const std::size_t begin, const std::size_t count) {
+  const auto array = [&](unsigned component) {
+    return std::span{components[component]}.subspan(begin, count);
+  };
+  return {array(0), array(1), array(2),
+          {array(3), array(4), array(5), array(6)},
+          array(7), array(8), array(9)};
+}
+
+math::TransformArrays<const float> Graph::Transforms::view(
+    const std::size_t begin, const std::size_t count) const {
+  const auto array = [&](unsigned component) {
+    return std::span{components[component]}.subspan(begin, count);
+  };
+  return {array(0), array(1), array(2),
+          {array(3), array(4), array(5), array(6)},
+          array(7), array(8), array(9)};
+}
+
+Graph::Node Graph::add(const math::Transform& local, Node parent) {
+  if (parent != none && parent >= parents.size()) {
+    throw std::runtime_error{"Parent node does not exist"};
+  }
+  parents.push_back(parent);
+  locals.push(local);
+  world_transforms.push(local);
+  worlds.push_back(math::Mat4::identity());
+  dirty.push_back(true);
+  recomputed.push_back(false);
+  first_dirty = std::min(first_dirty, parents.size() - 1);
+  return parents.size() - 1;
+}
+
+void Graph::setLocal(Node node, const math::Transform& local) {
+  assert(node < parents.size() && "Unknown node");
+  math::store(locals.view(0, parents.size()), node, local);
+  dirty[node] = true;
+  first_dirty = std::min<std::size_t>(first_dirty, node);
+}
+
+math::Transform Graph::local(Node node) const {
+  return math::load(locals.view(0, parents.size()), node);
+}
+
+Graph::Node Graph::parent(Node node) const { return parents[node]; }
+
+math::Transform Graph::worldTransform(Node node) const {
+  return math::load(world_transforms.view(0, parents.size()), node);
+}
+
+const math::Mat4& Graph::world(Node node) const { return worlds[node]; }
+
+bool Graph::changed(Node node) const { return recomputed[node]; }
+
+std::size_t Graph::update() {
+  const std::size_t count = parents.size();
+  std::fill(recomputed.begin(), recomputed.begin() + first_dirty, false);
+
+  const auto stale = [&](std::size_t node) {
+    const Node parent = parents[node];
+    return dirty[node] || (parent != none && recomputed[parent]);
+  };
+  std::size_t updated = 0;
+  std::size_t node = first_dirty;
+  while (node < count) {
+    if (!stale(node)) {
+      recomputed[node] = false;
+      node++;
+      continue;
+    }
+    // A run of stale nodes whose parents are all computed already, such as
+    // the children of one node, is composed in one batch.
+    const std::size_t begin = node;
+    do {
+      recomputed[node] = true;
+      dirty[node] = false;
+      node++;
+    } while (node < count && stale(node) &&
+             (parents[node] == none || parents[node] < begin));
+    compose(begin, node);
+    updated += node - begin;
+  }
+  first_dirty = count;
+  return updated;
+}
+
+void Graph::compose(const std::size_t begin, const std::size_t end) {
+  const std::size_t count = end - begin;
+  if (run_parents.components[0].size() < count) run_parents.resize(count);
+  const math::TransformArrays<float> parent_worlds =
+      run_parents.view(0, count);
+  const math::TransformArrays<const float> all_worlds =
+      world_transforms.view(0, parents.size());
+  for (std::size_t i = 0; i < count; i++) {
+    const Node parent = parents[begin + i];
+    math::store(parent_worlds, i,
+                parent == none ? math::Transform{}
+                               : math::load(all_worlds, parent));
+  }
+  const math::TransformArrays<float> run =
+      world_transforms.view(begin, count);
+  math::multiply(locals.view(begin, count), parent_worlds, run);
+  math::toMat4(run, std::span{worlds}.subspan(begin, count));
+}
+
+std::size_t Graph::size() const { return parents.size(); }
+}  // namespace scene
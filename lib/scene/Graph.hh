@@ -0,0 +1,73 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include <math/Mat.hh>
+#include <math/Transform.hh>
+
+namespace scene {
+// Transform hierarchy kept in flat arrays in topological order: a parent is
+// always stored before its children, so update() computes world transforms
+// in one forward sweep. Only nodes whose local transform changed, and their
+// descendants, are recomputed.
+//
+// Local and world transforms are kept one array per component, and update()
+// composes runs of dirty siblings with the math::TransformArrays batch
+// kernels. World transforms follow math::Transform's product: a parent with
+// a non-uniform scale only scales its children along their own axes.
+class Graph {
+ public:
+  using Node = std::uint32_t;
+  static constexpr Node none = std::numeric_limits<Node>::max();
+
+  // Adds a node under `parent`, which must already exist. Handles are
+  // indices and stay valid for the graph's lifetime.
+  Node add(const math::Transform& local = {}, Node parent = none);
+
+  void setLocal(Node node, const math::Transform& local);
+  math::Transform local(Node node) const;
+  Node parent(Node node) const;
+
+  // World transform and matrix as of the last update().
+  math::Transform worldTransform(Node node) const;
+  const math::Mat4& world(Node node) const;
+  // Whether the last update() recomputed the node's world transform.
+  bool changed(Node node) const;
+
+  // Recomputes the world transforms of dirty subtrees and returns how many
+  // nodes were recomputed.
+  std::size_t update();
+
+  std::size_t size() const;
+
+ private:
+  // One array per component, in math::TransformArrays order.
+  struct Transforms {
+    std::array<std::vector<float>, 10> components;
+
+    void push(const math::Transform& transform);
+    void resize(std::size_t size);
+    math::TransformArrays<float> view(std::size_t begin, std::size_t count);
+    math::TransformArrays<const float> view(std::size_t begin,
+                                            std::size_t count) const;
+  };
+
+  std::vector<Node> parents;
+  Transforms locals;
+  Transforms world_transforms;
+  std::vector<math::Mat4> worlds;
+  std::vector<std::uint8_t> dirty;
+  std::vector<std::uint8_t> recomputed;
+  // Nothing before this index is dirty, so update() starts here.
+  std::size_t first_dirty = 0;
+  // Parent world transforms of the run being composed, kept between updates
+  // so that steady updates do not allocate.
+  Transforms run_parents;
+
+  void compose(std::size_t begin, std::size_t end);
+};
+}  // namespace scene
@@ -0,0 +1,209 @@
+#include "Shapes.hh"
+
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <span>
+
+#include <math/Mat.hh>
+#include <math/simd.hh>
+#include <math/trig.hh>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define SCENE_SHAPES_X86 1
+#include <immintrin.h>
+#endif
+
+namespace scene {
+namespace {
+// Pointers to the store's arrays for one update.
+struct Lanes {
+  float* cos_angle;
+  float* sin_angle;
+  const float* cos_step;
+  const float* sin_step;
+  const float* orbit;
+  const float* size;
+  float* x;
+  float* y;
+  float* scale;
+};
+
+// Rotating by the step, then pulling the result back to unit length with
+// one Newton step (k = 1.5 - 0.5 * length^2) so rounding never accumulates
+// into a growing or shrinking orbit. Vector paths do the same operations in
+// the same order, so all of them produce identical results.
+void updateScalar(const Lanes& lanes, float extent, std::size_t begin,
+                  std::size_t end) {
+  for (std::size_t i = begin; i < end; i++) {
+    const float c = lanes.cos_angle[i] * lanes.cos_step[i] -
+                    lanes.sin_angle[i] * lanes.sin_step[i];
+    const float s = lanes.sin_angle[i] * lanes.cos_step[i] +
+                    lanes.cos_angle[i] * lanes.sin_step[i];
+    const float k = 1.5f - 0.5f * (c * c + s * s);
+    const float cos_angle = c * k;
+    const float sin_angle = s * k;
+    const float scale =
+        lanes.size[i] * (std::fabs(sin_angle) + Shapes::min_pulse);
+    const float radius = lanes.orbit[i] - extent * scale;
+    lanes.cos_angle[i] = cos_angle;
+    lanes.sin_angle[i] = sin_angle;
+    lanes.scale[i] = scale;
+    lanes.x[i] = cos_angle * radius;
+    lanes.y[i] = sin_angle * radius;
+  }
+}
+
+#ifdef SCENE_SHAPES_X86
+// Vector kernels take `lanes` by value: unaligned vector stores may alias
+// anything, so through a reference every pointer would be reloaded after
+// each store.
+void updateSse(const Lanes lanes, float extent, std::size_t count) {
+  const __m128 half = _mm_set1_ps(0.5f);
+  const __m128 three_halves = _mm_set1_ps(1.5f);
+  const __m128 pulse = _mm_set1_ps(Shapes::min_pulse);
+  const __m128 extents = _mm_set1_ps(extent);
+  const __m128 sign = _mm_set1_ps(-0.f);
+
+  std::size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    const __m128 cos_angle = _mm_loadu_ps(lanes.cos_angle + i);
+    const __m128 sin_angle = _mm_loadu_ps(lanes.sin_angle + i);
+    const __m128 cos_step = _mm_loadu_ps(lanes.cos_step + i);
+    const __m128 sin_step = _mm_loadu_ps(lanes.sin_step + i);
+
+    const __m128 c = _mm_sub_ps(_mm_mul_ps(cos_angle, cos_step),
+                                _mm_mul_ps(sin_angle, sin_step));
+    const __m128 s = _mm_add_ps(_mm_mul_ps(sin_angle, cos_step),
+                                _mm_mul_ps(cos_angle, sin_step));
+    const __m128 k = _mm_sub_ps(
+        three_halves,
+        _mm_mul_ps(half, _mm_add_ps(_mm_mul_ps(c, c), _mm_mul_ps(s, s))));
+    const __m128 next_cos = _mm_mul_ps(c, k);
+    const __m128 next_sin = _mm_mul_ps(s, k);
+    const __m128 scale =
+        _mm_mul_ps(_mm_loadu_ps(lanes.size + i),
+                   _mm_add_ps(_mm_andnot_ps(sign, next_sin), pulse));
+    const __m128 radius =
+        _mm_sub_ps(_mm_loadu_ps(lanes.orbit + i), _mm_mul_ps(extents, scale));
+
+    _mm_storeu_ps(lanes.cos_angle + i, next_cos);
+    _mm_storeu_ps(lanes.sin_angle + i, next_sin);
+    _mm_storeu_ps(lanes.scale + i, scale);
+    _mm_storeu_ps(lanes.x + i, _mm_mul_ps(next_cos, radius));
+    _mm_storeu_ps(lanes.y + i, _mm_mul_ps(next_sin, radius));
+  }
+  updateScalar(lanes, extent, i, count);
+}
+
+__attribute__((target("avx2"))) void updateAvx2(const Lanes lanes,
+                                                float extent,
+                                                std::size_t count) {
+  const __m256 half = _mm256_set1_ps(0.5f);
+  const __m256 three_halves = _mm256_set1_ps(1.5f);
+  const __m256 pulse = _mm256_set1_ps(Shapes::min_pulse);
+  const __m256 extents = _mm256_set1_ps(extent);
+  const __m256 sign = _mm256_set1_ps(-0.f);
+
+  std::size_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    const __m256 cos_angle = _mm256_loadu_ps(lanes.cos_angle + i);
+    const __m256 sin_angle = _mm256_loadu_ps(lanes.sin_angle + i);
+    const __m256 cos_step = _mm256_loadu_ps(lanes.cos_step + i);
+    const __m256 sin_step = _mm256_loadu_ps(lanes.sin_step + i);
+
+    const __m256 c = _mm256_sub_ps(_mm256_mul_ps(cos_angle, cos_step),
+                                   _mm256_mul_ps(sin_angle, sin_step));
+    const __m256 s = _mm256_add_ps(_mm256_mul_ps(sin_angle, cos_step),
+                                   _mm256_mul_ps(cos_angle, sin_step));
+    const __m256 k = _mm256_sub_ps(
+        three_halves,
+        _mm256_mul_ps(half,
+                      _mm256_add_ps(_mm256_mul_ps(c, c), _mm256_mul_ps(s, s))));
+    const __m256 next_cos = _mm256_mul_ps(c, k);
+    const __m256 next_sin = _mm256_mul_ps(s, k);
+    const __m256 scale =
+        _mm256_mul_ps(_mm256_loadu_ps(lanes.size + i),
+                      _mm256_add_ps(_mm256_andnot_ps(sign, next_sin), pulse));
+    const __m256 radius = _mm256_sub_ps(_mm256_loadu_ps(lanes.orbit + i),
+                                        _mm256_mul_ps(extents, scale));
+
+    _mm256_storeu_ps(lanes.cos_angle + i, next_cos);
+    _mm256_storeu_ps(lanes.sin_angle + i, next_sin);
+    _mm256_storeu_ps(lanes.scale + i, scale);
+    _mm256_storeu_ps(lanes.x + i, _mm256_mul_ps(next_cos, radius));
+    _mm256_storeu_ps(lanes.y + i, _mm256_mul_ps(next_sin, radius));
+  }
+  updateScalar(lanes, extent, i, count);
+}
+#endif
+}  // namespace
+
+Shapes::Shapes(float extent) : extent{extent} {}
+
+void Shapes::add(float phase, float angular_velocity, float orbit_radius,
+                 float size, const math::Vec3& color) {
+  const math::SinCos angle = math::sincos(phase);
+  const math::SinCos step = math::sincos(angular_velocity * rotation_step);
+  cos_angle.push_back(angle.cos);
+  sin_angle.push_back(angle.sin);
+  velocity.push_back(angular_velocity);
+  cos_step.push_back(step.cos);
+  sin_step.push_back(step.sin);
+  orbit.push_back(orbit_radius);
+  sizes.push_back(size);
+  rgb.insert(rgb.end(), {color[0], color[1], color[2]});
+}
+
+void Shapes::update(float step, Frame& frame) {
+  const std::size_t count = size();
+  if (step != rotation_step) {
+    rotation_step = step;
+    // The step angles go through sin_step, which the batch then overwrites.
+    for (std::size_t i = 0; i < count; i++) sin_step[i] = velocity[i] * step;
+    math::sincos(sin_step, sin_step, cos_step);
+  }
+  frame.x.resize(count);
+  frame.y.resize(count);
+  frame.scale.resize(count);
+
+  const Lanes lanes{cos_angle.data(), sin_angle.data(), cos_step.data(),
+                    sin_step.data(),  orbit.data(),     sizes.data(),
+                    frame.x.data(),   frame.y.data(),   frame.scale.data()};
+  switch (math::simd::active()) {
+#ifdef SCENE_SHAPES_X86
+    case math::simd::Isa::avx2:
+      updateAvx2(lanes, extent, count);
+      return;
+    case math::simd::Isa::sse:
+      updateSse(lanes, extent, count);
+      return;
+#endif
+    default:
+      updateScalar(lanes, extent, 0, count);
+  }
+}
+
+std::size_t Shapes::size() const { return cos_angle.size(); }
+
+std::span<const float> Shapes::colors() const { return rgb; }
+
+void interpolate(const Shapes::Frame& from, const Shapes::Frame& to,
+                 float alpha, std::span<float> out) {
+  const std::size_t count = to.x.size();
+  assert(from.x.size() == count && out.size() >= 3 * count &&
+         "Frames of different sizes");
+  float* x = out.data();
+  float* y = x + count;
+  float* scale = y + count;
+  for (std::size_t i = 0; i < count; i++) {
+    x[i] = from.x[i] + alpha * (to.x[i] - from.x[i]);
+  }
+  for (std::size_t i = 0; i < count; i++) {
+    y[i] = from.y[i] + alpha * (to.y[i] - from.y[i]);
+  }
+  for (std::size_t i = 0; i < count; i++) {
+    scale[i] = from.scale[i] + alpha * (to.scale[i] - from.scale[i]);
+  }
+}
+}  // namespace scene
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstddef>
+#include <span>
+#include <vector>
+
+#include <math/Mat.hh>
+
+namespace scene {
+// Structure-of-arrays store of 2D shapes, each orbiting the origin inside
+// its own circle while its scale pulses with the orbit angle:
+//
+//   scale = size * (|sin angle| + min_pulse)
+//   x, y  = (cos angle, sin angle) * (orbit - extent * scale)
+//
+// The store keeps every shape's cos/sin and advances them by rotating with
+// a precomputed per-shape step, so a tick costs a few multiplies and adds per
+// shape and no trigonometry. The update kernel uses the instruction set
+// picked by math::simd::active().
+class Shapes {
+ public:
+  // What the renderer needs per tick, one array per attribute so each one
+  // can be uploaded as it is.
+  struct Frame {
+    std::vector<float> x;
+    std::vector<float> y;
+    std::vector<float> scale;
+  };
+
+  static constexpr float min_pulse = 0.25f;
+
+  // `extent` is the half-size of the mesh the shapes are drawn with.
+  explicit Shapes(float extent);
+
+  void add(float phase, float angular_velocity, float orbit_radius, float size,
+           const math::Vec3& color);
+
+  // Advances every shape by `step` seconds and writes the result to `frame`.
+  void update(float step, Frame& frame);
+
+  std::size_t size() const;
+  // Interleaved RGB, three floats per shape. Colors never change.
+  std::span<const float> colors() const;
+
+ private:
+  float extent;
+  // Step the rotation factors were computed for.
+  float rotation_step = 0;
+
+  std::vector<float> cos_angle;
+  std::vector<float> sin_angle;
+  std::vector<float> velocity;
+  std::vector<float> cos_step;
+  std::vector<float> sin_step;
+  std::vector<float> orbit;
+  std::vector<float> sizes;
+  std::vector<float> rgb;
+};
+
+// Blends two frames and writes x, y and scale back to back into `out`,
+// which must hold 3 * count floats: the layout the renderer uploads.
+void interpolate(const Shapes::Frame& from, const Shapes::Frame& to,
+                 float alpha, std::span<float> out);
+}  // namespace scene
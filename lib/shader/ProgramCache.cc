@@ -0,0 +1,149 @@
+#include "ProgramCache.hh"
+
+#include <glad/glad.h>
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <utility>
+
+#include "Shader.hh"
+#include "ShaderProgram.hh"
+
+namespace {
+constexpr std::array<char, 4> magic{'S', 'M', 'P', 'B'};
+
+class Fnv1a {
+  std::uint64_t hash = 14695981039346656037ull;
+
+ public:
+  void add(std::string_view text) {
+    for (const char symbol : text) {
+      hash ^= static_cast<unsigned char>(symbol);
+      hash *= 1099511628211ull;
+    }
+    // Separator, so that ("ab", "c") and ("a", "bc") differ.
+    hash ^= 0xff;
+    hash *= 1099511628211ull;
+  }
+
+  std::uint64_t value() const { return hash; }
+};
+
+std::string_view glString(unsigned name) {
+  const auto* string = reinterpret_cast<const char*>(glGetString(name));
+  return string == nullptr ? std::string_view{} : std::string_view{string};
+}
+}  // namespace
+
+ProgramCache::ProgramCache(std::filesystem::path directory)
+    : directory{std::move(directory)} {}
+
+std::string ProgramCache::key(std::string_view vertex_source,
+                              std::string_view fragment_source) {
+  Fnv1a hash;
+  hash.add(vertex_source);
+  hash.add(fragment_source);
+  hash.add(glString(GL_VENDOR));
+  hash.add(glString(GL_RENDERER));
+  hash.add(glString(GL_VERSION));
+  return std::format("{:016x}", hash.value());
+}
+
+bool ProgramCache::load(ShaderProgram& program,
+                        const std::filesystem::path& file) {
+  std::ifstream input{file, std::ios::binary};
+  if (!input.is_open()) return false;
+
+  std::array<char, magic.size()> file_magic{};
+  ShaderProgram::Binary binary;
+  input.read(file_magic.data(), file_magic.size());
+  input.read(reinterpret_cast<char*>(&binary.format), sizeof(binary.format));
+  if (!input || file_magic != magic) return false;
+
+  std::error_code error;
+  const std::uintmax_t size = std::filesystem::file_size(file, error);
+  const std::uintmax_t header_size = magic.size() + sizeof(binary.format);
+  if (error || size <= header_size) return false;
+  binary.data.resize(size - header_size);
+  input.read(binary.data.data(), binary.data.size());
+  if (!input) return false;
+
+  return program.attachBinary(binary);
+}
+
+void ProgramCache::store(const ShaderProgram& program,
+                         const std::filesystem::path& file) {
+  const ShaderProgram::Binary binary = program.binary();
+  if (binary.data.empty()) return;
+
+  // A cache is best effort: failing to write it must not stop the program.
+  std::error_code error;
+  std::filesystem::create_directories(directory, error);
+  if (error) return;
+
+  std::filesystem::path temporary = file;
+  temporary += ".tmp";
+  {
+    std::ofstream output{temporary, std::ios::binary | std::ios::trunc};
+    output.write(magic.data(), magic.size());
+    output.write(reinterpret_cast<const char*>(&binary.format),
+                 sizeof(binary.format));
+    output.write(binary.data.data(), binary.data.size());
+    if (!output) {
+      std::filesystem::remove(temporary, error);
+      return;
+    }
+  }
+  std::filesystem::rename(temporary, file, error);
+}
+
+ShaderProgram ProgramCache::build(VertexShader& vertex,
+                                  FragmentShader& fragment) {
+  const auto start = std::chrono::steady_clock::now();
+  ShaderProgram program{vertex, fragment};
+
+  last_status = Status::disabled;
+  std::filesystem::path file;
+  if (!directory.empty() && ShaderProgram::binarySupported()) {
+    file = directory / (key(vertex.source(), fragment.source()) + ".bin");
+    last_status = load(program, file) ? Status::hit : Status::miss;
+  }
+
+  if (last_status != Status::hit) {
+    // Submit both stages before waiting so the driver can overlap them.
+    vertex.startCompile();
+    fragment.startCompile();
+    vertex.finishCompile();
+    fragment.finishCompile();
+    program.attach();
+    if (last_status == Status::miss) store(program, file);
+  }
+
+  last_time = std::chrono::steady_clock::now() - start;
+  return program;
+}
+
+ProgramCache::Status ProgramCache::lastStatus() const { return last_status; }
+
+std::chrono::duration<double, std::milli> ProgramCache::lastTime() const {
+  return last_time;
+}
+
+std::string_view ProgramCache::statusName(Status status) {
+  switch (status) {
+    case Status::disabled:
+      return "disabled";
+    case Status::hit:
+      return "hit";
+    case Status::miss:
+      return "miss";
+  }
+  return "unknown";
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <chrono>
+#include <filesystem>
+#include <string>
+#include <string_view>
+
+#include "Shader.hh"
+#include "ShaderProgram.hh"
+
+// On-disk cache of linked program binaries. Entries are keyed by a hash of
+// the shader sources and the driver vendor/renderer/version strings, so
+// editing a shader or updating the driver simply misses the cache.
+class ProgramCache {
+ public:
+  enum class Status { disabled, hit, miss };
+
+ private:
+  std::filesystem::path directory;
+  Status last_status = Status::disabled;
+  std::chrono::duration<double, std::milli> last_time{0};
+
+  bool load(ShaderProgram& program, const std::filesystem::path& file);
+  void store(const ShaderProgram& program, const std::filesystem::path& file);
+
+ public:
+  // An empty directory disables caching: build() always compiles.
+  explicit ProgramCache(std::filesystem::path directory);
+
+  static std::string key(std::string_view vertex_source,
+                         std::string_view fragment_source);
+
+  // Loads the program from the cache, or compiles, links and stores it.
+  ShaderProgram build(VertexShader& vertex, FragmentShader& fragment);
+
+  Status lastStatus() const;
+  std::chrono::duration<double, std::milli> lastTime() const;
+  static std::string_view statusName(Status status);
+};
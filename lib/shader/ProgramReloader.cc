@@ -0,0 +1,58 @@
+#include "ProgramReloader.hh"
+
+#include <exception>
+#include <filesystem>
+#include <string>
+#include <utility>
+
+#include "Shader.hh"
+#include "ShaderProgram.hh"
+
+ProgramReloader::ProgramReloader(std::filesystem::path vertex_path,
+                                 std::filesystem::path fragment_path)
+    : vertex_path{std::move(vertex_path)},
+      fragment_path{std::move(fragment_path)},
+      watcher{this->vertex_path.parent_path()} {}
+
+void ProgramReloader::start() {
+  pending.emplace(VertexShader{vertex_path}, FragmentShader{fragment_path},
+                  std::nullopt);
+  pending->vertex.startCompile();
+  pending->fragment.startCompile();
+}
+
+bool ProgramReloader::advance(ShaderProgram& program) {
+  if (!pending->program) {
+    if (!pending->vertex.ready() || !pending->fragment.ready()) return false;
+    pending->vertex.finishCompile();
+    pending->fragment.finishCompile();
+    pending->program.emplace(pending->vertex, pending->fragment);
+    pending->program->startLink();
+  }
+
+  if (!pending->program->ready()) return false;
+  pending->program->finishLink();
+  program = std::move(*pending->program);
+  pending.reset();
+  return true;
+}
+
+ProgramReloader::Status ProgramReloader::poll(ShaderProgram& program) {
+  try {
+    bool changed = false;
+    for (const std::filesystem::path& path : watcher.changes()) {
+      changed = changed || path == vertex_path || path == fragment_path;
+    }
+    // A newer edit supersedes a build still in flight.
+    if (changed) start();
+
+    if (!pending) return Status::idle;
+    return advance(program) ? Status::swapped : Status::building;
+  } catch (const std::exception& exception) {
+    pending.reset();
+    error_message = exception.what();
+    return Status::failed;
+  }
+}
+
+const std::string& ProgramReloader::error() const { return error_message; }
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <utils/watcher.hh>
+
+#include "Shader.hh"
+#include "ShaderProgram.hh"
+
+// Rebuilds a program whenever one of its shader files changes. Compilation
+// and linking are started without waiting and polled every frame, so with
+// GL_KHR_parallel_shader_compile the render loop never stalls on them. A
+// program that fails to build is discarded and the current one keeps running.
+class ProgramReloader {
+ public:
+  enum class Status { idle, building, swapped, failed };
+
+ private:
+  struct Pending {
+    VertexShader vertex;
+    FragmentShader fragment;
+    std::optional<ShaderProgram> program;
+  };
+
+  std::filesystem::path vertex_path;
+  std::filesystem::path fragment_path;
+  utils::FileWatcher watcher;
+  std::optional<Pending> pending;
+  std::string error_message;
+
+  void start();
+  bool advance(ShaderProgram& program);
+
+ public:
+  ProgramReloader(std::filesystem::path vertex_path,
+                  std::filesystem::path fragment_path);
+
+  // Call once per frame with the program in use. On `swapped` the program
+  // has been replaced, so uniform handles must be fetched again; on `failed`
+  // error() holds the compiler or linker output.
+  Status poll(ShaderProgram& program);
+
+  const std::string& error() const;
+};
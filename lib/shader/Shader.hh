@@ -5,10 +5,13 @@
 #include <format>
 #include <utils/fs.hh>
 
+#include "parallel.hh"
+
 template <unsigned shader_type>
 class Shader {
   unsigned object;
   std::filesystem::path path;
+  std::string sources;
 
   static constexpr unsigned error_buffer_size = 512;
 
@@ -33,7 +36,9 @@ class Shader {
   Shader& operator=(const Shader&) = delete;
 
   Shader(Shader&& other) noexcept
-      : object{other.object}, path{std::move(other.path)} {
+      : object{other.object},
+        path{std::move(other.path)},
+        sources{std::move(other.sources)} {
     other.object = 0;
     other.path.clear();
   }
@@ -42,22 +47,48 @@ class Shader {
     if (this != &other) {
       deleteShader();
       std::swap(object, other.object);
+      std::swap(path, other.path);
+      std::swap(sources, other.sources);
     }
     return *this;
   }
 
   ~Shader() { deleteShader(); }
 
+  // Reads the file on first use.
+  const std::string& source() {
+    if (sources.empty()) sources = utils::readFile(path);
+    return sources;
+  }
+
   void compile() {
-    if (object == 0) return;
+    startCompile();
+    finishCompile();
+  }
 
-    const std::string sources = utils::readFile(path);
-    std::string error_messsage_buffer(error_buffer_size, '\0');
-    int error_flag = 0;
+  // Hands the sources to the driver without waiting for the result.
+  void startCompile() {
+    if (object == 0) return;
 
-    const char* data = sources.data();
+    const char* data = source().data();
     glShaderSource(object, 1, &data, nullptr);
     glCompileShader(object);
+  }
+
+  // Never blocks. Without GL_KHR_parallel_shader_compile completion cannot be
+  // queried, so the shader is reported ready and finishCompile() waits.
+  bool ready() const {
+    if (object == 0 || !parallelCompileSupported()) return true;
+    int completed = 0;
+    glGetShaderiv(object, GL_COMPLETION_STATUS_KHR, &completed);
+    return completed;
+  }
+
+  void finishCompile() {
+    if (object == 0) return;
+
+    std::string error_messsage_buffer(error_buffer_size, '\0');
+    int error_flag = 0;
 
     glGetShaderiv(object, GL_COMPILE_STATUS, &error_flag);
     if (!error_flag) {
@@ -2,11 +2,15 @@
 
 #include <glad/glad.h>
 
+#include <algorithm>
+#include <cassert>
 #include <stdexcept>
 #include <string>
+#include <string_view>
 #include <utility>
 
 #include "Shader.hh"
+#include "parallel.hh"
 
 void ShaderProgram::deleteProgram() {
   if (shader_program != 0) {
@@ -15,25 +19,37 @@ void ShaderProgram::deleteProgram() {
   }
 }
 
-unsigned ShaderProgram::getLocation(std::string_view location) {
-  const unsigned location_id =
-      glGetUniformLocation(shader_program, location.data());
-
-  if (unsigned error = glGetError(); error != GL_NO_ERROR) {
-    if (error == GL_INVALID_VALUE) {
-      throw std::runtime_error{
-          "Shader Program is not a value generated by OpenGL"};
-    }
-    if (error == GL_INVALID_OPERATION) {
-      throw std::runtime_error{"Shader program is not a program object"};
-    }
-    if (error == GL_INVALID_OPERATION) {
-      throw std::runtime_error{
-          "Shader program has not been successfully linked"};
+void ShaderProgram::reflectUniforms() {
+  int count = 0, max_length = 0;
+  glGetProgramiv(shader_program, GL_ACTIVE_UNIFORMS, &count);
+  glGetProgramiv(shader_program, GL_ACTIVE_UNIFORM_MAX_LENGTH, &max_length);
+
+  uniforms.clear();
+  uniforms.reserve(count);
+  std::string name(max_length, '\0');
+  for (int index = 0; index < count; index++) {
+    int length = 0, size = 0;
+    unsigned type = 0;
+    glGetActiveUniform(shader_program, index, max_length, &length, &size,
+                       &type, name.data());
+    std::string uniform_name = name.substr(0, length);
+    const int location =
+        glGetUniformLocation(shader_program, uniform_name.c_str());
+    // Arrays are reported as "name[0]"; keep the plain name for lookups.
+    if (uniform_name.ends_with("[0]")) uniform_name.resize(length - 3);
+    // Block members have no location and cannot be set through glUniform.
+    if (location != -1) {
+      uniforms.emplace_back(std::move(uniform_name), Uniform{location, type});
     }
   }
+  std::ranges::sort(uniforms, {}, &std::pair<std::string, Uniform>::first);
+}
 
-  return location_id;
+ShaderProgram::Uniform ShaderProgram::uniform(std::string_view name) const {
+  const auto found = std::ranges::lower_bound(
+      uniforms, name, {}, &std::pair<std::string, Uniform>::first);
+  if (found == uniforms.end() || found->first != name) return {};
+  return found->second;
 }
 
 ShaderProgram::ShaderProgram(const VertexShader& vertex,
@@ -49,7 +65,8 @@ ShaderProgram::ShaderProgram(const VertexShader& vertex,
 ShaderProgram::ShaderProgram(ShaderProgram&& other) noexcept
     : shader_program{other.shader_program},
       vertex_object{other.vertex_object},
-      fragment_object{other.fragment_object} {
+      fragment_object{other.fragment_object},
+      uniforms{std::move(other.uniforms)} {
   other.shader_program = 0;
   other.vertex_object = 0;
   other.fragment_object = 0;
@@ -62,6 +79,7 @@ ShaderProgram& ShaderProgram::operator=(ShaderProgram&& other) {
     std::swap(shader_program, other.shader_program);
     std::swap(vertex_object, other.vertex_object);
     std::swap(fragment_object, other.fragment_object);
+    uniforms = std::move(other.uniforms);
   }
   return *this;
 }
@@ -69,14 +87,34 @@ ShaderProgram& ShaderProgram::operator=(ShaderProgram&& other) {
 ShaderProgram::~ShaderProgram() { deleteProgram(); }
 
 void ShaderProgram::attach() {
-  if (shader_program == 0) return;
+  startLink();
+  finishLink();
+}
 
-  std::string error_message_bufer(error_buffer_size, '\0');
-  int error_flag = 0;
+void ShaderProgram::startLink() {
+  if (shader_program == 0) return;
 
   glAttachShader(shader_program, vertex_object);
   glAttachShader(shader_program, fragment_object);
+  if (binarySupported()) {
+    glProgramParameteri(shader_program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT,
+                        GL_TRUE);
+  }
   glLinkProgram(shader_program);
+}
+
+bool ShaderProgram::ready() const {
+  if (shader_program == 0 || !parallelCompileSupported()) return true;
+  int completed = 0;
+  glGetProgramiv(shader_program, GL_COMPLETION_STATUS_KHR, &completed);
+  return completed;
+}
+
+void ShaderProgram::finishLink() {
+  if (shader_program == 0) return;
+
+  std::string error_message_bufer(error_buffer_size, '\0');
+  int error_flag = 0;
 
   glGetProgramiv(shader_program, GL_LINK_STATUS, &error_flag);
   if (!error_flag) {
@@ -85,20 +123,87 @@ void ShaderProgram::attach() {
     throw std::runtime_error{"Error while linking shader program:\n" +
                              error_message_bufer};
   }
+
+  reflectUniforms();
+}
+
+bool ShaderProgram::binarySupported() {
+#ifdef GL_VERSION_4_1
+  if (!GLAD_GL_VERSION_4_1) return false;
+  int formats = 0;
+  glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+  return formats > 0;
+#else
+  return false;
+#endif
+}
+
+ShaderProgram::Binary ShaderProgram::binary() const {
+  Binary result;
+  if (shader_program == 0 || !binarySupported()) return result;
+
+  int length = 0;
+  glGetProgramiv(shader_program, GL_PROGRAM_BINARY_LENGTH, &length);
+  result.data.resize(length);
+  glGetProgramBinary(shader_program, length, &length, &result.format,
+                     result.data.data());
+  result.data.resize(length);
+  return result;
+}
+
+bool ShaderProgram::attachBinary(const Binary& binary) {
+  if (shader_program == 0 || binary.data.empty() || !binarySupported()) {
+    return false;
+  }
+
+  glProgramBinary(shader_program, binary.format, binary.data.data(),
+                  binary.data.size());
+  int error_flag = 0;
+  glGetProgramiv(shader_program, GL_LINK_STATUS, &error_flag);
+  if (!error_flag) return false;
+
+  reflectUniforms();
+  return true;
 }
 
 void ShaderProgram::use() {
   if (shader_program != 0) glUseProgram(shader_program);
 }
 
+unsigned ShaderProgram::id() const { return shader_program; }
+
 void ShaderProgram::setUniformMatrix3x3(std::string_view location,
                                         const float* data) {
-  const unsigned location_id = getLocation(location);
-  glUniformMatrix3fv(location_id, 1, GL_TRUE, data);
+  setUniformMatrix3x3(uniform(location), data);
+}
+
+void ShaderProgram::setUniformMatrix4x4(std::string_view location,
+                                        const float* data) {
+  setUniformMatrix4x4(uniform(location), data);
 }
 
 void ShaderProgram::setUniformVector3(std::string_view location, float x,
                                       float y, float z) {
-  const unsigned location_id = getLocation(location);
-  glUniform3f(location_id, x, y, z);
+  setUniformVector3(uniform(location), x, y, z);
+}
+
+void ShaderProgram::setUniformMatrix3x3(const Uniform& uniform,
+                                        const float* data) {
+  assert((uniform.location == -1 || uniform.type == GL_FLOAT_MAT3) &&
+         "Uniform is not a mat3");
+  glUniformMatrix3fv(uniform.location, 1, GL_TRUE, data);
+}
+
+void ShaderProgram::setUniformMatrix4x4(const Uniform& uniform,
+                                        const float* data) {
+  assert((uniform.location == -1 || uniform.type == GL_FLOAT_MAT4) &&
+         "Uniform is not a mat4");
+  glUniformMatrix4fv(uniform.location, 1, GL_TRUE, data);
+}
+
+void ShaderProgram::setUniformVector3(const Uniform& uniform, float x, float y,
+                                      float z) {
+  assert((uniform.location == -1 || uniform.type == GL_FLOAT_VEC3) &&
+         "Uniform is not a vec3");
+  glUniform3f(uniform.location, x, y, z);
 }
@@ -1,19 +1,38 @@
 #pragma once
 
+#include <string>
 #include <string_view>
+#include <utility>
+#include <vector>
 
 #include "Shader.hh"
 
 class ShaderProgram {
+ public:
+  // Active uniform as reported by the linker. Setters taking a Uniform skip
+  // the name lookup; location -1 (unknown name) makes them no-ops, like GL.
+  struct Uniform {
+    int location = -1;
+    unsigned type = 0;
+  };
+
+  // Driver-specific linked program, see glGetProgramBinary.
+  struct Binary {
+    unsigned format = 0;
+    std::vector<char> data;
+  };
+
+ private:
   unsigned shader_program;
   unsigned vertex_object;
   unsigned fragment_object;
+  // Sorted by name; filled once after linking.
+  std::vector<std::pair<std::string, Uniform>> uniforms;
 
   static constexpr unsigned error_buffer_size = 512;
 
   void deleteProgram();
-
-  unsigned getLocation(std::string_view location);
+  void reflectUniforms();
 
  public:
   ShaderProgram() = delete;
@@ -29,7 +48,27 @@ class ShaderProgram {
 
   void attach();
   void use();
+  // GL name, 0 until linked.
+  unsigned id() const;
+
+  // Non-blocking variant of attach(): startLink(), poll ready() once per
+  // frame, then finishLink(), which throws on link errors.
+  void startLink();
+  bool ready() const;
+  void finishLink();
+
+  static bool binarySupported();
+  Binary binary() const;
+  // Links from a binary instead of the shaders; false if the driver rejects it.
+  bool attachBinary(const Binary& binary);
+
+  Uniform uniform(std::string_view name) const;
 
   void setUniformMatrix3x3(std::string_view location, const float* data);
+  void setUniformMatrix4x4(std::string_view location, const float* data);
   void setUniformVector3(std::string_view location, float x, float y, float z);
+
+  void setUniformMatrix3x3(const Uniform& uniform, const float* data);
+  void setUniformMatrix4x4(const Uniform& uniform, const float* data);
+  void setUniformVector3(const Uniform& uniform, float x, float y, float z);
 };
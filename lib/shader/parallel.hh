@@ -0,0 +1,33 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <string_view>
+
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+
+// Whether GL_KHR_parallel_shader_compile is available. The first call also
+// lets the driver use as many compiler threads as it wants.
+inline bool parallelCompileSupported() {
+  static const bool supported = [] {
+    int count = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+    for (int index = 0; index < count; index++) {
+      const auto* name =
+          reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, index));
+      if (name != nullptr &&
+          std::string_view{name} == "GL_KHR_parallel_shader_compile") {
+#ifdef GL_KHR_parallel_shader_compile
+        if (glMaxShaderCompilerThreadsKHR) {
+          glMaxShaderCompilerThreadsKHR(0xFFFFFFFF);
+        }
+#endif
+        return true;
+      }
+    }
+    return false;
+  }();
+  return supported;
+}
@@ -0,0 +1,22 @@
+#include "args.hh"
+
+#include <algorithm>
+#include <optional>
+#include <string_view>
+
+namespace utils {
+Args::Args(int argc, const char* argv[])
+    : arguments(argv + std::min(argc, 1), argv + argc) {}
+
+bool Args::has(std::string_view flag) const {
+  return std::ranges::find(arguments, flag) != arguments.end();
+}
+
+std::optional<std::string_view> Args::get(std::string_view option) const {
+  const auto found = std::ranges::find(arguments, option);
+  if (found == arguments.end() || found + 1 == arguments.end()) {
+    return std::nullopt;
+  }
+  return *(found + 1);
+}
+}  // namespace utils
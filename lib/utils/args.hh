@@ -0,0 +1,34 @@
+#pragma once
+
+#include <charconv>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace utils {
+// Minimal command line reader for `--flag` and `--option value` pairs.
+class Args {
+  std::vector<std::string_view> arguments;
+
+ public:
+  Args(int argc, const char* argv[]);
+
+  bool has(std::string_view flag) const;
+  std::optional<std::string_view> get(std::string_view option) const;
+
+  template <typename T>
+  T value(std::string_view option, T fallback) const {
+    const std::optional<std::string_view> text = get(option);
+    if (!text) return fallback;
+    T result{};
+    const auto [end, error] =
+        std::from_chars(text->data(), text->data() + text->size(), result);
+    if (error != std::errc{} || end != text->data() + text->size()) {
+      throw std::runtime_error{"Invalid value for " + std::string{option}};
+    }
+    return result;
+  }
+};
+}  // namespace utils
@@ -1,22 +1,168 @@
 #include "fs.hh"
 
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <exception>
 #include <filesystem>
 #include <fstream>
-#include <sstream>
+#include <future>
+#include <iterator>
+#include <span>
 #include <stdexcept>
 #include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <utility>
+#include <vector>
 
 namespace utils {
+namespace {
+int adviceFor(MappedFile::Access access) {
+  switch (access) {
+    case MappedFile::Access::normal:
+      return MADV_NORMAL;
+    case MappedFile::Access::sequential:
+      return MADV_SEQUENTIAL;
+    case MappedFile::Access::random:
+      return MADV_RANDOM;
+  }
+  return MADV_NORMAL;
+}
+}  // namespace
+
 std::string readFile(const std::filesystem::path& path) {
-  std::ifstream input_file_stream{path};
+  std::ifstream input_file_stream{path, std::ios::binary};
   if (!input_file_stream.is_open()) {
     throw std::runtime_error{"Cannot open " + path.string()};
   }
-  std::ostringstream output_string_stream;
-  output_string_stream << input_file_stream.rdbuf();
-  if (output_string_stream.fail() || output_string_stream.fail()) {
+  std::string contents;
+  std::error_code error;
+  const std::uintmax_t size = std::filesystem::file_size(path, error);
+  if (!error) {
+    contents.resize(size);
+    input_file_stream.read(contents.data(), contents.size());
+    contents.resize(input_file_stream.gcount());
+  }
+  // Special files report no size, and files may grow while being read.
+  if (input_file_stream) {
+    contents.append(std::istreambuf_iterator<char>{input_file_stream}, {});
+  }
+  if (input_file_stream.bad()) {
     throw std::runtime_error{"Error occured while reading " + path.string()};
   }
-  return output_string_stream.str();
+  return contents;
 }
+
+MappedFile::MappedFile(const std::filesystem::path& path, Access access) {
+  const int descriptor = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (descriptor == -1) {
+    throw std::runtime_error{"Cannot open " + path.string() + ": " +
+                             std::strerror(errno)};
+  }
+  struct stat status;
+  if (fstat(descriptor, &status) == -1) {
+    const int error = errno;
+    close(descriptor);
+    throw std::runtime_error{"Cannot read " + path.string() + ": " +
+                             std::strerror(error)};
+  }
+  if (status.st_size > 0) {
+    void* mapping = mmap(nullptr, status.st_size, PROT_READ, MAP_PRIVATE,
+                         descriptor, 0);
+    if (mapping == MAP_FAILED) {
+      const int error = errno;
+      close(descriptor);
+      throw std::runtime_error{"Cannot map " + path.string() + ": " +
+                               std::strerror(error)};
+    }
+    data = static_cast<const std::byte*>(mapping);
+    length = status.st_size;
+  }
+  // The mapping stays valid after the descriptor is closed.
+  close(descriptor);
+  advise(access);
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : data{std::exchange(other.data, nullptr)},
+      length{std::exchange(other.length, 0)} {}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+  if (this != &other) {
+    if (data) munmap(const_cast<std::byte*>(data), length);
+    data = std::exchange(other.data, nullptr);
+    length = std::exchange(other.length, 0);
+  }
+  return *this;
+}
+
+MappedFile::~MappedFile() {
+  if (data) munmap(const_cast<std::byte*>(data), length);
+}
+
+std::span<const std::byte> MappedFile::bytes() const { return {data, length}; }
+
+std::string_view MappedFile::text() const {
+  return {reinterpret_cast<const char*>(data), length};
+}
+
+std::size_t MappedFile::size() const { return length; }
+
+// Hints are advisory, so failures are ignored.
+void MappedFile::advise(Access access) const {
+  if (data) madvise(const_cast<std::byte*>(data), length, adviceFor(access));
+}
+
+void MappedFile::prefetch() const {
+  if (!data) return;
+  madvise(const_cast<std::byte*>(data), length, MADV_WILLNEED);
+  const std::size_t page = sysconf(_SC_PAGESIZE);
+  for (std::size_t offset = 0; offset < length; offset += page) {
+    static_cast<void>(*static_cast<const volatile std::byte*>(data + offset));
+  }
+}
+
+FileBatch::FileBatch(std::vector<std::filesystem::path> paths,
+                     unsigned threads)
+    : paths{std::move(paths)}, promises(this->paths.size()) {
+  for (auto& promise : promises) futures.push_back(promise.get_future());
+  if (threads == 0) {
+    threads = std::max(std::thread::hardware_concurrency(), 1u);
+  }
+  threads = std::min<std::size_t>(threads, this->paths.size());
+  for (unsigned i = 0; i < threads; i++) {
+    workers.emplace_back([this] { work(); });
+  }
+}
+
+void FileBatch::work() {
+  for (std::size_t index = next++; index < paths.size(); index = next++) {
+    try {
+      MappedFile file{paths[index]};
+      file.prefetch();
+      promises[index].set_value(std::move(file));
+    } catch (...) {
+      promises[index].set_exception(std::current_exception());
+    }
+  }
+}
+
+std::size_t FileBatch::size() const { return paths.size(); }
+
+bool FileBatch::ready(std::size_t index) const {
+  return futures[index].wait_for(std::chrono::seconds{0}) ==
+         std::future_status::ready;
+}
+
+MappedFile FileBatch::get(std::size_t index) { return futures[index].get(); }
 }  // namespace utils
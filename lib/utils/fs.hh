@@ -1,8 +1,78 @@
 #pragma once
 
+#include <atomic>
+#include <cstddef>
 #include <filesystem>
+#include <future>
+#include <span>
 #include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
 
 namespace utils {
+// Whole file in a string, read with a single copy. Works for files that
+// cannot be mapped, such as pipes and /proc entries.
 std::string readFile(const std::filesystem::path& path);
+
+// Read-only mapping of a whole file. Reads fault pages in from the page
+// cache directly, without copying into a buffer first. The file must not be
+// truncated while mapped, which makes reads past the new end fail with
+// SIGBUS. Empty files map to an empty span.
+class MappedFile {
+  const std::byte* data = nullptr;
+  std::size_t length = 0;
+
+ public:
+  // madvise hints that steer the kernel's readahead.
+  enum class Access { normal, sequential, random };
+
+  MappedFile() = default;
+  explicit MappedFile(const std::filesystem::path& path,
+                      Access access = Access::sequential);
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  MappedFile(MappedFile&& other) noexcept;
+  MappedFile& operator=(MappedFile&& other) noexcept;
+
+  ~MappedFile();
+
+  std::span<const std::byte> bytes() const;
+  std::string_view text() const;
+  std::size_t size() const;
+
+  void advise(Access access) const;
+  // Starts reading the whole file in (MADV_WILLNEED) and touches every page,
+  // so later reads do not wait for the disk.
+  void prefetch() const;
+};
+
+// Maps a batch of files and prefetches them on worker threads, so many
+// assets load in parallel while the caller carries on. Each result is taken
+// once with get(), which waits for that file and rethrows its error.
+// Destruction waits for the workers to finish the batch.
+class FileBatch {
+  std::vector<std::filesystem::path> paths;
+  std::vector<std::promise<MappedFile>> promises;
+  std::vector<std::future<MappedFile>> futures;
+  std::atomic<std::size_t> next{0};
+  std::vector<std::jthread> workers;
+
+  void work();
+
+ public:
+  FileBatch() = delete;
+  // `threads` defaults to the hardware concurrency.
+  explicit FileBatch(std::vector<std::filesystem::path> paths,
+                     unsigned threads = 0);
+
+  FileBatch(const FileBatch&) = delete;
+  FileBatch& operator=(const FileBatch&) = delete;
+
+  std::size_t size() const;
+  bool ready(std::size_t index) const;
+  MappedFile get(std::size_t index);
 };
+}  // namespace utils
@@ -0,0 +1,348 @@
+#include "jobs.hh"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <mutex>
+#include <stop_token>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace utils {
+namespace {
+// Deque capacity per thread; a full deque runs new jobs in place.
+constexpr std::size_t deque_capacity = 1024;
+// Attempts to find work before a worker goes to sleep.
+constexpr unsigned spins = 64;
+// Automatic grain: enough subranges per thread to even out the splits.
+constexpr std::size_t chunks_per_thread = 32;
+
+// The system and deque of the calling thread.
+thread_local const JobSystem* member_system = nullptr;
+thread_local unsigned member_index = 0;
+}  // namespace
+
+// One parallelFor() call, on the caller's stack until `remaining` is 0.
+struct JobSystem::Loop {
+  void* body;
+  RangeFunction run;
+  std::size_t grain;
+  std::atomic<std::size_t> remaining;
+  std::atomic<bool> failed{false};
+  std::exception_ptr error;
+};
+
+// A submitted job or a chunk of a loop. Recycled through the free list, so
+// the vector keeps its capacity.
+struct JobSystem::Task {
+  JobSystem* system;
+  // Job handles, plus one from submission until the job has finished.
+  std::atomic<unsigned> references{0};
+
+  std::function<void()> work;
+  std::exception_ptr error;
+  // Unfinished dependencies, plus one while they are being registered.
+  std::atomic<unsigned> pending{0};
+  std::atomic<bool> finished{false};
+  std::mutex mutex;
+  // Jobs depending on this one, until it finishes and sets `closed`.
+  std::vector<Task*> continuations;
+  bool closed = false;
+
+  Loop* loop = nullptr;
+  std::size_t begin = 0;
+  std::size_t end = 0;
+};
+
+JobSystem::Job::Job(Task* task) : task{task} {
+  task->references.fetch_add(1, std::memory_order_relaxed);
+}
+
+JobSystem::Job::Job(const Job& other) : task{other.task} {
+  if (task) task->references.fetch_add(1, std::memory_order_relaxed);
+}
+
+JobSystem::Job& JobSystem::Job::operator=(const Job& other) {
+  if (other.task) {
+    other.task->references.fetch_add(1, std::memory_order_relaxed);
+  }
+  if (task) task->system->release(task);
+  task = other.task;
+  return *this;
+}
+
+JobSystem::Job::~Job() {
+  if (task) task->system->release(task);
+}
+
+bool JobSystem::Job::done() const {
+  return task && task->finished.load(std::memory_order_acquire);
+}
+
+JobSystem::JobSystem(unsigned threads)
+    : previous_system{member_system}, previous_index{member_index} {
+  if (threads == 0) {
+    threads = std::max(std::thread::hardware_concurrency(), 1u);
+  }
+  thread_count = threads;
+  for (unsigned i = 0; i < threads; i++) {
+    deques.push_back(std::make_unique<StealingDeque<Task*>>(deque_capacity));
+  }
+  member_system = this;
+  member_index = 0;
+  for (unsigned i = 1; i < threads; i++) {
+    workers.emplace_back(
+        [this, i](std::stop_token stop) { work(stop, i); });
+  }
+}
+
+JobSystem::~JobSystem() {
+  while (Task* task = find(0)) execute(task, 0);
+  for (std::jthread& worker : workers) worker.request_stop();
+  epoch.fetch_add(1);
+  epoch.notify_all();
+  workers.clear();
+  member_system = previous_system;
+  member_index = previous_index;
+}
+
+JobSystem::Job JobSystem::submit(std::function<void()> work,
+                                 std::initializer_list<Job> dependencies) {
+  Task* task = allocate();
+  task->work = std::move(work);
+  task->references.store(1, std::memory_order_relaxed);
+  task->pending.store(dependencies.size() + 1, std::memory_order_relaxed);
+  Job job{task};
+  for (const Job& dependency : dependencies) {
+    Task* before = dependency.task;
+    bool registered = false;
+    if (before) {
+      std::lock_guard lock{before->mutex};
+      if (!before->closed) {
+        before->continuations.push_back(task);
+        registered = true;
+      }
+    }
+    if (!registered) task->pending.fetch_sub(1, std::memory_order_acq_rel);
+  }
+  if (task->pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+    schedule(task, current());
+  }
+  return job;
+}
+
+void JobSystem::wait(const Job& job) {
+  if (!job.task) return;
+  const unsigned index = current();
+  while (!job.task->finished.load(std::memory_order_acquire)) {
+    if (Task* task = find(index)) {
+      execute(task, index);
+    } else {
+      std::this_thread::yield();
+    }
+  }
+  if (job.task->error) std::rethrow_exception(job.task->error);
+}
+
+unsigned JobSystem::threads() const { return thread_count; }
+
+void JobSystem::forRange(std::size_t begin, std::size_t end,
+                         std::size_t grain, void* body, RangeFunction run) {
+  if (begin >= end) return;
+  const std::size_t count = end - begin;
+  if (grain == 0) {
+    grain = thread_count == 1
+                ? count
+                : std::max<std::size_t>(
+                      count / (thread_count * chunks_per_thread), 1);
+  }
+  if (thread_count == 1) {
+    for (std::size_t first = begin; first < end; first += grain) {
+      run(body, first, std::min(end, first + grain));
+    }
+    return;
+  }
+
+  Loop loop{body, run, grain, count};
+  const unsigned index = current();
+  runRange(loop, begin, end, index);
+  while (loop.remaining.load(std::memory_order_acquire) > 0) {
+    if (Task* task = find(index)) {
+      execute(task, index);
+    } else {
+      std::this_thread::yield();
+    }
+  }
+  if (loop.error) std::rethrow_exception(loop.error);
+}
+
+void JobSystem::runRange(Loop& loop, std::size_t begin, std::size_t end,
+                         const unsigned index) {
+  while (begin < end) {
+    // Lazy binary splitting: offer half of the rest only once the work
+    // offered before has been taken.
+    if (end - begin > loop.grain && idle(index)) {
+      Task* chunk = allocate();
+      chunk->references.store(1, std::memory_order_relaxed);
+      chunk->loop = &loop;
+      chunk->begin = begin + (end - begin) / 2;
+      chunk->end = end;
+      end = chunk->begin;
+      schedule(chunk, index);
+      continue;
+    }
+    const std::size_t last = std::min(end, begin + loop.grain);
+    if (!loop.failed.load(std::memory_order_relaxed)) {
+      try {
+        loop.run(loop.body, begin, last);
+      } catch (...) {
+        if (!loop.failed.exchange(true)) loop.error = std::current_exception();
+      }
+    }
+    // The loop may be gone once this reaches 0.
+    loop.remaining.fetch_sub(last - begin, std::memory_order_acq_rel);
+    begin = last;
+  }
+}
+
+void JobSystem::work(std::stop_token stop, const unsigned index) {
+  member_system = this;
+  member_index = index;
+  unsigned attempts = 0;
+  while (true) {
+    if (Task* task = find(index)) {
+      execute(task, index);
+      attempts = 0;
+      continue;
+    }
+    if (++attempts < spins) {
+      std::this_thread::yield();
+      continue;
+    }
+
+    // Announce the sleep before the last look for work, so that a job
+    // queued after that look sees the sleeper and wakes it.
+    const unsigned seen = epoch.load();
+    sleepers.fetch_add(1);
+    Task* task = find(index);
+    if (!task && !stop.stop_requested()) epoch.wait(seen);
+    sleepers.fetch_sub(1);
+    if (task) {
+      execute(task, index);
+    } else if (stop.stop_requested()) {
+      break;
+    }
+    attempts = 0;
+  }
+}
+
+unsigned JobSystem::current() const {
+  return member_system == this ? member_index : outsider;
+}
+
+JobSystem::Task* JobSystem::allocate() {
+  std::lock_guard lock{free_mutex};
+  if (free_tasks.empty()) {
+    tasks.push_back(std::make_unique<Task>());
+    tasks.back()->system = this;
+    return tasks.back().get();
+  }
+  Task* task = free_tasks.back();
+  free_tasks.pop_back();
+  return task;
+}
+
+void JobSystem::release(Task* task) {
+  if (task->references.fetch_sub(1, std::memory_order_acq_rel) != 1) return;
+  task->work = nullptr;
+  task->error = nullptr;
+  task->finished.store(false, std::memory_order_relaxed);
+  task->continuations.clear();
+  task->closed = false;
+  task->loop = nullptr;
+  std::lock_guard lock{free_mutex};
+  free_tasks.push_back(task);
+}
+
+void JobSystem::schedule(Task* task, const unsigned index) {
+  if (index == outsider) {
+    std::lock_guard lock{shared_mutex};
+    shared.push_back(task);
+    shared_count.fetch_add(1);
+  } else if (!deques[index]->push(task)) {
+    execute(task, index);
+    return;
+  }
+  wake();
+}
+
+bool JobSystem::idle(const unsigned index) {
+  if (index == outsider) return shared_count.load() == 0;
+  return deques[index]->empty();
+}
+
+JobSystem::Task* JobSystem::find(const unsigned index) {
+  if (index != outsider) {
+    if (Task* task = deques[index]->pop()) return task;
+  }
+  if (shared_count.load(std::memory_order_relaxed) > 0) {
+    std::lock_guard lock{shared_mutex};
+    if (!shared.empty()) {
+      Task* task = shared.back();
+      shared.pop_back();
+      shared_count.fetch_sub(1);
+      return task;
+    }
+  }
+  const unsigned start = index == outsider ? 0 : index + 1;
+  for (unsigned i = 0; i < thread_count; i++) {
+    const unsigned victim = (start + i) % thread_count;
+    if (victim == index) continue;
+    if (Task* task = deques[victim]->steal()) return task;
+  }
+  return nullptr;
+}
+
+void JobSystem::execute(Task* task, const unsigned index) {
+  if (task->loop) {
+    runRange(*task->loop, task->begin, task->end, index);
+    release(task);
+    return;
+  }
+
+  try {
+    task->work();
+  } catch (...) {
+    task->error = std::current_exception();
+  }
+  {
+    std::lock_guard lock{task->mutex};
+    task->closed = true;
+  }
+  // Closed, nothing adds continuations any more, so they are scheduled
+  // without the lock: schedule() may run one in place, and it may submit a
+  // job that depends on this one.
+  for (Task* continuation : task->continuations) {
+    if (continuation->pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      schedule(continuation, index);
+    }
+  }
+  task->finished.store(true, std::memory_order_release);
+  release(task);
+}
+
+void JobSystem::wake() {
+  // Pairs with the sleeper's increment: either it sees the new job when it
+  // looks a last time, or this sees it asleep.
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (sleepers.load() > 0) {
+    epoch.fetch_add(1);
+    epoch.notify_one();
+  }
+}
+}  // namespace utils
@@ -0,0 +1,212 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <mutex>
+#include <stop_token>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace utils {
+// Chase-Lev work-stealing deque of pointers with a fixed capacity. The owning
+// thread pushes and pops at the bottom, any other thread steals from the top;
+// the owner only contends with thieves for the last item.
+template <typename T>
+class StealingDeque {
+  static_assert(std::is_pointer_v<T>);
+
+  std::unique_ptr<std::atomic<T>[]> items;
+  std::int64_t mask;
+  alignas(64) std::atomic<std::int64_t> top{0};
+  alignas(64) std::atomic<std::int64_t> bottom{0};
+
+ public:
+  // `capacity` is rounded up to a power of two.
+  explicit StealingDeque(std::size_t capacity = 1024) {
+    std::int64_t size = 1;
+    while (size < static_cast<std::int64_t>(capacity)) size <<= 1;
+    items = std::make_unique<std::atomic<T>[]>(size);
+    mask = size - 1;
+  }
+
+  StealingDeque(const StealingDeque&) = delete;
+  StealingDeque& operator=(const StealingDeque&) = delete;
+
+  // Owner only. False when full.
+  bool push(T item) {
+    const std::int64_t b = bottom.load(std::memory_order_relaxed);
+    const std::int64_t t = top.load(std::memory_order_acquire);
+    if (b - t > mask) return false;
+    items[b & mask].store(item, std::memory_order_relaxed);
+    bottom.store(b + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Owner only. The newest item, or nullptr when empty.
+  T pop() {
+    const std::int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+    bottom.store(b, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    std::int64_t t = top.load(std::memory_order_relaxed);
+    if (t > b) {
+      bottom.store(b + 1, std::memory_order_relaxed);
+      return nullptr;
+    }
+    T item = items[b & mask].load(std::memory_order_relaxed);
+    if (t == b) {
+      // Last item: whoever moves `top` first gets it.
+      if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                       std::memory_order_relaxed)) {
+        item = nullptr;
+      }
+      bottom.store(b + 1, std::memory_order_relaxed);
+    }
+    return item;
+  }
+
+  // Any thread. The oldest item, or nullptr when empty or lost to a race.
+  T steal() {
+    std::int64_t t = top.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    const std::int64_t b = bottom.load(std::memory_order_acquire);
+    if (t >= b) return nullptr;
+    T item = items[t & mask].load(std::memory_order_relaxed);
+    if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                     std::memory_order_relaxed)) {
+      return nullptr;
+    }
+    return item;
+  }
+
+  // Exact only when no other thread is using the deque.
+  bool empty() const {
+    return bottom.load(std::memory_order_relaxed) <=
+           top.load(std::memory_order_relaxed);
+  }
+};
+
+// Work-stealing thread pool. Each thread has a StealingDeque: it runs its
+// own jobs newest first and, when out of work, steals the oldest job of
+// another thread. The thread that creates the system takes part as well,
+// running jobs whenever it waits, so `threads` counts it too.
+//
+// Jobs may be submitted from any thread; the creating thread and the workers
+// push to their own deque, others to a shared queue. Jobs and loop chunks
+// are recycled, so once a loop has run, running it again allocates nothing.
+//
+// Not for blocking work such as disk reads, which would keep a worker from
+// others' jobs; FileBatch has threads of its own for that.
+class JobSystem {
+  struct Task;
+  struct Loop;
+  using RangeFunction = void (*)(void* body, std::size_t begin,
+                                 std::size_t end);
+
+ public:
+  // Reference to a submitted job, to wait for it or to make other jobs
+  // depend on it. Copies refer to the same job.
+  class Job {
+    Task* task = nullptr;
+
+    explicit Job(Task* task);
+    friend class JobSystem;
+
+   public:
+    Job() = default;
+    Job(const Job& other);
+    Job& operator=(const Job& other);
+    ~Job();
+
+    // Whether the job has finished, successfully or not.
+    bool done() const;
+  };
+
+  // `threads` defaults to the hardware concurrency.
+  explicit JobSystem(unsigned threads = 0);
+
+  JobSystem(const JobSystem&) = delete;
+  JobSystem& operator=(const JobSystem&) = delete;
+
+  // Runs the jobs already queued, then stops the workers. Jobs still waiting
+  // for dependencies at that point are dropped. Must happen on the creating
+  // thread, after every Job handle is gone.
+  ~JobSystem();
+
+  // Queues `work` to run once every job in `dependencies` has finished,
+  // which makes it a continuation of them. A dependency that throws still
+  // counts as finished.
+  Job submit(std::function<void()> work,
+             std::initializer_list<Job> dependencies = {});
+
+  // Runs other jobs until `job` has finished, then rethrows its exception.
+  void wait(const Job& job);
+
+  // Calls body(first, last) on disjoint subranges covering [begin, end),
+  // in parallel, and returns once all of them have returned. A subrange is
+  // `grain` indices at most; 0 picks a grain from the range size.
+  //
+  // Splitting is adaptive: a thread keeps its range whole while its deque
+  // still has work to give and splits off half of the rest whenever another
+  // thread stole it all, so loops with uneven iterations stay balanced
+  // without a fine fixed grain. The first exception thrown by the body is
+  // rethrown once the other subranges have finished; the subranges not
+  // started by then are skipped.
+  template <typename Body>
+  void parallelFor(std::size_t begin, std::size_t end, Body&& body,
+                   std::size_t grain = 0) {
+    forRange(begin, end, grain, &body,
+             [](void* body, std::size_t first, std::size_t last) {
+               (*static_cast<std::remove_reference_t<Body>*>(body))(first,
+                                                                    last);
+             });
+  }
+
+  unsigned threads() const;
+
+ private:
+  // Index of a thread that has no deque of its own.
+  static constexpr unsigned outsider = ~0u;
+
+  unsigned thread_count;
+  std::vector<std::unique_ptr<StealingDeque<Task*>>> deques;
+
+  // Jobs submitted by threads outside the system.
+  std::mutex shared_mutex;
+  std::vector<Task*> shared;
+  std::atomic<std::size_t> shared_count{0};
+
+  std::mutex free_mutex;
+  std::vector<std::unique_ptr<Task>> tasks;
+  std::vector<Task*> free_tasks;
+
+  // Bumped to wake sleeping workers.
+  std::atomic<unsigned> epoch{0};
+  std::atomic<unsigned> sleepers{0};
+  // What the creating thread belonged to before, restored on destruction.
+  const JobSystem* previous_system;
+  unsigned previous_index;
+  std::vector<std::jthread> workers;
+
+  void forRange(std::size_t begin, std::size_t end, std::size_t grain,
+                void* body, RangeFunction run);
+  void runRange(Loop& loop, std::size_t begin, std::size_t end,
+                unsigned index);
+
+  void work(std::stop_token stop, unsigned index);
+  // Deque index of the calling thread, `outsider` if it has none.
+  unsigned current() const;
+  Task* allocate();
+  void release(Task* task);
+  void schedule(Task* task, unsigned index);
+  bool idle(unsigned index);
+  Task* find(unsigned index);
+  void execute(Task* task, unsigned index);
+  void wake();
+};
+}  // namespace utils
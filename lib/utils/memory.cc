@@ -0,0 +1,160 @@
+#include "memory.hh"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <new>
+
+namespace utils {
+namespace {
+constexpr std::size_t roundUp(std::size_t size, std::size_t alignment) {
+  return (size + alignment - 1) / alignment * alignment;
+}
+}  // namespace
+
+// Header at the start of every upstream allocation; the usable bytes follow
+// it, aligned for any type.
+struct alignas(std::max_align_t) Arena::Block {
+  Block* next;
+  std::size_t size;
+};
+
+Arena::Arena(std::size_t block_size, std::pmr::memory_resource* upstream)
+    : upstream{upstream}, block_size{block_size} {}
+
+Arena::~Arena() { release(); }
+
+void Arena::grow(std::size_t bytes, std::size_t alignment) {
+  const std::size_t size = std::max(block_size, bytes + alignment);
+  void* memory =
+      upstream->allocate(sizeof(Block) + size, alignof(std::max_align_t));
+  blocks = new (memory) Block{blocks, size};
+  offset = 0;
+}
+
+void Arena::release() {
+  while (blocks != nullptr) {
+    Block* next = blocks->next;
+    upstream->deallocate(blocks, sizeof(Block) + blocks->size,
+                         alignof(std::max_align_t));
+    blocks = next;
+  }
+  offset = 0;
+}
+
+void* Arena::do_allocate(std::size_t bytes, std::size_t alignment) {
+  if (blocks == nullptr) grow(bytes, alignment);
+  for (;;) {
+    std::byte* data = reinterpret_cast<std::byte*>(blocks + 1);
+    const auto address = reinterpret_cast<std::uintptr_t>(data + offset);
+    const std::size_t padding = roundUp(address, alignment) - address;
+    if (offset + padding + bytes <= blocks->size) {
+      void* result = data + offset + padding;
+      offset += padding + bytes;
+      used_bytes += padding + bytes;
+      return result;
+    }
+    // The new block always fits the request.
+    grow(bytes, alignment);
+  }
+}
+
+void Arena::do_deallocate(void* pointer, std::size_t bytes,
+                          std::size_t alignment) {}
+
+bool Arena::do_is_equal(
+    const std::pmr::memory_resource& other) const noexcept {
+  return this == &other;
+}
+
+void Arena::reset() {
+  if (blocks != nullptr && blocks->next != nullptr) {
+    const std::size_t total = capacity();
+    release();
+    void* memory =
+        upstream->allocate(sizeof(Block) + total, alignof(std::max_align_t));
+    blocks = new (memory) Block{nullptr, total};
+  }
+  offset = 0;
+  used_bytes = 0;
+}
+
+std::size_t Arena::used() const { return used_bytes; }
+
+std::size_t Arena::capacity() const {
+  std::size_t total = 0;
+  for (const Block* block = blocks; block != nullptr; block = block->next) {
+    total += block->size;
+  }
+  return total;
+}
+
+struct Pool::Block {
+  Block* next;
+};
+
+Pool::Pool(std::size_t chunk_size, std::size_t chunks_per_block,
+           std::size_t alignment, std::pmr::memory_resource* upstream)
+    : upstream{upstream},
+      chunk_size{roundUp(std::max(chunk_size, sizeof(void*)),
+                         std::max(alignment, alignof(void*)))},
+      chunk_alignment{std::max(alignment, alignof(void*))},
+      chunks_per_block{std::max<std::size_t>(chunks_per_block, 1)} {}
+
+Pool::~Pool() {
+  const std::size_t header = roundUp(sizeof(Block), chunk_alignment);
+  const std::size_t block_bytes = header + chunk_size * chunks_per_block;
+  while (blocks != nullptr) {
+    Block* next = blocks->next;
+    upstream->deallocate(blocks, block_bytes,
+                         std::max(chunk_alignment, alignof(Block)));
+    blocks = next;
+  }
+}
+
+void Pool::grow() {
+  const std::size_t header = roundUp(sizeof(Block), chunk_alignment);
+  void* memory =
+      upstream->allocate(header + chunk_size * chunks_per_block,
+                         std::max(chunk_alignment, alignof(Block)));
+  blocks = new (memory) Block{blocks};
+  std::byte* first = static_cast<std::byte*>(memory) + header;
+  // Pushed last to first, so chunks are handed out in address order.
+  for (std::size_t i = chunks_per_block; i-- > 0;) {
+    void* chunk = first + i * chunk_size;
+    *static_cast<void**>(chunk) = free_list;
+    free_list = chunk;
+  }
+  chunks += chunks_per_block;
+}
+
+void* Pool::do_allocate(std::size_t bytes, std::size_t alignment) {
+  if (bytes > chunk_size || alignment > chunk_alignment) {
+    throw std::bad_alloc{};
+  }
+  if (free_list == nullptr) grow();
+  void* chunk = free_list;
+  free_list = *static_cast<void**>(chunk);
+  live++;
+  return chunk;
+}
+
+void Pool::do_deallocate(void* pointer, std::size_t bytes,
+                         std::size_t alignment) {
+  *static_cast<void**>(pointer) = free_list;
+  free_list = pointer;
+  live--;
+}
+
+bool Pool::do_is_equal(
+    const std::pmr::memory_resource& other) const noexcept {
+  return this == &other;
+}
+
+std::size_t Pool::chunkSize() const { return chunk_size; }
+
+std::size_t Pool::allocated() const { return live; }
+
+std::size_t Pool::capacity() const { return chunks; }
+}  // namespace utils
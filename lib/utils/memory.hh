@@ -0,0 +1,98 @@
+#pragma once
+
+#include <cstddef>
+#include <memory_resource>
+
+namespace utils {
+// Linear allocator for data that lives one frame: allocation bumps an
+// offset into the current block and deallocation does nothing, until reset()
+// frees everything at once. Pass it to pmr containers and math::Matrix.
+//
+// When a frame needs more than one block, reset() replaces them with a single
+// block holding all of them, so once a frame has run, repeating it allocates
+// nothing upstream. Not thread-safe.
+class Arena final : public std::pmr::memory_resource {
+  struct Block;
+
+  std::pmr::memory_resource* upstream;
+  std::size_t block_size;
+  // Newest block first; allocations are carved from `blocks` only.
+  Block* blocks = nullptr;
+  std::size_t offset = 0;
+  std::size_t used_bytes = 0;
+
+  void grow(std::size_t bytes, std::size_t alignment);
+  void release();
+
+  void* do_allocate(std::size_t bytes, std::size_t alignment) override;
+  void do_deallocate(void* pointer, std::size_t bytes,
+                     std::size_t alignment) override;
+  bool do_is_equal(
+      const std::pmr::memory_resource& other) const noexcept override;
+
+ public:
+  static constexpr std::size_t default_block_size = 64 * 1024;
+
+  explicit Arena(
+      std::size_t block_size = default_block_size,
+      std::pmr::memory_resource* upstream = std::pmr::new_delete_resource());
+
+  Arena(const Arena&) = delete;
+  Arena& operator=(const Arena&) = delete;
+
+  ~Arena() override;
+
+  // Invalidates everything allocated so far.
+  void reset();
+
+  // Bytes handed out since the last reset, alignment padding included.
+  std::size_t used() const;
+  // Bytes held from upstream.
+  std::size_t capacity() const;
+};
+
+// Allocator for long-lived objects of one size, such as nodes that are added
+// and removed at run time. Chunks come from blocks of `chunks_per_block` and
+// go back to a free list when deallocated; blocks are only returned upstream
+// with the pool. Requests larger than the chunk size throw std::bad_alloc.
+// Not thread-safe.
+class Pool final : public std::pmr::memory_resource {
+  struct Block;
+
+  std::pmr::memory_resource* upstream;
+  std::size_t chunk_size;
+  std::size_t chunk_alignment;
+  std::size_t chunks_per_block;
+  Block* blocks = nullptr;
+  // Freed chunks, each holding the next one's address.
+  void* free_list = nullptr;
+  std::size_t live = 0;
+  std::size_t chunks = 0;
+
+  void grow();
+
+  void* do_allocate(std::size_t bytes, std::size_t alignment) override;
+  void do_deallocate(void* pointer, std::size_t bytes,
+                     std::size_t alignment) override;
+  bool do_is_equal(
+      const std::pmr::memory_resource& other) const noexcept override;
+
+ public:
+  explicit Pool(
+      std::size_t chunk_size, std::size_t chunks_per_block = 64,
+      std::size_t alignment = alignof(std::max_align_t),
+      std::pmr::memory_resource* upstream = std::pmr::new_delete_resource());
+
+  Pool(const Pool&) = delete;
+  Pool& operator=(const Pool&) = delete;
+
+  // Chunks still allocated are freed with their blocks.
+  ~Pool() override;
+
+  std::size_t chunkSize() const;
+  // Chunks handed out and not yet deallocated.
+  std::size_t allocated() const;
+  // Chunks held from upstream.
+  std::size_t capacity() const;
+};
+}  // namespace utils
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <stop_token>
+#include <thread>
+#include <utility>
+
+#include "triple.hh"
+
+namespace utils {
+// Advances a State at a fixed tick rate, independently of how fast frames
+// are drawn. Every tick publishes the previous and the new state, so the
+// renderer can interpolate between them with alpha().
+//
+// start() runs the ticks on a separate thread; without it tick() advances
+// one step on the calling thread, e.g. for reproducible offscreen runs.
+template <typename State>
+class Simulation {
+ public:
+  using clock = std::chrono::steady_clock;
+  using Step = std::function<void(State& state, double step)>;
+
+  struct Snapshot {
+    State previous;
+    State current;
+    // When `current` became due.
+    clock::time_point time;
+    unsigned long tick = 0;
+  };
+
+  // Ticks further behind than this are dropped instead of replayed, e.g.
+  // after the process was suspended.
+  static constexpr unsigned max_catch_up = 8;
+
+  Simulation(State initial, double rate, Step step)
+      : buffer{Snapshot{initial, initial, clock::now()}},
+        state{std::move(initial)},
+        step_function{std::move(step)},
+        step_seconds{1.0 / rate},
+        step_duration{std::chrono::duration_cast<clock::duration>(
+            std::chrono::duration<double>{step_seconds})} {}
+
+  Simulation(const Simulation&) = delete;
+  Simulation& operator=(const Simulation&) = delete;
+
+  void start() {
+    thread = std::jthread{[this](std::stop_token stop) { run(stop); }};
+  }
+
+  void tick() { advance(clock::now()); }
+
+  // Reader side: the newest snapshot.
+  const Snapshot& latest() { return buffer.read(); }
+
+  // How far `now` is from the snapshot's previous state toward its current
+  // one. The picture lags one tick behind the simulation in exchange for
+  // smooth motion at any frame rate.
+  float alpha(const Snapshot& snapshot,
+              clock::time_point now = clock::now()) const {
+    const std::chrono::duration<double> since = now - snapshot.time;
+    return std::clamp(static_cast<float>(since.count() / step_seconds), 0.f,
+                      1.f);
+  }
+
+  double getStep() const { return step_seconds; }
+
+ private:
+  TripleBuffer<Snapshot> buffer;
+  State state;
+  Step step_function;
+  double step_seconds;
+  clock::duration step_duration;
+  unsigned long ticks = 0;
+  std::jthread thread;
+
+  void advance(clock::time_point due) {
+    Snapshot& snapshot = buffer.write();
+    snapshot.previous = state;
+    step_function(state, step_seconds);
+    snapshot.current = state;
+    snapshot.time = due;
+    snapshot.tick = ++ticks;
+    buffer.publish();
+  }
+
+  void run(std::stop_token stop) {
+    clock::time_point due = clock::now();
+    while (!stop.stop_requested()) {
+      advance(due);
+      due += step_duration;
+      const clock::time_point now = clock::now();
+      if (now - due > max_catch_up * step_duration) due = now;
+      std::this_thread::sleep_until(due);
+    }
+  }
+};
+}  // namespace utils
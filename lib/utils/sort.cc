@@ -0,0 +1,55 @@
+#include "sort.hh"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+namespace utils {
+std::span<const std::uint32_t> RadixSorter::sort(
+    std::span<const std::uint64_t> input) {
+  constexpr unsigned digits = sizeof(std::uint64_t);
+  const std::size_t count = input.size();
+  for (unsigned buffer = 0; buffer < 2; buffer++) {
+    keys[buffer].resize(count);
+    indices[buffer].resize(count);
+  }
+
+  // All histograms in one pass over the keys.
+  std::array<std::array<std::uint32_t, 256>, digits> histograms{};
+  for (std::size_t i = 0; i < count; i++) {
+    keys[0][i] = input[i];
+    indices[0][i] = static_cast<std::uint32_t>(i);
+    for (unsigned digit = 0; digit < digits; digit++) {
+      histograms[digit][(input[i] >> (digit * 8)) & 0xff]++;
+    }
+  }
+
+  unsigned current = 0;
+  for (unsigned digit = 0; digit < digits; digit++) {
+    std::array<std::uint32_t, 256>& histogram = histograms[digit];
+    const unsigned shift = digit * 8;
+    if (count == 0 || histogram[(keys[current][0] >> shift) & 0xff] == count) {
+      continue;
+    }
+    // Counts become the first output slot of each byte value.
+    std::uint32_t offset = 0;
+    for (std::uint32_t& slot : histogram) {
+      const std::uint32_t size = slot;
+      slot = offset;
+      offset += size;
+    }
+    const std::vector<std::uint64_t>& from_keys = keys[current];
+    const std::vector<std::uint32_t>& from_indices = indices[current];
+    std::vector<std::uint64_t>& to_keys = keys[1 - current];
+    std::vector<std::uint32_t>& to_indices = indices[1 - current];
+    for (std::size_t i = 0; i < count; i++) {
+      const std::uint32_t slot = histogram[(from_keys[i] >> shift) & 0xff]++;
+      to_keys[slot] = from_keys[i];
+      to_indices[slot] = from_indices[i];
+    }
+    current = 1 - current;
+  }
+  return indices[current];
+}
+}  // namespace utils
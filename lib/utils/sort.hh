@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace utils {
+// LSD radix sort of 64-bit keys, one byte per pass. It orders indices rather
+// than moving the records the keys belong to, and skips every byte on which
+// all keys agree, so keys that differ only in a few fields cost a few
+// passes. Buffers are kept between calls: sorting no more keys than before
+// does not allocate.
+class RadixSorter {
+ public:
+  // Indices of `keys` in ascending key order, equal keys in index order.
+  // The result stays valid until the next call.
+  std::span<const std::uint32_t> sort(std::span<const std::uint64_t> keys);
+
+ private:
+  std::vector<std::uint64_t> keys[2];
+  std::vector<std::uint32_t> indices[2];
+};
+}  // namespace utils
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+
+namespace utils {
+// Hands the latest value from one writer thread to one reader thread without
+// locks or waiting. The writer fills its back slot and publishes it by
+// swapping it with the middle slot; the reader swaps the middle slot into
+// front when it holds something new. Values the reader never got to are
+// overwritten, and the reader always sees a complete one.
+template <typename T>
+class TripleBuffer {
+  // Set in `middle` while it holds a value the reader has not taken yet.
+  static constexpr unsigned fresh = 4;
+  static constexpr unsigned index_mask = 3;
+
+  std::array<T, 3> slots;
+  alignas(64) std::atomic<unsigned> middle{1};
+  alignas(64) unsigned back = 0;
+  alignas(64) unsigned front = 2;
+
+ public:
+  TripleBuffer() = default;
+  explicit TripleBuffer(const T& initial) : slots{initial, initial, initial} {}
+
+  TripleBuffer(const TripleBuffer&) = delete;
+  TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+  // Writer side: the slot to fill, then publish() it.
+  T& write() { return slots[back]; }
+
+  void publish() {
+    back = middle.exchange(back | fresh, std::memory_order_acq_rel) &
+           index_mask;
+  }
+
+  // Reader side: the newest published value.
+  const T& read() {
+    if (middle.load(std::memory_order_relaxed) & fresh) {
+      front = middle.exchange(front, std::memory_order_acq_rel) & index_mask;
+    }
+    return slots[front];
+  }
+};
+}  // namespace utils
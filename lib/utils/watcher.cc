@@ -0,0 +1,73 @@
+#include "watcher.hh"
+
+#include <sys/inotify.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace utils {
+FileWatcher::FileWatcher(std::filesystem::path directory)
+    : descriptor{inotify_init1(IN_NONBLOCK | IN_CLOEXEC)},
+      directory{std::move(directory)} {
+  if (descriptor == -1) {
+    throw std::runtime_error{std::string{"Cannot create inotify instance: "} +
+                             std::strerror(errno)};
+  }
+  // Editors either rewrite files in place or write a copy and rename it.
+  if (inotify_add_watch(descriptor, this->directory.c_str(),
+                        IN_CLOSE_WRITE | IN_MOVED_TO) == -1) {
+    const int error = errno;
+    close(descriptor);
+    throw std::runtime_error{"Cannot watch " + this->directory.string() +
+                             ": " + std::strerror(error)};
+  }
+}
+
+FileWatcher::FileWatcher(FileWatcher&& other) noexcept
+    : descriptor{std::exchange(other.descriptor, -1)},
+      directory{std::move(other.directory)} {}
+
+FileWatcher& FileWatcher::operator=(FileWatcher&& other) noexcept {
+  if (this != &other) {
+    if (descriptor != -1) close(descriptor);
+    descriptor = std::exchange(other.descriptor, -1);
+    directory = std::move(other.directory);
+  }
+  return *this;
+}
+
+FileWatcher::~FileWatcher() {
+  if (descriptor != -1) close(descriptor);
+}
+
+std::vector<std::filesystem::path> FileWatcher::changes() {
+  std::vector<std::filesystem::path> changed;
+  if (descriptor == -1) return changed;
+
+  alignas(inotify_event) char buffer[4096];
+  while (true) {
+    const ssize_t length = read(descriptor, buffer, sizeof(buffer));
+    if (length <= 0) break;
+
+    for (ssize_t offset = 0; offset < length;) {
+      const auto* event =
+          reinterpret_cast<const inotify_event*>(buffer + offset);
+      if (event->len > 0) {
+        std::filesystem::path path = directory / event->name;
+        if (std::ranges::find(changed, path) == changed.end()) {
+          changed.push_back(std::move(path));
+        }
+      }
+      offset += sizeof(inotify_event) + event->len;
+    }
+  }
+  return changed;
+}
+}  // namespace utils
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <filesystem>
+#include <vector>
+
+namespace utils {
+// Reports files in one directory that were written or replaced (inotify).
+class FileWatcher {
+  int descriptor = -1;
+  std::filesystem::path directory;
+
+ public:
+  FileWatcher() = delete;
+  explicit FileWatcher(std::filesystem::path directory);
+
+  FileWatcher(const FileWatcher&) = delete;
+  FileWatcher& operator=(const FileWatcher&) = delete;
+
+  FileWatcher(FileWatcher&& other) noexcept;
+  FileWatcher& operator=(FileWatcher&& other) noexcept;
+
+  ~FileWatcher();
+
+  // Full paths of files changed since the previous call, without duplicates.
+  // Never blocks, so it can be polled once per frame.
+  std::vector<std::filesystem::path> changes();
+};
+}  // namespace utils
@@ -0,0 +1,41 @@
+#include "frame.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include <math/Mat.hh>
+#include <scene/Shapes.hh>
+
+scene::Shapes makeShapes(const unsigned count) {
+  scene::Shapes shapes{square_size};
+  if (count == 1) {
+    shapes.add(0, 1, circle_radius, 1, square_color);
+    return shapes;
+  }
+  const float size =
+      std::max(0.02f, 2.f / std::sqrt(static_cast<float>(count)));
+  for (unsigned i = 0; i < count; i++) {
+    const float phase = i * golden_angle;
+    const math::Vec3 color{std::fabs(std::sin(phase)),
+                           std::fabs(std::sin(phase + 2.1f)),
+                           std::fabs(std::sin(phase + 4.2f))};
+    shapes.add(phase, 0.5f + (i % 16) / 16.f,
+               circle_radius * std::sqrt((i + 0.5f) / count), size, color);
+  }
+  return shapes;
+}
+
+math::Mat3 squareTransform(const scene::Shapes::Frame& previous,
+                           const scene::Shapes::Frame& current,
+                           const float alpha) {
+  const auto blend = [&](const std::vector<float>& from,
+                         const std::vector<float>& to) {
+    return std::lerp(from[0], to[0], alpha);
+  };
+  const math::Mat3 translate = math::translate3x3(
+      blend(previous.x, current.x), blend(previous.y, current.y));
+  const math::Mat3 scale =
+      math::scale3x3(blend(previous.scale, current.scale));
+  return scale * translate;
+}
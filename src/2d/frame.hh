@@ -0,0 +1,32 @@
+#pragma once
+
+// CPU work of a 2D demo frame: the shapes and the transform of the single
+// square. Nothing here touches GL, so tests can run frames without a window.
+
+#include <numbers>
+
+#include <math/Mat.hh>
+#include <mesh/Mesh.hh>
+#include <scene/Shapes.hh>
+
+constexpr float square_size = 0.25;
+constexpr float circle_radius = 0.95f;
+
+// Two triangles over the four corners (+-square_size, +-square_size).
+inline constexpr auto square =
+    mesh::polygon<4>(square_size * std::numbers::sqrt2_v<float>,
+                     std::numbers::pi_v<float> / 4);
+inline constexpr auto& vertices = square.positions;
+
+constexpr math::Vec3 square_color{0.992f, 0.698f, 0.1f};
+// pi * (3 - sqrt(5)): spreads phases evenly without repeating.
+constexpr float golden_angle = 2.39996323f;
+
+// One square orbiting the whole window, or `count` smaller ones with their
+// own phases, speeds and orbits, spread evenly over the disc.
+scene::Shapes makeShapes(unsigned count);
+
+// Transform of the first shape `alpha` of the way between two ticks, used
+// when a single square is drawn without instancing.
+math::Mat3 squareTransform(const scene::Shapes::Frame& previous,
+                           const scene::Shapes::Frame& current, float alpha);
@@ -3,17 +3,41 @@
 #include <GLFW/glfw3.h>
 // clang-format on
 
-#include <cmath>
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
 #include <exception>
 #include <filesystem>
+#include <format>
+#include <frame.hh>
+#include <heap/counters.hh>
 #include <iostream>
 #include <logger/core.hh>
-#include <math/Matrix.hh>
+#include <math/Mat.hh>
+#include <optional>
+#include <render/DrawQueue.hh>
+#include <render/FrameReader.hh>
+#include <render/Framebuffer.hh>
+#include <render/Profiler.hh>
+#include <render/StateCache.hh>
+#include <render/StreamBuffer.hh>
 #include <resources.hh>
+#include <scene/Shapes.hh>
+#include <span>
+#include <shader/ProgramCache.hh>
+#include <shader/ProgramReloader.hh>
 #include <shader/Shader.hh>
 #include <shader/ShaderProgram.hh>
 #include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utils/args.hh>
 #include <utils/defer.hh>
+#include <utils/simulation.hh>
+#include <utility>
+#include <vector>
 #include <version.hh>
 
 constexpr unsigned height = 800;
@@ -23,16 +47,28 @@ constexpr const char* title = "Shape movement 2D";
 constexpr const char* vertex_shader_path = SHADERS_PATH "/vertex.vert";
 constexpr const char* fragment_shader_path = SHADERS_PATH "/fragment.frag";
 
-constexpr float square_size = 0.25;
-constexpr float circle_radius = 0.95f;
+// Seconds between refreshes of the timings shown in the title.
+constexpr double title_interval = 0.5;
+// Simulation ticks per second unless --tick-rate says otherwise. Headless
+// runs advance one tick per frame.
+constexpr double default_tick_rate = 60;
 
-const math::Matrix vertices{
-    {square_size, square_size, 1},  {square_size, -square_size, 1},
-    {-square_size, square_size, 1},
+constexpr unsigned offset_x_location = 1;
+constexpr unsigned offset_y_location = 2;
+constexpr unsigned scale_location = 3;
+constexpr unsigned color_location = 4;
 
-    {square_size, -square_size, 1}, {-square_size, -square_size, 1},
-    {-square_size, square_size, 1},
-};
+// Points the per-shape attributes at x, y and scale arrays stored back to
+// back in the buffer bound to GL_ARRAY_BUFFER, starting `offset` bytes in.
+void setShapeAttributes(const std::size_t offset, const std::size_t count) {
+  const unsigned locations[] = {offset_x_location, offset_y_location,
+                                scale_location};
+  for (unsigned i = 0; i < 3; i++) {
+    glVertexAttribPointer(
+        locations[i], 1, GL_FLOAT, GL_FALSE, sizeof(float),
+        reinterpret_cast<const void*>(offset + i * count * sizeof(float)));
+  }
+}
 
 void onWindowSizeChanged(GLFWwindow* window, int width, int height) {
   logger::logDebug("Changed window size: {}x{}")(width, height);
@@ -47,7 +83,30 @@ void onKeyPress(GLFWwindow* window, int key, int scancode, int action,
   }
 }
 
-void start() {
+int contextApi(std::string_view name) {
+  if (name == "egl") return GLFW_EGL_CONTEXT_API;
+  if (name == "osmesa") return GLFW_OSMESA_CONTEXT_API;
+  throw std::runtime_error{"Unknown context API " + std::string{name}};
+}
+
+void start(const utils::Args& args) {
+  const unsigned shapes_count = std::max(args.value("--shapes", 1u), 1u);
+  const bool instanced = shapes_count > 1;
+  // Shapes share one static mesh, so they are always transformed on the GPU.
+  const bool gpu_transform = instanced || args.has("--gpu-transform");
+  logger::logInfo("Transforming vertices on the {}")(gpu_transform ? "GPU"
+                                                                  : "CPU");
+  if (instanced) logger::logInfo("Drawing {} shapes")(shapes_count);
+
+  const bool headless = args.has("--headless");
+  if (headless) {
+#ifdef GLFW_PLATFORM_NULL
+    glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_NULL);
+#else
+    throw std::runtime_error{"Headless mode requires GLFW 3.4"};
+#endif
+  }
+
   if (!glfwInit()) {
     throw std::runtime_error{"Cannot initiate glfw"};
   }
@@ -55,6 +114,11 @@ void start() {
   glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
   glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
   glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+  if (headless) {
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    glfwWindowHint(GLFW_CONTEXT_CREATION_API,
+                   contextApi(args.get("--context").value_or("egl")));
+  }
 
   utils::defer defer{glfwTerminate};
 
@@ -71,13 +135,36 @@ void start() {
     throw std::runtime_error{"Impossible to load OpenGL functions"};
   }
 
+  // The null platform has no default framebuffer to draw into.
+  std::optional<render::Framebuffer> offscreen;
+  if (headless) {
+    offscreen.emplace(width, height);
+    offscreen->bind();
+    logger::logInfo("Rendering offscreen, {}")(
+        reinterpret_cast<const char*>(glGetString(GL_RENDERER)));
+  }
+
+  std::optional<render::FrameReader> reader;
+  if (const auto dump_directory = args.get("--dump")) {
+    const std::filesystem::path directory{*dump_directory};
+    std::filesystem::create_directories(directory);
+    reader.emplace(width, height,
+                   [directory](const render::FrameReader::Frame& frame) {
+                     render::writePpm(
+                         directory / std::format("{:06}.ppm", frame.number),
+                         frame);
+                   });
+  }
+
   VertexShader vertex_shader{vertex_shader_path};
   FragmentShader fragment_shader{fragment_shader_path};
-  vertex_shader.compile();
-  fragment_shader.compile();
 
-  ShaderProgram shader_program{vertex_shader, fragment_shader};
-  shader_program.attach();
+  ProgramCache program_cache{args.get("--shader-cache").value_or("")};
+  ShaderProgram shader_program =
+      program_cache.build(vertex_shader, fragment_shader);
+  logger::logInfo("Shader program ready in {:.2f}ms, cache: {}")(
+      program_cache.lastTime().count(),
+      ProgramCache::statusName(program_cache.lastStatus()));
 
   unsigned vertex_array_object;
   glGenVertexArrays(1, &vertex_array_object);
@@ -87,56 +174,286 @@ void start() {
   unsigned vertex_buffer_object;
   glGenBuffers(1, &vertex_buffer_object);
   glBindBuffer(GL_ARRAY_BUFFER, vertex_buffer_object);
-  const unsigned items_number = vertices.getRows() * vertices.getCols();
-  glBufferData(GL_ARRAY_BUFFER, items_number * sizeof(float), nullptr,
-               GL_DYNAMIC_DRAW);
+  constexpr unsigned items_number = vertices.size();
+  // With the GPU transform the mesh never changes, so it is uploaded once.
+  glBufferData(GL_ARRAY_BUFFER, items_number * sizeof(float),
+               gpu_transform ? vertices.pointer() : nullptr,
+               gpu_transform ? GL_STATIC_DRAW : GL_DYNAMIC_DRAW);
   utils::defer defer_vbo{glDeleteBuffers, 1, &vertex_buffer_object};
 
   glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), nullptr);
   glEnableVertexAttribArray(0);
 
+  // Bound with the vertex array, which keeps it for the draw calls.
+  unsigned element_buffer_object;
+  glGenBuffers(1, &element_buffer_object);
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, element_buffer_object);
+  glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(square.indices),
+               square.indices.data(), GL_STATIC_DRAW);
+  utils::defer defer_ebo{glDeleteBuffers, 1, &element_buffer_object};
+
+  scene::Shapes shapes = makeShapes(shapes_count);
+  // x, y and scale of every shape, one array after another.
+  std::vector<float> shape_data(instanced ? 3 * shapes.size() : 0);
+  unsigned shape_buffer_object = 0;
+  unsigned color_buffer_object = 0;
+  if (instanced) {
+    glGenBuffers(1, &color_buffer_object);
+    glBindBuffer(GL_ARRAY_BUFFER, color_buffer_object);
+    glBufferData(GL_ARRAY_BUFFER, shapes.colors().size_bytes(),
+                 shapes.colors().data(), GL_STATIC_DRAW);
+    glVertexAttribPointer(color_location, 3, GL_FLOAT, GL_FALSE,
+                          3 * sizeof(float), nullptr);
+
+    glGenBuffers(1, &shape_buffer_object);
+    glBindBuffer(GL_ARRAY_BUFFER, shape_buffer_object);
+    glBufferData(GL_ARRAY_BUFFER, shape_data.size() * sizeof(float), nullptr,
+                 GL_STREAM_DRAW);
+    setShapeAttributes(0, shapes.size());
+
+    for (const unsigned location : {offset_x_location, offset_y_location,
+                                    scale_location, color_location}) {
+      glEnableVertexAttribArray(location);
+      glVertexAttribDivisor(location, 1);
+    }
+  } else {
+    // Without instance arrays the shader reads constant attribute values.
+    glVertexAttrib1f(offset_x_location, 0);
+    glVertexAttrib1f(offset_y_location, 0);
+    glVertexAttrib1f(scale_location, 1);
+    glVertexAttrib3f(color_location, square_color[0], square_color[1],
+                     square_color[2]);
+  }
+  utils::defer defer_shapes{glDeleteBuffers, 1, &shape_buffer_object};
+  utils::defer defer_colors{glDeleteBuffers, 1, &color_buffer_object};
+
   glBindVertexArray(0);
 
+  // Only shape data or CPU-transformed vertices change every frame.
+  std::optional<render::StreamBuffer> stream;
+  const auto strategy = args.get("--stream-buffer");
+  if (strategy && (instanced || !gpu_transform)) {
+    const std::size_t frame_size = instanced
+                                       ? shape_data.size() * sizeof(float)
+                                       : items_number * sizeof(float);
+    stream.emplace(GL_ARRAY_BUFFER, frame_size,
+                   render::StreamBuffer::parseStrategy(*strategy));
+    logger::logInfo("Streaming per-frame data through a {} buffer")(
+        render::StreamBuffer::strategyName(stream->getStrategy()));
+  }
+
+  // Frame state goes through the cache, and draws through the queue.
+  render::StateCache state;
+  render::DrawQueue queue;
+
+  ShaderProgram::Uniform transform_uniform;
+  // Runs again whenever hot reload swaps the program in.
+  const auto prepare_program = [&]() {
+    transform_uniform = shader_program.uniform("transform");
+    // Instanced shapes are placed by their attributes alone.
+    if (instanced || !gpu_transform) {
+      shader_program.use();
+      shader_program.setUniformMatrix3x3(transform_uniform,
+                                         math::Mat3::identity().pointer());
+    }
+    state.invalidate();
+  };
+  prepare_program();
+
+  std::optional<ProgramReloader> reloader;
+  if (args.has("--hot-reload")) {
+    reloader.emplace(vertex_shader_path, fragment_shader_path);
+    logger::logInfo("Watching {} for shader changes")(SHADERS_PATH);
+  }
+
+  const auto profile_path = args.get("--profile");
+  render::Profiler profiler{render::Profiler::default_window,
+                            profile_path.has_value()};
+  const auto transform_zone = profiler.zone("transform");
+  const auto upload_zone = profiler.zone("upload");
+  const auto draw_zone = profiler.zone("draw");
+  const auto gpu_draw_zone =
+      profiler.zone("draw", render::Profiler::Kind::gpu);
+  const auto readback_zone = profiler.zone("readback");
+  const auto swap_zone = profiler.zone("swap");
+  const auto issued_zone =
+      profiler.zone("state issued", render::Profiler::Kind::count);
+  const auto skipped_zone =
+      profiler.zone("state skipped", render::Profiler::Kind::count);
+
+  const unsigned long max_frames = args.value("--frames", 0ul);
+  const double max_duration = args.value("--duration", 0.0);
+
+  scene::Shapes::Frame initial_frame;
+  shapes.update(0, initial_frame);
+  utils::Simulation<scene::Shapes::Frame> simulation{
+      std::move(initial_frame), args.value("--tick-rate", default_tick_rate),
+      [&shapes](scene::Shapes::Frame& frame, double step) {
+        shapes.update(step, frame);
+      }};
+  if (!headless) simulation.start();
+
+  unsigned long frames = 0;
+  double title_updated = 0;
+  const auto started = std::chrono::steady_clock::now();
   while (!glfwWindowShouldClose(window)) {
-    glClearColor(0.145f, 0.09f, 0.4f, 1.0f);
-    glClear(GL_COLOR_BUFFER_BIT);
+    if (reloader) {
+      const ProgramReloader::Status status = reloader->poll(shader_program);
+      if (status == ProgramReloader::Status::swapped) {
+        logger::logInfo("Shader program reloaded")();
+        prepare_program();
+      } else if (status == ProgramReloader::Status::failed) {
+        logger::logError("Shader reload failed, keeping the old program:\n{}")(
+            reloader->error());
+      }
+    }
+
+    const auto& snapshot = simulation.latest();
+    // Headless frames show each tick as is, so dumps are repeatable.
+    const float alpha = headless ? 1.f : simulation.alpha(snapshot);
+
+    // Attribute pointers below are vertex array state.
+    state.bindVertexArray(vertex_array_object);
+    const render::DrawQueue::Draw draw{
+        .program = shader_program.id(),
+        .vertex_array = vertex_array_object,
+        .count = static_cast<unsigned>(square.indices.size()),
+        .index_type = GL_UNSIGNED_SHORT,
+        .instances = instanced ? static_cast<unsigned>(shapes.size()) : 1};
+    const std::uint64_t key = render::DrawQueue::key(
+        {.program = draw.program, .vertex_array = draw.vertex_array});
 
-    const float x = static_cast<float>(glfwGetTime());
-    const float sinx = std::sin(x);
-    const float cosx = std::cos(x);
+    if (instanced) {
+      if (stream) {
+        const auto zone = profiler.scope(upload_zone);
+        const std::span<std::byte> region = stream->map();
+        scene::interpolate(
+            snapshot.previous, snapshot.current, alpha,
+            {reinterpret_cast<float*>(region.data()), shape_data.size()});
+        setShapeAttributes(stream->unmap(), shapes.size());
+        state.invalidate(GL_ARRAY_BUFFER);
+      } else {
+        {
+          const auto zone = profiler.scope(transform_zone);
+          scene::interpolate(snapshot.previous, snapshot.current, alpha,
+                             shape_data);
+        }
+        const auto zone = profiler.scope(upload_zone);
+        state.bindBuffer(GL_ARRAY_BUFFER, shape_buffer_object);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, shape_data.size() * sizeof(float),
+                        shape_data.data());
+      }
+      queue.submit(key, draw);
+    } else {
+      math::Mat3 transform;
+      math::Mat<square.vertices, 3> position;
+      {
+        const auto zone = profiler.scope(transform_zone);
+        transform =
+            squareTransform(snapshot.previous, snapshot.current, alpha);
+        if (!gpu_transform) position = vertices * transform;
+      }
 
-    const float scale_factor = std::fabs(sinx) + 0.25;
+      if (gpu_transform) {
+        queue.submit(key, draw,
+                     {{transform_uniform.location,
+                       render::DrawQueue::UniformType::matrix3x3,
+                       transform.pointer()}});
+      } else {
+        const auto zone = profiler.scope(upload_zone);
+        if (stream) {
+          std::memcpy(stream->map().data(), position.pointer(),
+                      items_number * sizeof(float));
+          const std::size_t offset = stream->unmap();
+          glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float),
+                                reinterpret_cast<const void*>(offset));
+          state.invalidate(GL_ARRAY_BUFFER);
+        } else {
+          state.bindBuffer(GL_ARRAY_BUFFER, vertex_buffer_object);
+          glBufferSubData(GL_ARRAY_BUFFER, 0, items_number * sizeof(float),
+                          position.pointer());
+        }
+        queue.submit(key, draw);
+      }
+    }
 
-    const float shift_x = cosx * (circle_radius - square_size * scale_factor);
-    const float shift_y = sinx * (circle_radius - square_size * scale_factor);
+    {
+      const auto zone = profiler.scope(draw_zone);
+      const auto gpu_zone = profiler.scope(gpu_draw_zone);
+      glClearColor(0.145f, 0.09f, 0.4f, 1.0f);
+      glClear(GL_COLOR_BUFFER_BIT);
+      queue.execute(state);
+    }
+    if (stream) stream->fence();
+    const render::StateCache::Counts state_counts = state.takeCounts();
+    profiler.count(issued_zone, state_counts.issued);
+    profiler.count(skipped_zone, state_counts.skipped);
 
-    const math::Matrix translate = math::Matrix::translate3x3(shift_x, shift_y);
-    const math::Matrix scale = math::Matrix::scale3x3(scale_factor);
-    const math::Matrix position = vertices * scale * translate;
+    if (reader) {
+      const auto zone = profiler.scope(readback_zone);
+      reader->read(frames);
+      reader->poll();
+    }
+    {
+      const auto zone = profiler.scope(swap_zone);
+      if (!headless) glfwSwapBuffers(window);
+      glfwPollEvents();
+    }
+    profiler.endFrame();
+    frames++;
+    if (headless) simulation.tick();
 
-    shader_program.use();
-    glBindVertexArray(vertex_array_object);
-    glBufferSubData(GL_ARRAY_BUFFER, 0, items_number * sizeof(float),
-                    position.pointer());
+    const std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - started;
+    if ((max_frames > 0 && frames >= max_frames) ||
+        (max_duration > 0 && elapsed.count() >= max_duration)) {
+      break;
+    }
 
-    glDrawArrays(GL_TRIANGLES, 0, 6);
+    const double now = glfwGetTime();
+    if (!headless && now - title_updated >= title_interval) {
+      title_updated = now;
+      const std::string caption = std::format("{} | ms min/mean/p50/p99: {}",
+                                              title, profiler.summary());
+      glfwSetWindowTitle(window, caption.c_str());
+    }
+  }
 
-    glfwSwapBuffers(window);
-    glfwPollEvents();
+  logger::logInfo("Frame timings, ms min/mean/p50/p99: {}")(
+      profiler.summary());
+  logger::logInfo("State changes per frame: {}")(profiler.counts());
+  if (heap::installed()) {
+    logger::logInfo("Heap per frame, allocations and bytes mean/max: {}")(
+        profiler.heapSummary());
+  }
+  if (profiler.missed() > 0) {
+    logger::logInfo("GPU timings not ready in time: {}")(profiler.missed());
+  }
+  if (stream) logger::logInfo("Stream buffer stalls: {}")(stream->stalls());
+  if (reader) {
+    reader->finish();
+    logger::logInfo("Dumped {} frames, readback stalls: {}")(
+        frames, reader->stalls());
+  }
+  if (profile_path) {
+    profiler.exportSamples(*profile_path);
+    logger::logInfo("Frame samples written to {}")(*profile_path);
   }
 }
 
 int main(const int argc, const char* argv[]) {
   try {
     logger::open(title);
+    utils::defer close_logger{logger::close};
     logger::logDebug("Start. Version {}.{}")(VERSION_MAJOR, VERSION_MINOR);
     utils::defer defer{logger::logDebug("Exit")};
 
     try {
-      start();
+      const utils::Args args{argc, argv};
+      start(args);
       return 0;
     } catch (const std::exception& exception) {
-      logger::logError(exception.what())();
+      logger::logError("{}")(exception.what());
     }
   } catch (const std::exception& exception) {
     std::cerr << exception.what() << '\n';
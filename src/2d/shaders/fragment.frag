@@ -1,7 +1,8 @@
 #version 330 core
 
+in vec3 shape_color;
 out vec4 fragColor;
 
 void main() {
-    fragColor = vec4(0.992f, 0.698f, 0.1f, 1.0f);
+    fragColor = vec4(shape_color, 1.0f);
 }
@@ -1,7 +1,16 @@
 #version 330 core
 
 layout (location = 0) in vec3 position;
+layout (location = 1) in float offset_x;
+layout (location = 2) in float offset_y;
+layout (location = 3) in float scale;
+layout (location = 4) in vec3 color;
+uniform mat3 transform;
+
+out vec3 shape_color;
 
 void main() {
-  gl_Position = vec4(position, 1);
+  vec3 placed = position * transform;
+  gl_Position = vec4(placed.xy * scale + vec2(offset_x, offset_y), placed.z, 1);
+  shape_color = color;
 }
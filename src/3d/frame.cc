@@ -0,0 +1,128 @@
+#include "frame.hh"
+
+#include <cmath>
+#include <cstddef>
+#include <memory_resource>
+#include <numbers>
+#include <span>
+#include <vector>
+
+#include <math/Frustum.hh>
+#include <math/Mat.hh>
+#include <math/Transform.hh>
+#include <math/trig.hh>
+#include <scene/Bvh.hh>
+#include <scene/Graph.hh>
+
+// The last two are expanded from one sincos. Colors do not need more than
+// the fast accuracy.
+math::Vec3 colorAt(const float x) {
+  const auto [sinx, cosx] = math::sincos(x, math::Accuracy::fast);
+  const float shifted = cosx * (std::numbers::sqrt3_v<float> / 2);
+  return math::Vec3{std::fabs(sinx), std::fabs(shifted - sinx / 2),
+                    std::fabs(-shifted - sinx / 2)};
+}
+
+Pose lerp(const Pose& from, const Pose& to, const float alpha) {
+  Pose result{std::lerp(from.angle, to.angle, alpha)};
+  for (unsigned i = 0; i < result.position.size(); i++) {
+    result.position[i] = std::lerp(from.position[i], to.position[i], alpha);
+  }
+  return result;
+}
+
+math::Mat4 placement(const Pose& pose) {
+  return math::rotate4x4(0, 1, 0, pose.angle) *
+         math::translate4x4(pose.position[0], pose.position[1],
+                            pose.position[2]);
+}
+
+float gridSpacing(const std::size_t count) {
+  return 2.f * grid_extent / std::ceil(std::sqrt(count));
+}
+
+void simulate(World& world, const bool instanced, const float time) {
+  world.time = time;
+  if (!instanced) {
+    const auto [sina, cosa] = math::sincos(time / 2 - fpi);
+    world.poses[0].angle = time;
+    world.poses[0].position = math::Vec3{
+        2 * cosa, 0, -(far_plane / 2) * sina - (far_plane / 2) - 3.5f};
+    return;
+  }
+
+  const unsigned side = std::ceil(std::sqrt(world.poses.size()));
+  const float spacing = gridSpacing(world.poses.size());
+  const float center = (side - 1) / 2.f;
+  for (unsigned i = 0; i < world.poses.size(); i++) {
+    const float angle = time + i * golden_angle;
+    const float column = i % side;
+    const float row = i / side;
+    world.poses[i].angle = angle;
+    world.poses[i].position =
+        math::Vec3{(column - center) * spacing, (row - center) * spacing,
+                   -grid_depth + 2.f * std::sin(angle / 2)};
+  }
+}
+
+void updateInstances(scene::Graph& graph, const scene::Graph::Node grid,
+                     std::span<Instance> instances,
+                     std::span<const Pose> previous,
+                     std::span<const Pose> current, const float alpha) {
+  const float scale = gridSpacing(instances.size()) * 0.4f;
+  for (unsigned i = 0; i < instances.size(); i++) {
+    const Pose pose = lerp(previous[i], current[i], alpha);
+    graph.setLocal(grid + 1 + i, {.translation = pose.position,
+                                  .rotation = math::axisAngle(0, 1, 0,
+                                                              pose.angle),
+                                  .scale = math::Vec3{scale, scale, scale}});
+    instances[i].color = colorAt(pose.angle);
+  }
+  graph.update();
+  for (unsigned i = 0; i < instances.size(); i++) {
+    instances[i].model = graph.world(grid + 1 + i);
+  }
+}
+
+math::Mat4 panningView(const float time) {
+  return math::translate4x4(-cull_pan * std::sin(time / 4), 0, 0);
+}
+
+Culler::Culler(const unsigned threads) {
+  if (threads > 1) jobs.emplace(threads);
+}
+
+void Culler::cull(std::span<const Instance> instances,
+                  const math::Mat4& view_projection,
+                  std::pmr::vector<Instance>& drawn) {
+  // Instances are scaled copies of a mesh that fits in [-1, 1].
+  const math::Aabb mesh_bounds{math::Vec3{low, low, low},
+                               math::Vec3{high, high, high}};
+  bounds.resize(instances.size());
+  for (unsigned i = 0; i < instances.size(); i++) {
+    bounds[i] = math::transform(mesh_bounds, instances[i].model);
+  }
+  if (bvh.size() != instances.size()) {
+    bvh.build(bounds);
+    built_cost = bvh.cost();
+    visible.reserve(instances.size());
+  } else {
+    bvh.refit(bounds);
+    if (bvh.cost() > rebuild_factor * built_cost) {
+      bvh.build(bounds);
+      built_cost = bvh.cost();
+      rebuild_count++;
+    }
+  }
+
+  visible.clear();
+  bvh.cull(math::Frustum{view_projection}, visible,
+           jobs ? &*jobs : nullptr);
+  drawn.clear();
+  drawn.reserve(visible.size());
+  for (const scene::Bvh::Object object : visible) {
+    drawn.push_back(instances[object]);
+  }
+}
+
+unsigned long Culler::rebuilds() const { return rebuild_count; }
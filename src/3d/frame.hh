@@ -0,0 +1,116 @@
+#pragma once
+
+// CPU work of a 3D demo frame: simulating the pyramids, placing them and
+// culling them. Nothing here touches GL, so tests can run frames without a
+// window.
+
+#include <cstddef>
+#include <memory_resource>
+#include <numbers>
+#include <optional>
+#include <span>
+#include <vector>
+
+#include <math/Frustum.hh>
+#include <math/Mat.hh>
+#include <mesh/Mesh.hh>
+#include <mesh/cache.hh>
+#include <scene/Bvh.hh>
+#include <scene/Graph.hh>
+#include <utils/jobs.hh>
+
+constexpr float fpi = std::numbers::pi_v<float>;
+
+constexpr float start_angle = fpi / 2;
+constexpr float low = -1;
+constexpr float high = 1;
+
+// Four distinct vertices; triangles are ordered for the vertex cache.
+inline constexpr auto pyramid =
+    mesh::optimized(mesh::pyramid<3>(1, low, high, start_angle));
+inline constexpr auto& vertices = pyramid.positions;
+
+// Per-instance attributes, laid out as they are read by the vertex shader.
+struct Instance {
+  math::Mat4 model;
+  math::Vec3 color;
+};
+
+static_assert(sizeof(Instance) == 19 * sizeof(float));
+
+constexpr float near_plane = 0.1f;
+constexpr float far_plane = 20.f;
+
+constexpr float grid_extent = 3.f;
+constexpr float grid_depth = 10.f;
+// With --cull the camera pans this far past either side of the grid, so
+// part of it leaves the view.
+constexpr float cull_pan = grid_extent * 1.5f;
+// Refitting loosens the tree as instances bob; it is rebuilt once its cost
+// grows this much over the cost right after building.
+constexpr float rebuild_factor = 1.5f;
+
+// pi * (3 - sqrt(5)): spreads instance phases evenly without repeating.
+constexpr float golden_angle = 2.39996323f;
+
+// |sin| of x, x + 2pi/3 and x + 4pi/3.
+math::Vec3 colorAt(float x);
+
+// Simulated placement of one pyramid; matrices are built when drawing.
+struct Pose {
+  float angle = 0;
+  math::Vec3 position;
+};
+
+Pose lerp(const Pose& from, const Pose& to, float alpha);
+
+// Model matrix of the single pyramid drawn without instancing.
+math::Mat4 placement(const Pose& pose);
+
+// Animation state advanced by the simulation thread.
+struct World {
+  float time = 0;
+  std::vector<Pose> poses;
+};
+
+float gridSpacing(std::size_t count);
+
+// Without instancing a single pyramid spins on an ellipse in depth. With
+// it the pyramids sit on a square grid facing the camera, and each one
+// spins and bobs in depth with its own phase.
+void simulate(World& world, bool instanced, float time);
+
+// Places every instance node at the pose `alpha` of the way between two
+// ticks and copies the resulting world matrices into the instance data.
+// Instance nodes follow `grid` in the graph.
+void updateInstances(scene::Graph& graph, scene::Graph::Node grid,
+                     std::span<Instance> instances,
+                     std::span<const Pose> previous,
+                     std::span<const Pose> current, float alpha);
+
+// View matrix of the camera panning across the grid when culling.
+math::Mat4 panningView(float time);
+
+// Picks the instances in view. Their boxes are kept in a scene::Bvh that is
+// refit every frame and rebuilt once it has loosened by rebuild_factor.
+// With more than one thread the tree is culled on a JobSystem of its own,
+// whose workers stay up between frames.
+class Culler {
+  std::optional<utils::JobSystem> jobs;
+  std::vector<math::Aabb> bounds;
+  scene::Bvh bvh;
+  float built_cost = 0;
+  unsigned long rebuild_count = 0;
+  std::vector<scene::Bvh::Object> visible;
+
+ public:
+  explicit Culler(unsigned threads = 1);
+
+  // Copies the instances that may be visible through `view_projection` to
+  // `drawn`, replacing its contents.
+  void cull(std::span<const Instance> instances,
+            const math::Mat4& view_projection,
+            std::pmr::vector<Instance>& drawn);
+
+  unsigned long rebuilds() const;
+};
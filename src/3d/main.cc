@@ -3,23 +3,49 @@
 #include <GLFW/glfw3.h>
 // clang-format on
 
+#include <algorithm>
+#include <chrono>
 #include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
 #include <exception>
 #include <filesystem>
+#include <format>
+#include <frame.hh>
+#include <heap/counters.hh>
 #include <iostream>
 #include <logger/core.hh>
-#include <math/Matrix.hh>
-#include <math/Vector.hh>
+#include <math/Mat.hh>
+#include <memory_resource>
+#include <mesh/File.hh>
 #include <numbers>
+#include <optional>
+#include <render/DrawQueue.hh>
+#include <render/FrameReader.hh>
+#include <render/Framebuffer.hh>
+#include <render/MeshStream.hh>
+#include <render/Profiler.hh>
+#include <render/StateCache.hh>
+#include <render/StreamBuffer.hh>
 #include <resources.hh>
+#include <scene/Graph.hh>
+#include <span>
+#include <shader/ProgramCache.hh>
+#include <shader/ProgramReloader.hh>
 #include <shader/Shader.hh>
 #include <shader/ShaderProgram.hh>
 #include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utils/args.hh>
 #include <utils/defer.hh>
+#include <utils/memory.hh>
+#include <utils/simulation.hh>
+#include <utility>
+#include <vector>
 #include <version.hh>
 
-constexpr float fpi = std::numbers::pi_v<float>;
-
 constexpr unsigned height = 800;
 constexpr unsigned width = 800;
 constexpr const char* title = "Shape movement 3D";
@@ -27,31 +53,60 @@ constexpr const char* title = "Shape movement 3D";
 constexpr const char* vertex_shader_path = SHADERS_PATH "/vertex.vert";
 constexpr const char* fragment_shader_path = SHADERS_PATH "/fragment.frag";
 
-constexpr float start_angle = fpi / 2;
-constexpr float low = -1;
-constexpr float high = 1;
-
-const math::Vector3 base1{std::cos(start_angle), low, std::sin(start_angle)};
-const math::Vector3 base2{std::cos(start_angle + 2.f * fpi / 3.f), low,
-                          std::sin(start_angle + 2 * fpi / 3.f)};
-const math::Vector3 base3{std::cos(start_angle - 2 * fpi / 3.f), low,
-                          std::sin(start_angle - 2 * fpi / 3.f)};
-const math::Vector3 top{(base1.x + base2.x + base3.x) / 3.f, high,
-                        (base1.z + base2.z + base3.z) / 3.f};
-
-const math::Matrix vertices{
-    {base1.x, base1.y, base1.z, 1}, {base2.x, base2.y, base2.z, 1},
-    {base3.x, base3.y, base3.z, 1},
-
-    {base1.x, base1.y, base1.z, 1}, {base3.x, base3.y, base3.z, 1},
-    {top.x, top.y, top.z, 1},
+// Seconds between refreshes of the timings shown in the title.
+constexpr double title_interval = 0.5;
+// Simulation ticks per second unless --tick-rate says otherwise. Headless
+// runs advance one tick per frame.
+constexpr double default_tick_rate = 60;
+
+constexpr unsigned color_location = 1;
+constexpr unsigned model_location = 2;
+
+// Maps the positions stored in a mesh into the [-1, 1] box the pyramid
+// fills, as p * scale + offset per axis. Quantized positions are first
+// spread back over the bounding box.
+struct MeshFit {
+  math::Vec3 scale{1, 1, 1};
+  math::Vec3 offset;
+};
 
-    {base3.x, base3.y, base3.z, 1}, {base2.x, base2.y, base2.z, 1},
-    {top.x, top.y, top.z, 1},
+MeshFit fitMesh(const mesh::File& file) {
+  const mesh::FileHeader& header = file.header();
+  float half_size = 0;
+  for (unsigned axis = 0; axis < 3; axis++) {
+    half_size = std::max(
+        half_size, (header.bounds_max[axis] - header.bounds_min[axis]) / 2);
+  }
+  if (half_size == 0) half_size = 1;
+  MeshFit result;
+  for (unsigned axis = 0; axis < 3; axis++) {
+    const float low = header.bounds_min[axis];
+    const float center = (low + header.bounds_max[axis]) / 2;
+    if (file.quantized()) {
+      result.scale[axis] = (header.bounds_max[axis] - low) / half_size;
+      result.offset[axis] = (low - center) / half_size;
+    } else {
+      result.scale[axis] = 1 / half_size;
+      result.offset[axis] = -center / half_size;
+    }
+  }
+  return result;
+}
 
-    {base2.x, base2.y, base2.z, 1}, {base1.x, base1.y, base1.z, 1},
-    {top.x, top.y, top.z, 1},
-};
+// Points the per-instance attributes at the buffer bound to GL_ARRAY_BUFFER,
+// starting `offset` bytes in.
+void setInstanceAttributes(const std::size_t offset) {
+  for (unsigned row = 0; row < 4; row++) {
+    const std::size_t row_offset =
+        offset + offsetof(Instance, model) + row * 4 * sizeof(float);
+    glVertexAttribPointer(model_location + row, 4, GL_FLOAT, GL_FALSE,
+                          sizeof(Instance),
+                          reinterpret_cast<const void*>(row_offset));
+  }
+  glVertexAttribPointer(
+      color_location, 3, GL_FLOAT, GL_FALSE, sizeof(Instance),
+      reinterpret_cast<const void*>(offset + offsetof(Instance, color)));
+}
 
 void onWindowSizeChanged(GLFWwindow* window, int width, int height) {
   logger::logDebug("Changed window size: {}x{}")(width, height);
@@ -66,7 +121,46 @@ void onKeyPress(GLFWwindow* window, int key, int scancode, int action,
   }
 }
 
-void start() {
+int contextApi(std::string_view name) {
+  if (name == "egl") return GLFW_EGL_CONTEXT_API;
+  if (name == "osmesa") return GLFW_OSMESA_CONTEXT_API;
+  throw std::runtime_error{"Unknown context API " + std::string{name}};
+}
+
+void start(const utils::Args& args) {
+  const unsigned instances_count = args.value("--instances", 0u);
+  const bool instanced = instances_count > 0;
+  // The mapping backs the model's uploads until they complete.
+  std::optional<mesh::File> model;
+  if (const auto mesh_path = args.get("--mesh")) {
+    model.emplace(std::filesystem::path{*mesh_path});
+    logger::logInfo("Drawing {} ({} vertices, {} triangles{})")(
+        *mesh_path, model->header().vertex_count,
+        model->header().index_count / 3,
+        model->quantized() ? ", quantized" : "");
+  }
+  // Instances and loaded models use one static mesh, so they are always
+  // transformed on the GPU.
+  const bool gpu_transform =
+      instanced || model || args.has("--gpu-transform");
+  logger::logInfo("Transforming vertices on the {}")(gpu_transform ? "GPU"
+                                                                  : "CPU");
+  if (instanced) logger::logInfo("Drawing {} instances")(instances_count);
+  const bool cull = instanced && args.has("--cull");
+  const unsigned cull_threads = args.value("--cull-threads", 1u);
+  if (cull) {
+    logger::logInfo("Culling instances on {} threads")(cull_threads);
+  }
+
+  const bool headless = args.has("--headless");
+  if (headless) {
+#ifdef GLFW_PLATFORM_NULL
+    glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_NULL);
+#else
+    throw std::runtime_error{"Headless mode requires GLFW 3.4"};
+#endif
+  }
+
   if (!glfwInit()) {
     throw std::runtime_error{"Cannot initiate glfw"};
   }
@@ -74,6 +168,11 @@ void start() {
   glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
   glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
   glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+  if (headless) {
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    glfwWindowHint(GLFW_CONTEXT_CREATION_API,
+                   contextApi(args.get("--context").value_or("egl")));
+  }
 
   utils::defer defer{glfwTerminate};
 
@@ -90,13 +189,36 @@ void start() {
     throw std::runtime_error{"Impossible to load OpenGL functions"};
   }
 
+  // The null platform has no default framebuffer to draw into.
+  std::optional<render::Framebuffer> offscreen;
+  if (headless) {
+    offscreen.emplace(width, height);
+    offscreen->bind();
+    logger::logInfo("Rendering offscreen, {}")(
+        reinterpret_cast<const char*>(glGetString(GL_RENDERER)));
+  }
+
+  std::optional<render::FrameReader> reader;
+  if (const auto dump_directory = args.get("--dump")) {
+    const std::filesystem::path directory{*dump_directory};
+    std::filesystem::create_directories(directory);
+    reader.emplace(width, height,
+                   [directory](const render::FrameReader::Frame& frame) {
+                     render::writePpm(
+                         directory / std::format("{:06}.ppm", frame.number),
+                         frame);
+                   });
+  }
+
   VertexShader vertex_shader{vertex_shader_path};
   FragmentShader fragment_shader{fragment_shader_path};
-  vertex_shader.compile();
-  fragment_shader.compile();
 
-  ShaderProgram shader_program{vertex_shader, fragment_shader};
-  shader_program.attach();
+  ProgramCache program_cache{args.get("--shader-cache").value_or("")};
+  ShaderProgram shader_program =
+      program_cache.build(vertex_shader, fragment_shader);
+  logger::logInfo("Shader program ready in {:.2f}ms, cache: {}")(
+      program_cache.lastTime().count(),
+      ProgramCache::statusName(program_cache.lastStatus()));
 
   unsigned vertex_array_object;
   glGenVertexArrays(1, &vertex_array_object);
@@ -106,64 +228,348 @@ void start() {
   unsigned vertex_buffer_object;
   glGenBuffers(1, &vertex_buffer_object);
   glBindBuffer(GL_ARRAY_BUFFER, vertex_buffer_object);
-  const unsigned items_number = vertices.getRows() * vertices.getCols();
-  glBufferData(GL_ARRAY_BUFFER, items_number * sizeof(float), nullptr,
-               GL_DYNAMIC_DRAW);
+  constexpr unsigned items_number = vertices.size();
+  // With the GPU transform the mesh never changes, so it is uploaded once.
+  glBufferData(GL_ARRAY_BUFFER, items_number * sizeof(float),
+               gpu_transform ? vertices.pointer() : nullptr,
+               gpu_transform ? GL_STATIC_DRAW : GL_DYNAMIC_DRAW);
   utils::defer defer_vbo{glDeleteBuffers, 1, &vertex_buffer_object};
 
   glVertexAttribPointer(0, vertices.getCols(), GL_FLOAT, GL_FALSE,
                         vertices.getCols() * sizeof(float), nullptr);
   glEnableVertexAttribArray(0);
 
+  // Bound with the vertex array, which keeps it for the draw calls.
+  unsigned element_buffer_object;
+  glGenBuffers(1, &element_buffer_object);
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, element_buffer_object);
+  glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(pyramid.indices),
+               pyramid.indices.data(), GL_STATIC_DRAW);
+  utils::defer defer_ebo{glDeleteBuffers, 1, &element_buffer_object};
+
+  // A loaded model takes the pyramid's place in the vertex array and is
+  // streamed in over the first frames.
+  std::optional<render::MeshStream> model_stream;
+  const MeshFit fit = model ? fitMesh(*model) : MeshFit{};
+  if (model) {
+    model_stream.emplace(*model,
+                         args.value("--mesh-chunk",
+                                    render::MeshStream::default_chunk_size));
+    model_stream->attach(0);
+  }
+
+  std::vector<Instance> instances(instances_count);
+  // The grid node places all instances at once; it stays at the origin.
+  scene::Graph graph;
+  const scene::Graph::Node grid = graph.add();
+  for (unsigned i = 0; i < instances_count; i++) graph.add({}, grid);
+  unsigned instance_buffer_object = 0;
+  if (instanced) {
+    glGenBuffers(1, &instance_buffer_object);
+    glBindBuffer(GL_ARRAY_BUFFER, instance_buffer_object);
+    glBufferData(GL_ARRAY_BUFFER, instances.size() * sizeof(Instance), nullptr,
+                 GL_STREAM_DRAW);
+
+    setInstanceAttributes(0);
+    for (unsigned row = 0; row < 4; row++) {
+      glEnableVertexAttribArray(model_location + row);
+      glVertexAttribDivisor(model_location + row, 1);
+    }
+    glEnableVertexAttribArray(color_location);
+    glVertexAttribDivisor(color_location, 1);
+  } else {
+    // Without instance arrays the shader reads constant attribute values.
+    const math::Mat4 identity = math::Mat4::identity();
+    for (unsigned row = 0; row < 4; row++) {
+      glVertexAttrib4f(model_location + row, identity(row, 0), identity(row, 1),
+                       identity(row, 2), identity(row, 3));
+    }
+  }
+  utils::defer defer_instances{glDeleteBuffers, 1, &instance_buffer_object};
+
+  Culler culler{cull_threads};
+  // Scratch memory of one frame, reset when the next one starts.
+  utils::Arena frame_arena;
+
   glBindVertexArray(0);
 
+  // Only instance data or CPU-transformed vertices change every frame.
+  std::optional<render::StreamBuffer> stream;
+  const auto strategy = args.get("--stream-buffer");
+  if (strategy && (instanced || !gpu_transform)) {
+    const std::size_t frame_size = instanced
+                                       ? instances.size() * sizeof(Instance)
+                                       : items_number * sizeof(float);
+    stream.emplace(GL_ARRAY_BUFFER, frame_size,
+                   render::StreamBuffer::parseStrategy(*strategy));
+    logger::logInfo("Streaming per-frame data through a {} buffer")(
+        render::StreamBuffer::strategyName(stream->getStrategy()));
+  }
+
+  // Frame state goes through the cache, and draws through the queue.
+  render::StateCache state;
+  render::DrawQueue queue;
+
+  ShaderProgram::Uniform transform_uniform;
+  // Runs again whenever hot reload swaps the program in.
+  const auto prepare_program = [&]() {
+    transform_uniform = shader_program.uniform("transform");
+    shader_program.use();
+    shader_program.setUniformVector3("mesh_scale", fit.scale[0], fit.scale[1],
+                                     fit.scale[2]);
+    shader_program.setUniformVector3("mesh_offset", fit.offset[0],
+                                     fit.offset[1], fit.offset[2]);
+    if (!gpu_transform) {
+      shader_program.setUniformMatrix4x4(transform_uniform,
+                                         math::Mat4::identity().pointer());
+    }
+    state.invalidate();
+  };
+  prepare_program();
+
+  std::optional<ProgramReloader> reloader;
+  if (args.has("--hot-reload")) {
+    reloader.emplace(vertex_shader_path, fragment_shader_path);
+    logger::logInfo("Watching {} for shader changes")(SHADERS_PATH);
+  }
+
   glEnable(GL_DEPTH_TEST);
   glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
-  while (!glfwWindowShouldClose(window)) {
-    glClearColor(0.145f, 0.09f, 0.4f, 1.0f);
-    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-    const float x = static_cast<float>(glfwGetTime());
+  const math::Mat4 projection = math::perspective(
+      std::numbers::pi / 4, static_cast<double>(width) / height, near_plane,
+      far_plane);
+
+  const auto profile_path = args.get("--profile");
+  render::Profiler profiler{render::Profiler::default_window,
+                            profile_path.has_value()};
+  const auto transform_zone = profiler.zone("transform");
+  const auto upload_zone = profiler.zone("upload");
+  const auto draw_zone = profiler.zone("draw");
+  const auto gpu_draw_zone =
+      profiler.zone("draw", render::Profiler::Kind::gpu);
+  const auto readback_zone = profiler.zone("readback");
+  const auto swap_zone = profiler.zone("swap");
+  const auto cull_zone = profiler.zone("cull");
+  const auto visible_zone =
+      profiler.zone("visible", render::Profiler::Kind::count);
+  const auto culled_zone =
+      profiler.zone("culled", render::Profiler::Kind::count);
+  const auto issued_zone =
+      profiler.zone("state issued", render::Profiler::Kind::count);
+  const auto skipped_zone =
+      profiler.zone("state skipped", render::Profiler::Kind::count);
+
+  const unsigned long max_frames = args.value("--frames", 0ul);
+  const double max_duration = args.value("--duration", 0.0);
+
+  World initial_world{0, std::vector<Pose>(std::max(instances_count, 1u))};
+  simulate(initial_world, instanced, 0);
+  utils::Simulation<World> simulation{
+      std::move(initial_world), args.value("--tick-rate", default_tick_rate),
+      [instanced](World& world, double step) {
+        simulate(world, instanced, world.time + step);
+      }};
+  if (!headless) simulation.start();
+
+  unsigned long frames = 0;
+  double title_updated = 0;
+  const auto started = std::chrono::steady_clock::now();
+  while (!glfwWindowShouldClose(window)) {
+    if (reloader) {
+      const ProgramReloader::Status status = reloader->poll(shader_program);
+      if (status == ProgramReloader::Status::swapped) {
+        logger::logInfo("Shader program reloaded")();
+        prepare_program();
+      } else if (status == ProgramReloader::Status::failed) {
+        logger::logError("Shader reload failed, keeping the old program:\n{}")(
+            reloader->error());
+      }
+    }
 
-    constexpr float max = 20.f, min = 0.1f;
+    frame_arena.reset();
+    const auto& snapshot = simulation.latest();
+    // Headless frames show each tick as is, so dumps are repeatable.
+    const float alpha = headless ? 1.f : simulation.alpha(snapshot);
 
-    const math::Matrix rotate = math::Matrix::rotate4x4(0, 1, 0, x);
-    const math::Matrix translate = math::Matrix::translate4x4(
-        2 * cos(x / 2 - fpi), 0,
-        -(max / 2) * sin(x / 2 - fpi) - (max / 2) - 3.5);
-    const math::Matrix projection = math::Matrix::perspective(
-        std::numbers::pi / 4, static_cast<double>(width) / height, min, max);
+    // Attribute pointers below are vertex array state.
+    state.bindVertexArray(vertex_array_object);
 
-    const math::Matrix position = vertices * rotate * translate * projection;
+    if (model_stream && !model_stream->complete()) {
+      const auto zone = profiler.scope(upload_zone);
+      if (model_stream->upload()) {
+        logger::logInfo("Model uploaded after {} frames")(frames + 1);
+      }
+    }
 
-    shader_program.use();
-    glBindVertexArray(vertex_array_object);
-    glBufferSubData(GL_ARRAY_BUFFER, 0, items_number * sizeof(float),
-                    position.pointer());
+    render::DrawQueue::Draw draw{
+        .program = shader_program.id(),
+        .vertex_array = vertex_array_object,
+        .count = model_stream ? model_stream->drawableIndices()
+                              : static_cast<unsigned>(pyramid.indices.size()),
+        .index_type =
+            model_stream ? model_stream->indexType() : GL_UNSIGNED_SHORT};
+    const std::uint64_t key = render::DrawQueue::key(
+        {.program = draw.program, .vertex_array = draw.vertex_array});
+
+    // Instances that reach the GPU, all of them unless culled.
+    std::span<const Instance> uploaded = instances;
+    std::pmr::vector<Instance> drawn{&frame_arena};
+    if (instanced) {
+      {
+        const auto zone = profiler.scope(transform_zone);
+        updateInstances(graph, grid, instances, snapshot.previous.poses,
+                        snapshot.current.poses, alpha);
+      }
+      math::Mat4 view_projection = projection;
+      if (cull) {
+        const auto zone = profiler.scope(cull_zone);
+        const float time = std::lerp(snapshot.previous.time,
+                                     snapshot.current.time, alpha);
+        view_projection = panningView(time) * projection;
+        culler.cull(instances, view_projection, drawn);
+        uploaded = drawn;
+        profiler.count(visible_zone, drawn.size());
+        profiler.count(culled_zone, instances.size() - drawn.size());
+      }
+      {
+        const auto zone = profiler.scope(upload_zone);
+        if (stream) {
+          std::memcpy(stream->map().data(), uploaded.data(),
+                      uploaded.size() * sizeof(Instance));
+          setInstanceAttributes(stream->unmap());
+          state.invalidate(GL_ARRAY_BUFFER);
+        } else {
+          state.bindBuffer(GL_ARRAY_BUFFER, instance_buffer_object);
+          glBufferSubData(GL_ARRAY_BUFFER, 0,
+                          uploaded.size() * sizeof(Instance), uploaded.data());
+        }
+      }
+      draw.instances = static_cast<unsigned>(uploaded.size());
+      queue.submit(key, draw,
+                   {{transform_uniform.location,
+                     render::DrawQueue::UniformType::matrix4x4,
+                     view_projection.pointer()}});
+    } else {
+      const Pose pose = lerp(snapshot.previous.poses[0],
+                             snapshot.current.poses[0], alpha);
+      math::Mat4 transform;
+      math::Mat<pyramid.vertices, 4> position;
+      {
+        const auto zone = profiler.scope(transform_zone);
+        transform = placement(pose) * projection;
+        if (!gpu_transform) position = vertices * transform;
+      }
+
+      if (gpu_transform) {
+        queue.submit(key, draw,
+                     {{transform_uniform.location,
+                       render::DrawQueue::UniformType::matrix4x4,
+                       transform.pointer()}});
+      } else {
+        const auto zone = profiler.scope(upload_zone);
+        if (stream) {
+          std::memcpy(stream->map().data(), position.pointer(),
+                      items_number * sizeof(float));
+          const std::size_t offset = stream->unmap();
+          glVertexAttribPointer(0, vertices.getCols(), GL_FLOAT, GL_FALSE,
+                                vertices.getCols() * sizeof(float),
+                                reinterpret_cast<const void*>(offset));
+          state.invalidate(GL_ARRAY_BUFFER);
+        } else {
+          state.bindBuffer(GL_ARRAY_BUFFER, vertex_buffer_object);
+          glBufferSubData(GL_ARRAY_BUFFER, 0, items_number * sizeof(float),
+                          position.pointer());
+        }
+        queue.submit(key, draw);
+      }
+
+      const math::Vec3 color = colorAt(pose.angle);
+      glVertexAttrib3f(color_location, color[0], color[1], color[2]);
+    }
 
-    float r = std::fabs(std::sin(x));
-    float g = std::fabs(std::sin(x + 2.0f * fpi / 3.0f));
-    float b = std::fabs(std::sin(x + 4.0f * fpi / 3.0f));
-    shader_program.setUniformVector3("color", r, g, b);
+    {
+      const auto zone = profiler.scope(draw_zone);
+      const auto gpu_zone = profiler.scope(gpu_draw_zone);
+      glClearColor(0.145f, 0.09f, 0.4f, 1.0f);
+      glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+      queue.execute(state);
+    }
+    if (stream) stream->fence();
+    const render::StateCache::Counts state_counts = state.takeCounts();
+    profiler.count(issued_zone, state_counts.issued);
+    profiler.count(skipped_zone, state_counts.skipped);
+
+    if (reader) {
+      const auto zone = profiler.scope(readback_zone);
+      reader->read(frames);
+      reader->poll();
+    }
+    {
+      const auto zone = profiler.scope(swap_zone);
+      if (!headless) glfwSwapBuffers(window);
+      glfwPollEvents();
+    }
+    profiler.endFrame();
+    frames++;
+    if (headless) simulation.tick();
+
+    const std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - started;
+    if ((max_frames > 0 && frames >= max_frames) ||
+        (max_duration > 0 && elapsed.count() >= max_duration)) {
+      break;
+    }
 
-    glDrawArrays(GL_TRIANGLES, 0, vertices.getRows());
+    const double now = glfwGetTime();
+    if (!headless && now - title_updated >= title_interval) {
+      title_updated = now;
+      const std::string caption = std::format("{} | ms min/mean/p50/p99: {}",
+                                              title, profiler.summary());
+      glfwSetWindowTitle(window, caption.c_str());
+    }
+  }
 
-    glfwSwapBuffers(window);
-    glfwPollEvents();
+  const std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - started;
+  logger::logInfo("Rendered {} frames in {:.2f}s ({:.1f} fps)")(
+      frames, elapsed.count(), frames / elapsed.count());
+  logger::logInfo("Frame timings, ms min/mean/p50/p99: {}")(
+      profiler.summary());
+  logger::logInfo("Counts per frame: {}")(profiler.counts());
+  if (cull) logger::logInfo("Tree rebuilds: {}")(culler.rebuilds());
+  if (heap::installed()) {
+    logger::logInfo("Heap per frame, allocations and bytes mean/max: {}")(
+        profiler.heapSummary());
+  }
+  if (profiler.missed() > 0) {
+    logger::logInfo("GPU timings not ready in time: {}")(profiler.missed());
+  }
+  if (stream) logger::logInfo("Stream buffer stalls: {}")(stream->stalls());
+  if (reader) {
+    reader->finish();
+    logger::logInfo("Dumped {} frames, readback stalls: {}")(
+        frames, reader->stalls());
+  }
+  if (profile_path) {
+    profiler.exportSamples(*profile_path);
+    logger::logInfo("Frame samples written to {}")(*profile_path);
   }
 }
 
 int main(const int argc, const char* argv[]) {
   try {
     logger::open(title);
+    utils::defer close_logger{logger::close};
     logger::logDebug("Start. Version {}.{}")(VERSION_MAJOR, VERSION_MINOR);
     utils::defer defer{logger::logDebug("Exit")};
 
     try {
-      start();
+      const utils::Args args{argc, argv};
+      start(args);
       return 0;
     } catch (const std::exception& exception) {
-      logger::logError(exception.what())();
+      logger::logError("{}")(exception.what());
     }
   } catch (const std::exception& exception) {
     std::cerr << exception.what() << '\n';
@@ -1,11 +1,20 @@
 #version 330 core
 
 layout (location = 0) in vec4 position;
-uniform vec3 color;
+layout (location = 1) in vec3 color;
+// Rows of the row-major model matrix arrive as columns, so the GLSL matrix is
+// its transpose and multiplies the position from the left.
+layout (location = 2) in mat4 model;
+uniform mat4 transform;
+// Per-axis scale and offset that bring stored mesh positions, possibly
+// quantized to [0, 1], into the box the scene is laid out for.
+uniform vec3 mesh_scale;
+uniform vec3 mesh_offset;
 
 out vec3 fargmentColor;
 
 void main() {
-  gl_Position = position;
+  vec4 local = vec4(position.xyz * mesh_scale + mesh_offset, position.w);
+  gl_Position = (model * local) * transform;
   fargmentColor = color;
 }
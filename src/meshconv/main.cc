@@ -0,0 +1,73 @@
+#include <chrono>
+#include <cstdint>
+#include <exception>
+#include <filesystem>
+#include <iostream>
+#include <logger/core.hh>
+#include <mesh/File.hh>
+#include <mesh/Mesh.hh>
+#include <mesh/cache.hh>
+#include <mesh/obj.hh>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <utils/args.hh>
+#include <utils/defer.hh>
+#include <utils/fs.hh>
+#include <version.hh>
+
+constexpr const char* title = "meshconv";
+
+// Converts a Wavefront OBJ model into the binary mesh format read by
+// mesh::File, with its triangles in vertex cache order.
+void convert(const utils::Args& args) {
+  const auto input = args.get("--input");
+  const auto output = args.get("--output");
+  if (!input || !output) {
+    throw std::runtime_error{
+        "Usage: meshconv --input MODEL.obj --output MODEL.mesh [--quantize] "
+        "[--no-optimize]"};
+  }
+
+  const auto started = std::chrono::steady_clock::now();
+  const utils::MappedFile source{std::filesystem::path{*input}};
+  mesh::Geometry geometry = mesh::parseObj(source.text());
+  logger::logInfo("Read {} vertices and {} triangles from {}")(
+      geometry.vertices(), geometry.triangles(), *input);
+
+  if (!args.has("--no-optimize")) {
+    const std::span<const std::uint32_t> indices{geometry.indices};
+    const float before = mesh::acmr(indices);
+    mesh::optimizeVertexCache(std::span<std::uint32_t>{geometry.indices},
+                              geometry.vertices());
+    logger::logInfo("Vertex cache misses per triangle: {:.3f} -> {:.3f}")(
+        before, mesh::acmr(indices));
+  }
+
+  const bool quantize = args.has("--quantize");
+  mesh::writeFile(std::filesystem::path{*output}, geometry, quantize);
+  const std::chrono::duration<double, std::milli> elapsed =
+      std::chrono::steady_clock::now() - started;
+  logger::logInfo("Wrote {} ({} bytes, {}) in {:.1f}ms")(
+      *output, std::filesystem::file_size(*output),
+      quantize ? "quantized" : "float", elapsed.count());
+}
+
+int main(const int argc, const char* argv[]) {
+  try {
+    logger::open(title);
+    utils::defer close_logger{logger::close};
+    logger::logDebug("Start. Version {}.{}")(VERSION_MAJOR, VERSION_MINOR);
+
+    try {
+      const utils::Args args{argc, argv};
+      convert(args);
+      return 0;
+    } catch (const std::exception& exception) {
+      logger::logError("{}")(exception.what());
+    }
+  } catch (const std::exception& exception) {
+    std::cerr << exception.what() << '\n';
+  }
+  return 1;
+}
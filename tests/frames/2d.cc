@@ -0,0 +1,59 @@
+#include <assert.h>
+
+#include <cstdio>
+#include <frame.hh>
+#include <heap/counters.hh>
+#include <math/Mat.hh>
+#include <scene/Shapes.hh>
+#include <utility>
+#include <utils/simulation.hh>
+#include <vector>
+
+constexpr double tick_rate = 60;
+constexpr unsigned frame_count = 300;
+// Frames that may still fill buffers, e.g. the simulation's snapshots.
+constexpr unsigned warmup_frames = 3;
+
+// Runs the CPU side of the demo's frames the way --headless does, one tick
+// per frame, and reports the first frame after the warm-up that allocates.
+bool steady(const unsigned count) {
+  scene::Shapes shapes = makeShapes(count);
+  std::vector<float> shape_data(3 * shapes.size());
+  scene::Shapes::Frame initial_frame;
+  shapes.update(0, initial_frame);
+  utils::Simulation<scene::Shapes::Frame> simulation{
+      std::move(initial_frame), tick_rate,
+      [&shapes](scene::Shapes::Frame& frame, double step) {
+        shapes.update(step, frame);
+      }};
+
+  for (unsigned frame = 0; frame < frame_count; frame++) {
+    const heap::Counters before = heap::thread();
+    const auto& snapshot = simulation.latest();
+    if (count > 1) {
+      scene::interpolate(snapshot.previous, snapshot.current, 1, shape_data);
+    } else {
+      const math::Mat3 transform =
+          squareTransform(snapshot.previous, snapshot.current, 1);
+      const math::Mat<square.vertices, 3> position = vertices * transform;
+      assert(position(0, 2) == 1);
+    }
+    simulation.tick();
+
+    const heap::Counters used = heap::thread() - before;
+    if (frame >= warmup_frames && used.allocations > 0) {
+      std::fprintf(stderr, "%u shapes: frame %u made %llu allocations\n",
+                   count, frame,
+                   static_cast<unsigned long long>(used.allocations));
+      return false;
+    }
+  }
+  return true;
+}
+
+int main(const int argc, const char* argv[]) {
+  assert(heap::installed());
+  bool passed = true;
+  for (const unsigned count : {1u, 1000u, 100000u}) passed &= steady(count);
+  return passed ? 0 : 1;
+}
@@ -0,0 +1,98 @@
+#include <assert.h>
+
+#include <cstdio>
+#include <frame.hh>
+#include <heap/counters.hh>
+#include <math/Mat.hh>
+#include <memory_resource>
+#include <numbers>
+#include <span>
+#include <utility>
+#include <utils/memory.hh>
+#include <utils/simulation.hh>
+#include <vector>
+
+constexpr double tick_rate = 60;
+// Frames that may still fill buffers, e.g. the simulation's snapshots.
+constexpr unsigned warmup_frames = 3;
+constexpr unsigned frame_count = warmup_frames + 40;
+
+struct Options {
+  unsigned instances = 0;
+  bool cull = false;
+  // Culling threads; only the allocations of this thread are counted.
+  unsigned threads = 1;
+};
+
+// Runs the CPU side of the demo's frames the way --headless does, one tick
+// per frame, and reports the first frame after the warm-up that allocates.
+bool steady(const Options& options) {
+  const bool instanced = options.instances > 0;
+  std::vector<Instance> instances(options.instances);
+  scene::Graph graph;
+  const scene::Graph::Node grid = graph.add();
+  for (unsigned i = 0; i < options.instances; i++) graph.add({}, grid);
+  Culler culler{options.threads};
+  utils::Arena frame_arena;
+  const math::Mat4 projection =
+      math::perspective(std::numbers::pi_v<float> / 4, 1, near_plane,
+                        far_plane);
+
+  World initial_world{0, std::vector<Pose>(std::max(options.instances, 1u))};
+  simulate(initial_world, instanced, 0);
+  utils::Simulation<World> simulation{
+      std::move(initial_world), tick_rate,
+      [instanced](World& world, double step) {
+        simulate(world, instanced, world.time + step);
+      }};
+
+  std::size_t drawn_total = 0;
+  for (unsigned frame = 0; frame < frame_count; frame++) {
+    const heap::Counters before = heap::thread();
+    frame_arena.reset();
+    const auto& snapshot = simulation.latest();
+    if (instanced) {
+      updateInstances(graph, grid, instances, snapshot.previous.poses,
+                      snapshot.current.poses, 1);
+      if (options.cull) {
+        std::pmr::vector<Instance> drawn{&frame_arena};
+        culler.cull(instances,
+                    panningView(snapshot.current.time) * projection, drawn);
+        drawn_total += drawn.size();
+      }
+    } else {
+      const math::Mat4 transform =
+          placement(snapshot.current.poses[0]) * projection;
+      const math::Mat<pyramid.vertices, 4> position = vertices * transform;
+      assert(position(0, 3) != 0);
+    }
+    simulation.tick();
+
+    const heap::Counters used = heap::thread() - before;
+    if (frame >= warmup_frames && used.allocations > 0) {
+      std::fprintf(stderr,
+                   "%u instances%s, %u threads: frame %u made %llu "
+                   "allocations\n",
+                   options.instances, options.cull ? ", culled" : "",
+                   options.threads, frame,
+                   static_cast<unsigned long long>(used.allocations));
+      return false;
+    }
+  }
+  if (options.cull) {
+    // Part of the grid lies outside the view.
+    assert(drawn_total > 0 && drawn_total < frame_count * options.instances);
+  }
+  return true;
+}
+
+int main(const int argc, const char* argv[]) {
+  assert(heap::installed());
+  bool passed = true;
+  for (const Options options :
+       {Options{}, Options{2000}, Options{2000, true},
+        Options{2000, true, 4}}) {
+    passed &= steady(options);
+  }
+  return passed ? 0 : 1;
+}
@@ -0,0 +1,45 @@
+#include <assert.h>
+
+#include <cstddef>
+#include <heap/counters.hh>
+#include <memory>
+#include <new>
+#include <thread>
+#include <vector>
+
+int main(const int argc, const char* argv[]) {
+  assert(heap::installed());
+
+  const heap::Counters start = heap::thread();
+  {
+    std::vector<int> numbers(1000);
+    const heap::Counters used = heap::thread() - start;
+    assert(used.allocations == 1 && used.deallocations == 0);
+    assert(used.allocated_bytes >= numbers.size() * sizeof(int));
+  }
+  heap::Counters used = heap::thread() - start;
+  assert(used.deallocations == 1 && used.freed_bytes == used.allocated_bytes);
+
+  // Array, nothrow and aligned forms go through the replaced operators.
+  // Called directly, since new expressions may be optimized out.
+  ::operator delete[](::operator new[](40));
+  ::operator delete(::operator new(100, std::nothrow), std::nothrow);
+  struct alignas(64) Line {
+    char bytes[64];
+  };
+  const auto line = std::make_unique<Line>();
+  assert(reinterpret_cast<std::size_t>(line.get()) % 64 == 0);
+  used = heap::thread() - start;
+  assert(used.allocations == 4 && used.deallocations == 3);
+
+  // Other threads count toward the process only.
+  const heap::Counters process = heap::process();
+  const heap::Counters before = heap::thread();
+  std::thread{[] { std::vector<int> numbers(100); }}.join();
+  const heap::Counters own = heap::thread() - before;
+  const heap::Counters all = heap::process() - process;
+  assert(all.allocations > own.allocations);
+
+  assert(heap::peakRss() > 0);
+  return 0;
+}
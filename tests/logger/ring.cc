@@ -0,0 +1,192 @@
+#include <assert.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <logger/core.hh>
+#include <logger/ring.hh>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+// Collects what the logger writes to stderr through a pipe, which nothing
+// reads before start(): until then a full pipe stalls the logger's thread.
+class Capture {
+  int saved;
+  int ends[2];
+  std::thread reader;
+  std::string text;
+
+ public:
+  Capture() {
+    const int created = pipe(ends);
+    assert(created == 0);
+    saved = dup(STDERR_FILENO);
+    dup2(ends[1], STDERR_FILENO);
+  }
+
+  void start() {
+    reader = std::thread{[this] {
+      char buffer[4096];
+      ssize_t size;
+      while ((size = read(ends[0], buffer, sizeof(buffer))) > 0) {
+        text.append(buffer, size);
+      }
+    }};
+  }
+
+  // Restores stderr and returns the lines written since construction.
+  std::vector<std::string> finish() {
+    dup2(saved, STDERR_FILENO);
+    ::close(saved);
+    ::close(ends[1]);
+    if (!reader.joinable()) start();
+    reader.join();
+    ::close(ends[0]);
+    std::vector<std::string> lines;
+    std::size_t begin = 0;
+    for (std::size_t end; (end = text.find('\n', begin)) != text.npos;
+         begin = end + 1) {
+      lines.push_back(text.substr(begin, end - begin));
+    }
+    return lines;
+  }
+};
+
+std::size_t countContaining(const std::vector<std::string>& lines,
+                            std::string_view text) {
+  return std::count_if(lines.begin(), lines.end(),
+                       [&](const std::string& line) {
+                         return line.find(text) != line.npos;
+                       });
+}
+
+void testRing() {
+  logger::detail::Ring<int, 4> ring;
+  assert(ring.front() == nullptr);
+  for (int i = 0; i < 4; i++) {
+    const auto claimed = ring.claim();
+    assert(claimed && claimed->position == static_cast<std::size_t>(i));
+    *claimed->item = i;
+    // Published out of order, consumed in claim order.
+    if (i != 1) ring.publish(claimed->position);
+  }
+  assert(!ring.claim() && "A full ring refuses claims");
+  assert(*ring.front() == 0);
+  ring.pop();
+  assert(ring.front() == nullptr && "An unpublished slot holds back the rest");
+  ring.publish(1);
+  for (int i = 1; i < 4; i++) {
+    assert(*ring.front() == i);
+    ring.pop();
+  }
+  assert(ring.front() == nullptr && ring.claim());
+}
+
+// Every item sent by several producers arrives exactly once, in each
+// producer's order.
+void testProducers() {
+  constexpr unsigned producer_count = 4;
+  constexpr std::uint32_t per_producer = 100000;
+  logger::detail::Ring<std::uint64_t, 64> ring;
+  std::vector<std::uint32_t> next(producer_count, 0);
+  {
+    std::vector<std::jthread> producers;
+    for (std::uint64_t producer = 0; producer < producer_count; producer++) {
+      producers.emplace_back([&ring, producer] {
+        for (std::uint32_t i = 0; i < per_producer; i++) {
+          auto claimed = ring.claim();
+          while (!claimed) {
+            std::this_thread::yield();
+            claimed = ring.claim();
+          }
+          *claimed->item = producer << 32 | i;
+          ring.publish(claimed->position);
+        }
+      });
+    }
+    for (std::uint32_t left = producer_count * per_producer; left > 0;) {
+      const std::uint64_t* item = ring.front();
+      if (item == nullptr) {
+        std::this_thread::yield();
+        continue;
+      }
+      const std::uint32_t producer = *item >> 32;
+      assert(producer < producer_count &&
+             (*item & 0xffffffff) == next[producer]);
+      next[producer]++;
+      ring.pop();
+      left--;
+    }
+  }
+  assert(std::all_of(next.begin(), next.end(), [](std::uint32_t count) {
+    return count == per_producer;
+  }));
+  assert(ring.front() == nullptr);
+}
+
+// With the logger's thread stalled on a full stderr, the ring fills up and
+// the rest is dropped; close() writes everything that was queued.
+void testDropped() {
+  constexpr unsigned sent = 5000;
+  Capture capture;
+  logger::open("logger_ring_test");
+  logger::setOverflow(logger::Overflow::drop);
+  const std::uint64_t dropped_before = logger::dropped();
+  for (unsigned i = 0; i < sent; i++) logger::logInfo("flood {}")(i);
+  capture.start();
+  logger::close();
+  const std::uint64_t dropped = logger::dropped() - dropped_before;
+  const std::size_t written = countContaining(capture.finish(), "flood ");
+  assert(dropped > 0 && "The pipe and the ring cannot hold every message");
+  assert(written + dropped == sent && "Every message is written or counted");
+}
+
+// Blocked producers wait for room instead, so every message is written once.
+void testBlocked() {
+  constexpr unsigned producer_count = 4;
+  constexpr unsigned per_producer = 500;
+  Capture capture;
+  capture.start();
+  logger::open("logger_ring_test");
+  logger::setOverflow(logger::Overflow::block);
+  const std::uint64_t dropped_before = logger::dropped();
+  {
+    std::vector<std::jthread> producers;
+    for (unsigned producer = 0; producer < producer_count; producer++) {
+      producers.emplace_back([producer] {
+        for (unsigned i = 0; i < per_producer; i++) {
+          logger::logInfo("block {} {}")(producer, i);
+        }
+      });
+    }
+  }
+  // Format specs are checked by the logger's thread, which reports them.
+  logger::logInfo("bad {:d}")(std::string{"spec"});
+  logger::close();
+  assert(logger::dropped() == dropped_before);
+
+  const std::vector<std::string> lines = capture.finish();
+  std::vector<unsigned> seen(producer_count * per_producer, 0);
+  for (const std::string& line : lines) {
+    const std::size_t start = line.find("block ");
+    if (start == line.npos) continue;
+    unsigned producer = producer_count, i = 0;
+    std::sscanf(line.c_str() + start, "block %u %u", &producer, &i);
+    assert(producer < producer_count && i < per_producer);
+    seen[producer * per_producer + i]++;
+  }
+  assert(std::all_of(seen.begin(), seen.end(),
+                     [](unsigned count) { return count == 1; }));
+  assert(countContaining(lines, "bad {:d} (") == 1);
+}
+
+int main(const int argc, const char* argv[]) {
+  testRing();
+  testProducers();
+  testDropped();
+  testBlocked();
+  return 0;
+}
@@ -0,0 +1,55 @@
+#include <assert.h>
+
+#include <cstddef>
+#include <heap/counters.hh>
+#include <math/Mat.hh>
+#include <math/Matrix.hh>
+#include <memory_resource>
+#include <utils/memory.hh>
+
+// The transforms of one frame of the 3D demo, all from `arena`.
+math::Matrix frame(const math::Matrix& vertices, float time,
+                   utils::Arena& arena) {
+  const math::Matrix rotate = math::Matrix::rotate4x4(0, 1, 0, time, &arena);
+  const math::Matrix translate =
+      math::Matrix::translate4x4(0, 0, -5 - time, &arena);
+  const math::Matrix projection =
+      math::Matrix::perspective(0.8f, 1, 0.1f, 20, &arena);
+  return {vertices * rotate * translate * projection, &arena};
+}
+
+int main(const int argc, const char* argv[]) {
+  assert(heap::installed());
+  const math::Matrix vertices{
+      {0, 1, 0, 1}, {-1, -1, 1, 1}, {1, -1, 1, 1}, {0, -1, -1, 1}};
+  utils::Arena arena;
+  frame(vertices, 0, arena);
+  arena.reset();
+
+  const heap::Counters before = heap::thread();
+  for (unsigned i = 1; i <= 100; i++) {
+    const float time = i / 60.f;
+    const math::Matrix result = frame(vertices, time, arena);
+    assert(result.get_allocator().resource() == &arena);
+
+    const math::Mat<4, 4> expected =
+        vertices.toMat<4, 4>() * math::rotate4x4(0, 1, 0, time) *
+        math::translate4x4(0, 0, -5 - time) *
+        math::perspective(0.8f, 1, 0.1f, 20);
+    const math::Mat<4, 4> computed = result.toMat<4, 4>();
+    for (unsigned j = 0; j < 16; j++) {
+      const float difference = computed.pointer()[j] - expected.pointer()[j];
+      assert(difference < 1e-4f && difference > -1e-4f);
+    }
+    arena.reset();
+  }
+  assert((heap::thread() - before).allocations == 0 &&
+         "A steady frame makes no heap allocations");
+
+  // Without an allocator, storage still comes from the default resource.
+  const math::Matrix product = vertices * vertices;
+  assert((heap::thread() - before).allocations > 0);
+  assert(product.get_allocator().resource() ==
+         std::pmr::get_default_resource());
+  return 0;
+}
@@ -0,0 +1,75 @@
+#include <assert.h>
+
+#include <cmath>
+#include <cstddef>
+#include <math/Matrix.hh>
+#include <stdexcept>
+#include <type_traits>
+
+// Chains hold their factors by reference, so only temporaries may convert.
+static_assert(!std::is_copy_constructible_v<math::Chain<2>>);
+static_assert(!std::is_constructible_v<math::Matrix, math::Chain<2>&>);
+static_assert(std::is_constructible_v<math::Matrix, math::Chain<2>&&>);
+
+// Left-to-right evaluation, one temporary per product.
+math::Matrix eager(const math::Matrix& a, const math::Matrix& b) {
+  return a * b;
+}
+
+bool near(const math::Matrix& left, const math::Matrix& right) {
+  if (left.getRows() != right.getRows() || left.getCols() != right.getCols()) {
+    return false;
+  }
+  for (unsigned i = 0; i < left.getRows() * left.getCols(); i++) {
+    const float difference = left.pointer()[i] - right.pointer()[i];
+    if (std::fabs(difference) > 1e-4f * (1 + std::fabs(right.pointer()[i]))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+int main(const int argc, const char* argv[]) {
+  const math::Matrix vertices{
+      {1, 2, 3, 1}, {-1, 0, 2, 1}, {0.5f, -2, 1, 1}, {4, 1, -3, 1},
+      {2, 2, 2, 1}, {-3, 1, 0, 1}, {1, -1, 1, 1},    {0, 0, -5, 1},
+      {3, 0, 1, 1}, {-2, 4, 2, 1}, {1, 1, 1, 1},     {0, 2, -1, 1},
+  };
+  const math::Matrix rotate = math::Matrix::rotate4x4y(0.7f);
+  const math::Matrix translate = math::Matrix::translate4x4(1, -2, -5);
+  const math::Matrix projection =
+      math::Matrix::perspective(1.2f, 1.5f, 0.1f, 100.f);
+
+  const math::Matrix expected =
+      eager(eager(eager(vertices, rotate), translate), projection);
+  const math::Matrix chained = vertices * rotate * translate * projection;
+  assert(near(chained, expected) && "Chain result differs from eager one");
+
+  // The transforms are folded first: 2 * 4*4*4, then 12*4*4 once instead
+  // of three passes of 12*4*4 over the vertices.
+  assert((vertices * rotate * translate * projection).cost() == 320);
+  assert((rotate * translate * projection).cost() == 128);
+
+  // Explicit grouping still works by evaluating the inner chain first.
+  const math::Matrix grouped = vertices * (rotate * translate * projection);
+  assert(near(grouped, expected));
+
+  // Ordering chooses the narrow side: (column * row) * column would build a
+  // 4x4 first, column * (row * column) only a 1x1.
+  const math::Matrix column{{1}, {2}, {3}, {4}};
+  const math::Matrix row{{1, 0, -1, 2}};
+  assert((column * row * column).cost() == 8);
+  const math::Matrix outer = column * row * column;
+  assert(outer.getRows() == 4 && outer.getCols() == 1 &&
+         outer.pointer()[3] == 4 * 6);
+
+  bool thrown = false;
+  try {
+    const math::Matrix invalid = rotate * column * row * vertices;
+  } catch (const std::runtime_error&) {
+    thrown = true;
+  }
+  assert(thrown && "Mismatched chains must throw");
+
+  return 0;
+}
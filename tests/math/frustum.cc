@@ -0,0 +1,102 @@
+#include <assert.h>
+
+#include <cmath>
+#include <cstdint>
+#include <math/Frustum.hh>
+#include <math/Mat.hh>
+#include <math/simd.hh>
+#include <numbers>
+#include <random>
+#include <vector>
+
+constexpr float fov = std::numbers::pi_v<float> / 2;
+constexpr float near = 1;
+constexpr float far = 10;
+
+math::Aabb box(float x, float y, float z, float half_size) {
+  return {math::Vec3{x - half_size, y - half_size, z - half_size},
+          math::Vec3{x + half_size, y + half_size, z + half_size}};
+}
+
+// What culling must match: a point is visible when its clip coordinates lie
+// in the clip cube.
+bool clipped(const math::Mat4& view_projection, float x, float y, float z) {
+  const math::Vec4 clip = math::Vec4{x, y, z, 1} * view_projection;
+  const float w = clip[3];
+  return std::fabs(clip[0]) > w || std::fabs(clip[1]) > w ||
+         std::fabs(clip[2]) > w;
+}
+
+int main(const int argc, const char* argv[]) {
+  // A 90 degree view down -z: the side planes are the diagonals x = +-z and
+  // y = +-z.
+  const math::Mat4 projection = math::perspective(fov, 1, near, far);
+  const math::Frustum frustum{projection};
+  const math::Vec4& left = frustum.plane(math::Frustum::left);
+  assert(std::fabs(left[0] - std::sqrt(0.5f)) < 1e-6f);
+  assert(std::fabs(left[2] + std::sqrt(0.5f)) < 1e-6f);
+  assert(std::fabs(left[3]) < 1e-6f);
+  const math::Vec4& near_plane = frustum.plane(math::Frustum::near);
+  assert(std::fabs(near_plane[2] + 1) < 1e-6f);
+  assert(std::fabs(near_plane[3] + near) < 1e-5f);
+  const math::Vec4& far_plane = frustum.plane(math::Frustum::far);
+  assert(std::fabs(far_plane[3] - far) < 1e-4f);
+
+  assert(frustum.intersects(math::Sphere{math::Vec3{0, 0, -5}, 0.1f}));
+  assert(!frustum.intersects(math::Sphere{math::Vec3{0, 0, 5}, 1}));
+  assert(!frustum.intersects(math::Sphere{math::Vec3{0, 0, -12}, 1}));
+  assert(frustum.intersects(math::Sphere{math::Vec3{0, 0, -10.5f}, 1}));
+  assert(!frustum.intersects(math::Sphere{math::Vec3{-7, 0, -5}, 1}));
+  assert(frustum.intersects(math::Sphere{math::Vec3{-5.5f, 0, -5}, 1}));
+
+  assert(frustum.contains(box(0, 0, -5, 1)));
+  assert(!frustum.contains(box(4.5f, 0, -5, 1)));
+  assert(frustum.intersects(box(4.5f, 0, -5, 1)));
+  assert(!frustum.intersects(box(8, 0, -5, 1)));
+  assert(!frustum.intersects(box(0, -8, -5, 1)));
+
+  // Planes follow the camera: moving it right by 6 puts x = 0 outside.
+  const math::Mat4 view = math::translate4x4(-6, 0, 0);
+  const math::Frustum moved{view * projection};
+  assert(!moved.intersects(math::Sphere{math::Vec3{0, 0, -5}, 0.5f}));
+  assert(moved.intersects(math::Sphere{math::Vec3{6, 0, -5}, 0.5f}));
+
+  const math::Aabb turned = math::transform(
+      box(0, 0, 0, 1), math::rotate4x4y(std::numbers::pi_v<float> / 4) *
+                           math::translate4x4(1, 2, 3));
+  assert(std::fabs(turned.max[0] - (1 + std::sqrt(2.f))) < 1e-5f);
+  assert(std::fabs(turned.min[1] - 1) < 1e-5f);
+  assert(std::fabs(turned.extent()[2] - std::sqrt(2.f)) < 1e-5f);
+
+  // Points (zero radius) against the clip cube, on every instruction set.
+  std::mt19937 random{7};
+  std::uniform_real_distribution<float> coordinate{-12, 12};
+  const unsigned count = 1003;
+  std::vector<float> x(count), y(count), z(count), radius(count, 0);
+  for (unsigned i = 0; i < count; i++) {
+    x[i] = coordinate(random);
+    y[i] = coordinate(random);
+    z[i] = coordinate(random) - 6;
+  }
+  std::vector<std::uint32_t> expected;
+  for (unsigned i = 0; i < count; i++) {
+    if (!clipped(projection, x[i], y[i], z[i])) expected.push_back(100 + i);
+  }
+  assert(expected.size() > 50 && expected.size() < count / 2);
+
+  const math::simd::Isa best = math::simd::detect();
+  std::vector<std::uint32_t> reference;
+  for (const math::simd::Isa isa :
+       {math::simd::Isa::scalar, math::simd::Isa::sse, math::simd::Isa::avx2}) {
+    if (isa > best) continue;
+    math::simd::setIsa(isa);
+    std::vector<std::uint32_t> visible(count);
+    visible.resize(
+        math::cullSpheres(frustum, x, y, z, radius, 100, visible.data()));
+    if (isa == math::simd::Isa::scalar) reference = visible;
+    assert(visible == reference && "Every ISA keeps the same spheres");
+    assert(visible == expected && "Points are kept exactly inside the cube");
+  }
+  math::simd::setIsa(best);
+  return 0;
+}
@@ -0,0 +1,46 @@
+#include <assert.h>
+
+#include <math/Mat.hh>
+#include <math/Matrix.hh>
+#include <stdexcept>
+
+template <typename A, typename B>
+concept Multipliable = requires(const A& a, const B& b) { a * b; };
+
+static_assert(Multipliable<math::Mat<6, 3>, math::Mat3>);
+static_assert(!Multipliable<math::Mat<6, 3>, math::Mat4>);
+static_assert(!Multipliable<math::Mat4, math::Mat3>);
+
+constexpr math::Vec3 point{1, 2, 1};
+static_assert(point * math::translate3x3(3, 4) == math::Vec3{4, 6, 1});
+static_assert(point * math::scale3x3(2) == math::Vec3{2, 4, 1});
+static_assert(math::Mat4::identity() * math::scale4x4(3) == math::scale4x4(3));
+
+int main(const int argc, const char* argv[]) {
+  const math::Mat<2, 3> vertices{{{1, 2, 1}, {-1, 0, 1}}};
+  const math::Mat<2, 3> moved = vertices * math::translate3x3(1, 1);
+  assert(moved(0, 0) == 2 && moved(0, 1) == 3 && "Wrong translation");
+  assert(moved(1, 0) == 0 && moved(1, 1) == 1 && "Wrong translation");
+
+  const math::Matrix matrix = moved;
+  assert(matrix.getRows() == 2 && matrix.getCols() == 3 &&
+         "Mat to Matrix conversion lost dimensions");
+  assert((matrix.toMat<2, 3>() == moved) &&
+         "Matrix to Mat conversion changed values");
+
+  bool thrown = false;
+  try {
+    matrix.toMat<3, 2>();
+  } catch (const std::runtime_error&) {
+    thrown = true;
+  }
+  assert(thrown && "Converting to Mat of another size must throw");
+
+  const math::Matrix product =
+      math::Matrix::scale4x4(2) * math::Matrix::rotate4x4y(0.5f);
+  const math::Mat4 expected = math::scale4x4(2) * math::rotate4x4y(0.5f);
+  assert((product.toMat<4, 4>() == expected) &&
+         "Mat and Matrix products differ");
+
+  return 0;
+}
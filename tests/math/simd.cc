@@ -0,0 +1,62 @@
+#include <assert.h>
+
+#include <cstring>
+#include <math/simd.hh>
+#include <random>
+#include <vector>
+
+std::vector<float> random(unsigned size, std::mt19937& engine) {
+  std::uniform_real_distribution<float> distribution{-100.0f, 100.0f};
+  std::vector<float> values(size);
+  for (float& value : values) value = distribution(engine);
+  return values;
+}
+
+bool same(const std::vector<float>& left, const std::vector<float>& right) {
+  return std::memcmp(left.data(), right.data(), left.size() * sizeof(float)) ==
+         0;
+}
+
+int main(const int argc, const char* argv[]) {
+  std::mt19937 engine{42};
+  const math::simd::Isa best = math::simd::detect();
+  assert(math::simd::active() == best && "Kernels must default to detect()");
+
+  for (const unsigned count : {1u, 2u, 3u, 7u, 1024u}) {
+    const std::vector<float> matrix3 = random(9, engine);
+    const std::vector<float> matrix4 = random(16, engine);
+    const std::vector<float> vertices3 = random(count * 3, engine);
+    const std::vector<float> vertices4 = random(count * 4, engine);
+
+    math::simd::setIsa(math::simd::Isa::scalar);
+    assert(math::simd::active() == math::simd::Isa::scalar);
+    std::vector<float> expected3(count * 3), expected4(count * 4);
+    math::simd::transform3(vertices3.data(), count, matrix3.data(),
+                           expected3.data());
+    math::simd::transform4(vertices4.data(), count, matrix4.data(),
+                           expected4.data());
+
+    for (const math::simd::Isa isa :
+         {math::simd::Isa::sse, math::simd::Isa::avx2}) {
+      math::simd::setIsa(isa);
+      assert(math::simd::active() <= best && "ISA must not exceed detect()");
+
+      std::vector<float> actual3(count * 3), actual4(count * 4);
+      math::simd::transform3(vertices3.data(), count, matrix3.data(),
+                             actual3.data());
+      math::simd::transform4(vertices4.data(), count, matrix4.data(),
+                             actual4.data());
+      assert(same(expected3, actual3) && "transform3 is not bit-identical");
+      assert(same(expected4, actual4) && "transform4 is not bit-identical");
+    }
+  }
+
+  const float identity[16] = {1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1};
+  const std::vector<float> matrix = random(16, engine);
+  std::vector<float> product(16);
+  math::simd::setIsa(best);
+  math::simd::multiply4x4(identity, matrix.data(), product.data());
+  assert(same(matrix, product) && "Identity product changed the matrix");
+
+  return 0;
+}
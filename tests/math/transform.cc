@@ -0,0 +1,218 @@
+#include <assert.h>
+
+#include <cmath>
+#include <cstring>
+#include <math/Mat.hh>
+#include <math/Transform.hh>
+#include <math/simd.hh>
+#include <numbers>
+#include <random>
+#include <vector>
+
+constexpr float pi = std::numbers::pi_v<float>;
+
+template <unsigned rows, unsigned cols>
+bool near(const math::Mat<rows, cols>& left,
+          const math::Mat<rows, cols>& right, float tolerance = 1e-5f) {
+  for (unsigned i = 0; i < left.size(); i++) {
+    if (std::fabs(left.pointer()[i] - right.pointer()[i]) > tolerance) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Angle of the rotation taking `a` to `b`. acos of the dot product would
+// lose small angles to rounding.
+float angleBetween(const math::Quat& a, const math::Quat& b) {
+  const math::Quat d = math::conjugate(a) * b;
+  return 2 * std::atan2(std::sqrt(d.x * d.x + d.y * d.y + d.z * d.z),
+                        std::fabs(d.w));
+}
+
+math::Quat randomQuat(std::mt19937& random) {
+  std::normal_distribution<float> component;
+  return math::normalize(math::Quat{component(random), component(random),
+                                    component(random), component(random)});
+}
+
+// One array per component of `count` quaternions or transforms.
+struct Soa {
+  std::vector<float> values;
+  unsigned count;
+
+  Soa(unsigned arrays, unsigned count)
+      : values(arrays * count), count{count} {}
+
+  std::span<float> array(unsigned index) {
+    return std::span{values}.subspan(index * count, count);
+  }
+
+  math::QuatArrays<float> quats(unsigned first = 0) {
+    return {array(first), array(first + 1), array(first + 2),
+            array(first + 3)};
+  }
+
+  math::TransformArrays<float> transforms() {
+    return {array(0), array(1), array(2), quats(3),
+            array(7), array(8), array(9)};
+  }
+
+  bool operator==(const Soa& other) const {
+    return std::memcmp(values.data(), other.values.data(),
+                       values.size() * sizeof(float)) == 0;
+  }
+};
+
+void fill(math::TransformArrays<float> transforms, std::mt19937& random) {
+  std::uniform_real_distribution<float> position{-10, 10};
+  std::uniform_real_distribution<float> scale{0.5f, 2};
+  for (unsigned i = 0; i < transforms.size(); i++) {
+    const math::Quat q = randomQuat(random);
+    transforms.tx[i] = position(random);
+    transforms.ty[i] = position(random);
+    transforms.tz[i] = position(random);
+    transforms.rotation.x[i] = q.x;
+    transforms.rotation.y[i] = q.y;
+    transforms.rotation.z[i] = q.z;
+    transforms.rotation.w[i] = q.w;
+    transforms.sx[i] = scale(random);
+    transforms.sy[i] = scale(random);
+    transforms.sz[i] = scale(random);
+  }
+}
+
+int main(const int argc, const char* argv[]) {
+  // Same rotations as the matrix factories.
+  const float axis = 1 / std::sqrt(3.f);
+  assert(near(math::toMat4(math::axisAngle(0, 1, 0, 0.7f)),
+              math::rotate4x4y(0.7f)));
+  assert(near(math::toMat4(math::axisAngle(axis, axis, axis, 2.1f)),
+              math::rotate4x4(axis, axis, axis, 2.1f)));
+  assert(math::toMat4(math::Quat{}) == math::Mat4::identity());
+
+  // Products compose in matrix order and rotate like the matrices.
+  std::mt19937 random{11};
+  for (unsigned i = 0; i < 100; i++) {
+    const math::Quat a = randomQuat(random);
+    const math::Quat b = randomQuat(random);
+    assert(near(math::toMat4(a * b), math::toMat4(a) * math::toMat4(b)));
+    assert(near(math::toMat3(a * math::conjugate(a)),
+                math::Mat3::identity()));
+    const math::Vec3 v{1.5f, -2, 0.25f};
+    assert(near(math::rotate(a, v), v * math::toMat3(a)));
+  }
+
+  // Interpolation takes the shorter arc at constant speed for slerp, and
+  // nlerp stays close to it for small steps.
+  const math::Quat start = math::axisAngle(0, 0, 1, 0.2f);
+  const math::Quat end = math::axisAngle(0, 0, 1, 1.8f);
+  assert(math::slerp(start, end, 0) == start);
+  assert(angleBetween(math::slerp(start, end, 1), end) < 1e-3f);
+  assert(angleBetween(math::slerp(start, end, 0.25f),
+                      math::axisAngle(0, 0, 1, 0.6f)) < 1e-3f);
+  const math::Quat flipped{-end.x, -end.y, -end.z, -end.w};
+  assert(angleBetween(math::slerp(start, flipped, 0.5f),
+                      math::axisAngle(0, 0, 1, 1)) < 1e-3f);
+  assert(angleBetween(math::nlerp(start, flipped, 0.5f),
+                      math::axisAngle(0, 0, 1, 1)) < 1e-3f);
+  for (unsigned i = 0; i < 100; i++) {
+    const math::Quat from = randomQuat(random);
+    const math::Quat to =
+        from * math::axisAngle(0, 1, 0, 0.2f * (i % 10) / 9);
+    for (const float alpha : {0.1f, 0.3f, 0.5f, 0.9f}) {
+      const math::Quat linear = math::nlerp(from, to, alpha);
+      assert(angleBetween(linear, math::slerp(from, to, alpha)) < 1e-3f);
+      assert(std::fabs(math::dot(linear, linear) - 1) < 1e-5f);
+    }
+  }
+
+  // A full turn in 0.1 degree steps comes back to where it started. The
+  // length drifts a little and normalize() restores it.
+  const math::Quat step = math::axisAngle(0, 1, 0, pi / 1800);
+  math::Quat turned;
+  for (unsigned i = 0; i < 3600; i++) turned = turned * step;
+  assert(std::fabs(math::dot(turned, turned) - 1) < 1e-3f);
+  assert(angleBetween(turned, math::Quat{}) < 1e-3f);
+  turned = math::normalize(turned);
+  assert(std::fabs(math::dot(turned, turned) - 1) < 1e-6f);
+
+  // Transforms match their matrices when the second scale is uniform.
+  for (unsigned i = 0; i < 100; i++) {
+    const math::Transform a{math::Vec3{1, -2, 3}, randomQuat(random),
+                            math::Vec3{0.5f, 2, 1.5f}};
+    const math::Transform b{math::Vec3{-4, 0.5f, 2}, randomQuat(random),
+                            math::Vec3{3, 3, 3}};
+    assert(near(math::toMat4(a * b), math::toMat4(a) * math::toMat4(b),
+                1e-4f));
+    const math::Vec3 point{0.3f, 0.7f, -1.1f};
+    const math::Vec4 moved =
+        math::Vec4{point[0], point[1], point[2], 1} * math::toMat4(a);
+    assert(near(math::transform(a, point),
+                math::Vec3{moved[0], moved[1], moved[2]}, 1e-4f));
+  }
+  const math::Transform blended = math::interpolate(
+      math::Transform{.translation = math::Vec3{0, 0, 0}},
+      math::Transform{.translation = math::Vec3{2, 4, 6},
+                      .scale = math::Vec3{3, 3, 3}},
+      0.5f);
+  assert(near(blended.translation, math::Vec3{1, 2, 3}));
+  assert(near(blended.scale, math::Vec3{2, 2, 2}));
+
+  // Batches agree with the single-element functions bit for bit on every
+  // instruction set, including the tails past the last full vector.
+  const math::simd::Isa best = math::simd::detect();
+  for (const unsigned count : {1u, 7u, 37u, 1024u}) {
+    Soa left{10, count}, right{10, count};
+    fill(left.transforms(), random);
+    fill(right.transforms(), random);
+
+    math::simd::setIsa(math::simd::Isa::scalar);
+    Soa products{4, count}, blends{4, count}, composed{10, count};
+    math::multiply(left.quats(3), right.quats(3), products.quats());
+    math::nlerp(left.quats(3), right.quats(3), 0.3f, blends.quats());
+    math::multiply(left.transforms(), right.transforms(),
+                   composed.transforms());
+    std::vector<math::Mat4> matrices(count);
+    math::toMat4(left.transforms(), matrices);
+    for (unsigned i = 0; i < count; i++) {
+      const math::QuatArrays<float> l = left.quats(3);
+      const math::QuatArrays<float> r = right.quats(3);
+      const math::Quat a{l.x[i], l.y[i], l.z[i], l.w[i]};
+      const math::Quat b{r.x[i], r.y[i], r.z[i], r.w[i]};
+      const math::Quat product = a * b;
+      assert(products.quats().w[i] == product.w);
+      assert(blends.quats().x[i] == math::nlerp(a, b, 0.3f).x);
+    }
+
+    for (const math::simd::Isa isa :
+         {math::simd::Isa::sse, math::simd::Isa::avx2}) {
+      if (isa > best) continue;
+      math::simd::setIsa(isa);
+      Soa vector_products{4, count}, vector_blends{4, count},
+          vector_composed{10, count};
+      math::multiply(left.quats(3), right.quats(3), vector_products.quats());
+      math::nlerp(left.quats(3), right.quats(3), 0.3f,
+                  vector_blends.quats());
+      math::multiply(left.transforms(), right.transforms(),
+                     vector_composed.transforms());
+      std::vector<math::Mat4> vector_matrices(count);
+      math::toMat4(left.transforms(), vector_matrices);
+      assert(vector_products == products && "multiply is not bit-identical");
+      assert(vector_blends == blends && "nlerp is not bit-identical");
+      assert(vector_composed == composed &&
+             "Transform multiply is not bit-identical");
+      assert(std::memcmp(vector_matrices.data(), matrices.data(),
+                         count * sizeof(math::Mat4)) == 0 &&
+             "toMat4 is not bit-identical");
+
+      // Results may overwrite an input.
+      Soa in_place = left;
+      math::multiply(in_place.transforms(), right.transforms(),
+                     in_place.transforms());
+      assert(in_place == composed);
+    }
+    math::simd::setIsa(best);
+  }
+  return 0;
+}
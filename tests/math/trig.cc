@@ -0,0 +1,85 @@
+#include <assert.h>
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <math/simd.hh>
+#include <math/trig.hh>
+#include <random>
+#include <vector>
+
+constexpr double precise_bound = 8e-8;
+constexpr double fast_bound = 3.7e-5;
+
+double maxError(math::Accuracy accuracy, float from, float to,
+                unsigned steps) {
+  double error = 0;
+  for (unsigned i = 0; i <= steps; i++) {
+    const float angle = from + (to - from) * (static_cast<double>(i) / steps);
+    const math::SinCos result = math::sincos(angle, accuracy);
+    error = std::fmax(error, std::fabs(result.sin - std::sin(double{angle})));
+    error = std::fmax(error, std::fabs(result.cos - std::cos(double{angle})));
+  }
+  return error;
+}
+
+bool same(const std::vector<float>& left, const std::vector<float>& right) {
+  return std::memcmp(left.data(), right.data(), left.size() * sizeof(float)) ==
+         0;
+}
+
+int main(const int argc, const char* argv[]) {
+  for (const float range : {4.f, 100.f, math::trig_range}) {
+    assert(maxError(math::Accuracy::precise, -range, range, 1 << 20) <=
+           precise_bound);
+    assert(maxError(math::Accuracy::fast, -range, range, 1 << 20) <=
+           fast_bound);
+  }
+
+  const math::SinCos zero = math::sincos(0);
+  assert(zero.sin == 0 && zero.cos == 1);
+
+  // Outside the reduced range the result comes from the standard library.
+  const math::SinCos large = math::sincos(1e6f);
+  assert(large.sin == std::sin(1e6f) && large.cos == std::cos(1e6f));
+  assert(std::isnan(math::sincos(std::numeric_limits<float>::infinity()).sin));
+
+  std::mt19937 engine{42};
+  std::uniform_real_distribution<float> distribution{-20.f, 20.f};
+  std::vector<float> angles(1027);
+  for (float& angle : angles) angle = distribution(engine);
+  // Exercise the fallback inside vector blocks and in the tail.
+  angles[5] = 1e5f;
+  angles[17] = std::numeric_limits<float>::quiet_NaN();
+  angles[1026] = -3e4f;
+
+  const math::simd::Isa best = math::simd::detect();
+  for (const math::Accuracy accuracy :
+       {math::Accuracy::precise, math::Accuracy::fast}) {
+    std::vector<float> sines(angles.size());
+    std::vector<float> cosines(angles.size());
+    for (unsigned i = 0; i < angles.size(); i++) {
+      const math::SinCos result = math::sincos(angles[i], accuracy);
+      sines[i] = result.sin;
+      cosines[i] = result.cos;
+    }
+
+    for (const math::simd::Isa isa :
+         {math::simd::Isa::scalar, math::simd::Isa::sse,
+          math::simd::Isa::avx2}) {
+      if (isa > best) continue;
+      math::simd::setIsa(isa);
+      std::vector<float> batch_sines(angles.size());
+      std::vector<float> batch_cosines(angles.size());
+      math::sincos(angles, batch_sines, batch_cosines, accuracy);
+      assert(same(batch_sines, sines) && same(batch_cosines, cosines) &&
+             "Batch results must match the scalar function bit for bit");
+
+      // Sines may overwrite the angles they are computed from.
+      std::vector<float> in_place = angles;
+      math::sincos(in_place, in_place, batch_cosines, accuracy);
+      assert(same(in_place, sines) && same(batch_cosines, cosines));
+    }
+    math::simd::setIsa(best);
+  }
+}
@@ -0,0 +1,121 @@
+#include <assert.h>
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <mesh/File.hh>
+#include <mesh/Mesh.hh>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+template <typename T>
+std::vector<T> values(std::span<const std::byte> block) {
+  std::vector<T> result(block.size() / sizeof(T));
+  std::memcpy(result.data(), block.data(), block.size());
+  return result;
+}
+
+bool rejected(const fs::path& path) {
+  try {
+    mesh::File file{path};
+  } catch (const std::runtime_error&) {
+    return true;
+  }
+  return false;
+}
+
+// Overwrites `size` bytes of `path` at `offset`.
+void patch(const fs::path& path, std::size_t offset, const void* bytes,
+           std::size_t size) {
+  std::fstream file{path, std::ios::binary | std::ios::in | std::ios::out};
+  file.seekp(offset);
+  file.write(static_cast<const char*>(bytes), size);
+}
+
+int main(const int argc, const char* argv[]) {
+  const fs::path directory = fs::temp_directory_path() / "mesh_file_test";
+  fs::create_directories(directory);
+  const fs::path path = directory / "cube.mesh";
+
+  const auto cube = mesh::cube(0.5f);
+  mesh::Geometry geometry;
+  for (unsigned vertex = 0; vertex < cube.vertices; vertex++) {
+    for (unsigned axis = 0; axis < 3; axis++) {
+      geometry.positions.push_back(cube.positions(vertex, axis) + axis);
+    }
+  }
+  geometry.indices.assign(cube.indices.begin(), cube.indices.end());
+
+  mesh::writeFile(path, geometry);
+  {
+    const mesh::File file{path};
+    const mesh::FileHeader& header = file.header();
+    assert(header.version == mesh::file_version && !file.quantized());
+    assert(header.vertex_count == 8 && header.index_count == 36);
+    assert(header.index_size == 2);
+    assert(header.vertex_offset % mesh::file_alignment == 0);
+    assert(header.index_offset % mesh::file_alignment == 0);
+    assert(header.bounds_min[2] == 1.5f && header.bounds_max[2] == 2.5f);
+    assert(values<float>(file.vertices()) == geometry.positions);
+    const auto indices = values<std::uint16_t>(file.indices());
+    assert(std::equal(indices.begin(), indices.end(), cube.indices.begin(),
+                      cube.indices.end()));
+  }
+
+  mesh::writeFile(path, geometry, true);
+  {
+    const mesh::File file{path};
+    const mesh::FileHeader& header = file.header();
+    assert(file.quantized() && header.vertex_stride == 8);
+    const auto quantized = values<std::uint16_t>(file.vertices());
+    for (unsigned vertex = 0; vertex < 8; vertex++) {
+      assert(quantized[vertex * 4 + 3] == 65535 && "w reads as 1");
+      for (unsigned axis = 0; axis < 3; axis++) {
+        const float low = header.bounds_min[axis];
+        const float extent = header.bounds_max[axis] - low;
+        const float value = low + quantized[vertex * 4 + axis] / 65535.f *
+                                      extent;
+        assert(std::fabs(value - geometry.positions[vertex * 3 + axis]) <
+               extent / 65535);
+      }
+    }
+  }
+
+  // More than 65536 vertices need 32-bit indices.
+  mesh::Geometry large;
+  large.positions.resize(3 * 70000);
+  large.indices = {0, 69999, 1};
+  mesh::writeFile(path, large);
+  {
+    const mesh::File file{path};
+    assert(file.header().index_size == 4);
+    assert(values<std::uint32_t>(file.indices()) == large.indices);
+  }
+
+  mesh::writeFile(path, geometry);
+  const std::uint16_t future = mesh::file_version + 1;
+  patch(path, offsetof(mesh::FileHeader, version), &future, sizeof(future));
+  assert(rejected(path) && "Other versions are rejected");
+
+  mesh::writeFile(path, geometry);
+  fs::resize_file(path, fs::file_size(path) - 2);
+  assert(rejected(path) && "Blocks must fit in the file");
+
+  mesh::writeFile(path, geometry);
+  patch(path, 0, "OBJ ", 4);
+  assert(rejected(path) && "The magic number is checked");
+
+  fs::resize_file(path, 0);
+  assert(rejected(path));
+  assert(rejected(directory / "missing.mesh"));
+
+  fs::remove_all(directory);
+  return 0;
+}
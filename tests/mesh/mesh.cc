@@ -0,0 +1,127 @@
+#include <assert.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <map>
+#include <mesh/Mesh.hh>
+#include <mesh/cache.hh>
+#include <numbers>
+#include <span>
+#include <utility>
+#include <vector>
+
+constexpr auto square = mesh::polygon<4>(1, std::numbers::pi_v<float> / 4);
+static_assert(square.vertices == 4 && square.indices.size() == 6);
+
+constexpr auto pyramid = mesh::optimized(mesh::pyramid<3>(1, -1, 1));
+static_assert(pyramid.vertices == 4 && pyramid.triangles == 4);
+static_assert(mesh::cube(1).vertices == 8 && mesh::cube(1).triangles == 12);
+
+constexpr auto sphere = mesh::sphere<12, 24>(1);
+static_assert(sphere.vertices == 11 * 24 + 2);
+static_assert(mesh::optimized(mesh::sphere<4, 8>(1)).triangles == 48);
+
+// Triangle seen from outside a mesh centered on the origin: its normal
+// points away from the origin.
+template <typename Mesh>
+bool outward(const Mesh& mesh, unsigned triangle) {
+  std::array<std::array<float, 3>, 3> corner;
+  for (unsigned i = 0; i < 3; i++) {
+    for (unsigned axis = 0; axis < 3; axis++) {
+      corner[i][axis] =
+          mesh.positions(mesh.indices[triangle * 3 + i], axis);
+    }
+  }
+  std::array<float, 3> u, v;
+  for (unsigned axis = 0; axis < 3; axis++) {
+    u[axis] = corner[1][axis] - corner[0][axis];
+    v[axis] = corner[2][axis] - corner[0][axis];
+  }
+  const std::array<float, 3> normal{u[1] * v[2] - u[2] * v[1],
+                                    u[2] * v[0] - u[0] * v[2],
+                                    u[0] * v[1] - u[1] * v[0]};
+  float dot = 0;
+  for (unsigned axis = 0; axis < 3; axis++) {
+    dot += normal[axis] * (corner[0][axis] + corner[1][axis] + corner[2][axis]);
+  }
+  return dot > 0;
+}
+
+// Closed and consistently wound: every directed edge appears once and its
+// reverse appears once too.
+template <std::size_t count>
+bool closed(const std::array<mesh::Index, count>& indices) {
+  std::map<std::pair<unsigned, unsigned>, unsigned> edges;
+  for (unsigned i = 0; i < count; i += 3) {
+    for (unsigned corner = 0; corner < 3; corner++) {
+      edges[{indices[i + corner], indices[i + (corner + 1) % 3]}]++;
+    }
+  }
+  for (const auto& [edge, uses] : edges) {
+    if (uses != 1 || !edges.contains({edge.second, edge.first})) return false;
+  }
+  return true;
+}
+
+// Triangles as rotation-independent keys, to compare orderings.
+template <std::size_t count>
+std::vector<std::array<mesh::Index, 3>> triangles(
+    const std::array<mesh::Index, count>& indices) {
+  std::vector<std::array<mesh::Index, 3>> result;
+  for (unsigned i = 0; i < count; i += 3) {
+    std::array<mesh::Index, 3> triangle{indices[i], indices[i + 1],
+                                        indices[i + 2]};
+    std::rotate(triangle.begin(),
+                std::min_element(triangle.begin(), triangle.end()),
+                triangle.end());
+    result.push_back(triangle);
+  }
+  std::ranges::sort(result);
+  return result;
+}
+
+int main(const int argc, const char* argv[]) {
+  for (unsigned i = 0; i < 100; i++) {
+    const double angle = -20 + i * 0.4;
+    const math::SinCos value = mesh::constantSinCos(angle);
+    assert(std::fabs(value.sin - std::sin(angle)) < 1e-6);
+    assert(std::fabs(value.cos - std::cos(angle)) < 1e-6);
+  }
+
+  assert(std::fabs(square.positions(0, 0) - std::sqrt(0.5f)) < 1e-6f);
+  assert(std::fabs(square.positions(2, 1) + std::sqrt(0.5f)) < 1e-6f);
+  for (unsigned t = 0; t < 2; t++) {
+    // Looking down -z, counter-clockwise means a positive signed area.
+    const auto& p = square.positions;
+    const unsigned a = square.indices[t * 3];
+    const unsigned b = square.indices[t * 3 + 1];
+    const unsigned c = square.indices[t * 3 + 2];
+    assert((p(b, 0) - p(a, 0)) * (p(c, 1) - p(a, 1)) -
+               (p(b, 1) - p(a, 1)) * (p(c, 0) - p(a, 0)) >
+           0);
+  }
+
+  for (unsigned t = 0; t < pyramid.triangles; t++) assert(outward(pyramid, t));
+  const auto cube = mesh::cube(0.5f);
+  for (unsigned t = 0; t < cube.triangles; t++) assert(outward(cube, t));
+  for (unsigned t = 0; t < sphere.triangles; t++) assert(outward(sphere, t));
+
+  assert(closed(pyramid.indices));
+  assert(closed(cube.indices));
+  assert(closed(sphere.indices));
+
+  auto reordered = sphere;
+  mesh::optimizeVertexCache(std::span<mesh::Index>{reordered.indices},
+                            reordered.vertices);
+  assert(triangles(reordered.indices) == triangles(sphere.indices) &&
+         "Reordering must keep every triangle and its winding");
+  assert(triangles(pyramid.indices) ==
+         triangles(mesh::pyramid<3>(1, -1, 1).indices));
+
+  const float before = mesh::acmr(std::span<const mesh::Index>{sphere.indices});
+  const float after =
+      mesh::acmr(std::span<const mesh::Index>{reordered.indices});
+  assert(after < 0.8f && after < before && "Reordering must reduce misses");
+  return 0;
+}
@@ -0,0 +1,50 @@
+#include <assert.h>
+
+#include <cstdint>
+#include <mesh/Mesh.hh>
+#include <mesh/obj.hh>
+#include <stdexcept>
+#include <string_view>
+#include <vector>
+
+bool rejected(std::string_view text) {
+  try {
+    mesh::parseObj(text);
+  } catch (const std::runtime_error&) {
+    return true;
+  }
+  return false;
+}
+
+int main(const int argc, const char* argv[]) {
+  const mesh::Geometry quad = mesh::parseObj(
+      "# unit quad\n"
+      "mtllib quad.mtl\n"
+      "o quad\n"
+      "v 0 0 0\n"
+      "v 1 0 0\r\n"
+      "v 1 1 0 1.0\n"
+      "v 0 1 0\n"
+      "vt 0 0\n"
+      "vn 0 0 1\n"
+      "s off\n"
+      "f 1/1/1 2/1/1 3//1 4  # fan from the first corner\n");
+  assert(quad.vertices() == 4 && quad.triangles() == 2);
+  assert(quad.positions[3] == 1 && quad.positions[7] == 1);
+  assert((quad.indices == std::vector<std::uint32_t>{0, 1, 2, 0, 2, 3}));
+
+  const mesh::Geometry relative = mesh::parseObj(
+      "v 0 0 0\nv 1 0 0\nv 0 1 0\n"
+      "f -3 -2 -1\n"
+      "v 0 0 1\n"
+      "f -1 1 2\n");
+  assert((relative.indices == std::vector<std::uint32_t>{0, 1, 2, 3, 0, 1}));
+
+  assert(mesh::parseObj("").indices.empty());
+  assert(rejected("v 0 0\n"));
+  assert(rejected("v 0 0 0\nv 1 0 0\nf 1 2\n"));
+  assert(rejected("v 0 0 0\nv 1 0 0\nf 1 2 3\n"));
+  assert(rejected("v 0 0 0\nf 1 x 1\n"));
+  assert(rejected("v 0 0 0\nf 0 1 1\n"));
+  return 0;
+}
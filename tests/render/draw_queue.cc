@@ -0,0 +1,73 @@
+#include <assert.h>
+
+#include <cmath>
+#include <cstdint>
+#include <glad/glad.h>
+#include <render/DrawQueue.hh>
+#include <render/StateCache.hh>
+#include <vector>
+
+using Sort = render::DrawQueue::Sort;
+
+std::uint64_t key(const Sort& sort) { return render::DrawQueue::key(sort); }
+
+// Programs and vertex counts of the draws issued, in order.
+std::vector<unsigned> programs;
+std::vector<int> counts;
+unsigned current_program = 0;
+
+int main(const int argc, const char* argv[]) {
+  // Layers come first, whatever the state.
+  assert(key({.layer = 1}) > key({.layer = 0, .program = 8191}));
+  assert(key({.layer = 1}) > key({.translucent = true, .depth = 0}));
+  // Then the program, the vertex array and the material.
+  assert(key({.program = 2}) > key({.program = 1, .vertex_array = 8191}));
+  assert(key({.vertex_array = 2}) > key({.vertex_array = 1, .material = 9}));
+  assert(key({.material = 2}) > key({.material = 1, .depth = 1}));
+
+  // Opaque draws go front to back, translucent ones after them and back to
+  // front, before their state.
+  assert(key({.depth = 0.25f}) < key({.depth = 0.75f}));
+  assert(key({.translucent = true}) > key({.program = 8191, .depth = 1}));
+  assert(key({.translucent = true, .depth = 0.75f}) <
+         key({.translucent = true, .depth = 0.25f}));
+  assert(key({.translucent = true, .program = 1, .depth = 0.75f}) <
+         key({.translucent = true, .program = 0, .depth = 0.25f}));
+  assert(key({.translucent = true, .program = 1, .depth = 0.5f}) >
+         key({.translucent = true, .program = 0, .depth = 0.5f}));
+
+  // Depth is clamped, NaN to the front.
+  assert(key({.depth = -1}) == key({.depth = 0}));
+  assert(key({.depth = 2}) == key({.depth = 1}));
+  assert(key({.depth = NAN}) == key({.depth = 0}));
+  // Names beyond a field's bits wrap around rather than spill over.
+  assert(key({.program = 1u << render::DrawQueue::program_bits}) ==
+         key({}));
+  assert(key({.layer = 1u << render::DrawQueue::layer_bits}) == key({}));
+
+  glad_glUseProgram = [](GLuint program) { current_program = program; };
+  glad_glBindVertexArray = [](GLuint) {};
+  glad_glDrawArrays = [](GLenum, GLint, GLsizei count) {
+    programs.push_back(current_program);
+    counts.push_back(count);
+  };
+
+  // Draws come out in key order, equal keys in submission order.
+  render::DrawQueue queue;
+  render::StateCache state;
+  queue.submit(key({.translucent = true, .program = 1, .depth = 0.2f}),
+               {.program = 1, .count = 1});
+  queue.submit(key({.layer = 1, .program = 1}), {.program = 1, .count = 2});
+  queue.submit(key({.program = 2}), {.program = 2, .count = 3});
+  queue.submit(key({.translucent = true, .program = 2, .depth = 0.8f}),
+               {.program = 2, .count = 4});
+  queue.submit(key({.program = 1}), {.program = 1, .count = 5});
+  queue.submit(key({.program = 2}), {.program = 2, .count = 6});
+  assert(queue.size() == 6);
+  assert(queue.execute(state) == 6 && queue.size() == 0);
+  assert((counts == std::vector<int>{5, 3, 6, 4, 1, 2}));
+  assert((programs == std::vector<unsigned>{1, 2, 2, 2, 1, 1}));
+  // Three program changes and one vertex array bind; the rest is skipped.
+  assert(state.counts().issued == 4 && state.counts().skipped == 8);
+  return 0;
+}
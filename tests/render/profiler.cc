@@ -0,0 +1,125 @@
+#include <assert.h>
+
+#include <array>
+#include <filesystem>
+#include <fstream>
+#include <glad/glad.h>
+#include <iterator>
+#include <render/Profiler.hh>
+#include <string>
+#include <vector>
+
+// Timer queries answered by the stubs: a query ended while `elapsed` holds
+// a value reports it, once `available`.
+GLuint next_query = 1;
+GLuint active_query = 0;
+std::array<GLuint64, 16> results{};
+GLuint64 elapsed = 0;
+bool available = true;
+
+std::vector<std::string> split(const std::string& text, char separator) {
+  std::vector<std::string> parts{{}};
+  for (const char c : text) {
+    if (c == separator) {
+      parts.emplace_back();
+    } else {
+      parts.back() += c;
+    }
+  }
+  return parts;
+}
+
+std::string read(const std::filesystem::path& path) {
+  std::ifstream in{path};
+  return {std::istreambuf_iterator<char>{in}, {}};
+}
+
+int main(const int argc, const char* argv[]) {
+  glad_glGenQueries = [](GLsizei count, GLuint* queries) {
+    for (GLsizei i = 0; i < count; i++) queries[i] = next_query++;
+  };
+  glad_glDeleteQueries = [](GLsizei, const GLuint*) {};
+  glad_glBeginQuery = [](GLenum, GLuint query) { active_query = query; };
+  glad_glEndQuery = [](GLenum) { results[active_query] = elapsed; };
+  glad_glGetQueryObjectiv = [](GLuint, GLenum, GLint* value) {
+    *value = available;
+  };
+  glad_glGetQueryObjectui64v = [](GLuint query, GLenum, GLuint64* value) {
+    *value = results[query];
+  };
+
+  render::Profiler profiler{4, true};
+  const render::Profiler::Zone draws =
+      profiler.zone("draws", render::Profiler::Kind::count);
+  const render::Profiler::Zone pass =
+      profiler.zone("pass", render::Profiler::Kind::gpu);
+  const render::Profiler::Zone idle = profiler.zone("idle");
+
+  // Per-frame totals of the count zone; frame 2 counts nothing.
+  const std::vector<std::vector<double>> counted{{3, 1}, {1}, {}, {2},
+                                                 {8},    {5}};
+  for (unsigned frame = 0; frame < counted.size(); frame++) {
+    for (const double amount : counted[frame]) profiler.count(draws, amount);
+    elapsed = (frame + 1) * 1000000;
+    // The scope is left as soon as it is entered.
+    profiler.scope(pass);
+    // Frame 3's result is still pending when frame 4 ends.
+    available = frame != 4;
+    profiler.endFrame();
+  }
+
+  // The window of 4 keeps 1, 2, 8 and 5.
+  const render::Profiler::Stats counts = profiler.stats(draws);
+  assert(counts.samples == 4);
+  assert(counts.min == 1 && counts.mean == 4 && counts.p50 == 2 &&
+         counts.p99 == 8);
+  assert(profiler.counts() == "draws 4");
+
+  // GPU results arrive a frame late: frames 0, 1, 2 and 4, in milliseconds.
+  const render::Profiler::Stats gpu = profiler.stats(pass);
+  assert(gpu.samples == 4 && profiler.missed() == 1);
+  assert(gpu.min == 1 && gpu.mean == 2.75 && gpu.p50 == 2 && gpu.p99 == 5);
+  assert(profiler.summary().find("gpu pass 1.00/2.75/2.00/5.00") !=
+         std::string::npos);
+  assert(profiler.stats(idle).samples == 0);
+  assert(profiler.stats(render::Profiler::frame).samples == 4);
+
+  const std::filesystem::path directory =
+      std::filesystem::temp_directory_path();
+  const std::filesystem::path csv = directory / "render_profiler_test.csv";
+  profiler.exportSamples(csv);
+  const std::vector<std::string> rows = split(read(csv), '\n');
+  std::filesystem::remove(csv);
+  // A row per frame, then the empty remainder after the last newline.
+  assert(rows.size() == counted.size() + 2);
+  assert(rows[0] == "frame,frame_cpu,draws_count,pass_gpu,idle_cpu");
+  const std::vector<std::vector<std::string>> expected{
+      {"0", "4.0000", "1.0000", ""}, {"1", "1.0000", "2.0000", ""},
+      {"2", "", "3.0000", ""},       {"3", "2.0000", "", ""},
+      {"4", "8.0000", "5.0000", ""}, {"5", "5.0000", "", ""}};
+  for (unsigned row = 0; row < expected.size(); row++) {
+    const std::vector<std::string> cells = split(rows[row + 1], ',');
+    assert(cells.size() == 5);
+    assert(cells[0] == expected[row][0] && !cells[1].empty());
+    assert(cells[2] == expected[row][1] && cells[3] == expected[row][2] &&
+           cells[4] == expected[row][3]);
+  }
+
+  const std::filesystem::path json = directory / "render_profiler_test.json";
+  profiler.exportSamples(json);
+  const std::string exported = read(json);
+  std::filesystem::remove(json);
+  assert(exported.starts_with("{\"frames\":6,\"zones\":["));
+  assert(exported.find(
+             "{\"name\":\"draws\",\"kind\":\"count\",\"stats\":{\"min\":"
+             "1.0000,\"mean\":4.0000,\"p50\":2.0000,\"p99\":8.0000},"
+             "\"samples\":[4.0000,1.0000,null,2.0000,8.0000,5.0000]}") !=
+         std::string::npos);
+  assert(exported.find(
+             "{\"name\":\"pass\",\"kind\":\"gpu\",\"stats\":{\"min\":1.0000,"
+             "\"mean\":2.7500,\"p50\":2.0000,\"p99\":5.0000},\"samples\":"
+             "[1.0000,2.0000,3.0000,null,5.0000,null]}") != std::string::npos);
+  assert(exported.find("{\"name\":\"idle\",\"kind\":\"cpu\"") !=
+         std::string::npos);
+  return 0;
+}
@@ -0,0 +1,78 @@
+#include <assert.h>
+
+#include <glad/glad.h>
+#include <render/StateCache.hh>
+
+// GL calls that reached the stubs.
+unsigned programs = 0;
+unsigned vertex_arrays = 0;
+unsigned buffers = 0;
+unsigned uniforms = 0;
+
+int main(const int argc, const char* argv[]) {
+  glad_glUseProgram = [](GLuint) { programs++; };
+  glad_glBindVertexArray = [](GLuint) { vertex_arrays++; };
+  glad_glBindBuffer = [](GLenum, GLuint) { buffers++; };
+  glad_glUniformMatrix4fv = [](GLint, GLsizei, GLboolean, const GLfloat*) {
+    uniforms++;
+  };
+  glad_glUniform3f = [](GLint, GLfloat, GLfloat, GLfloat) { uniforms++; };
+
+  render::StateCache state;
+  state.useProgram(1);
+  state.useProgram(1);
+  state.bindVertexArray(2);
+  state.bindVertexArray(2);
+  state.bindVertexArray(3);
+  assert(programs == 1 && vertex_arrays == 2 &&
+         "Redundant binds must not reach GL");
+  assert(state.counts().issued == 3 && state.counts().skipped == 2);
+
+  const render::StateCache::Counts taken = state.takeCounts();
+  assert(taken.issued == 3 && taken.skipped == 2);
+  assert(state.counts().issued == 0 && state.counts().skipped == 0);
+
+  // Buffers are tracked per target, except the vertex array's indices.
+  state.bindBuffer(GL_ARRAY_BUFFER, 4);
+  state.bindBuffer(GL_ARRAY_BUFFER, 4);
+  state.bindBuffer(GL_PIXEL_PACK_BUFFER, 4);
+  state.bindBuffer(GL_ELEMENT_ARRAY_BUFFER, 5);
+  state.bindBuffer(GL_ELEMENT_ARRAY_BUFFER, 5);
+  assert(buffers == 4);
+  state.invalidate(GL_ARRAY_BUFFER);
+  state.bindBuffer(GL_ARRAY_BUFFER, 4);
+  state.bindBuffer(GL_PIXEL_PACK_BUFFER, 4);
+  assert(buffers == 5 && "Only the invalidated target is rebound");
+
+  // Uniform values are remembered per program; location -1 is ignored.
+  const float matrix[16] = {1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1};
+  state.uniformMatrix4x4(0, matrix);
+  state.uniformMatrix4x4(0, matrix);
+  state.uniformVector3(1, 1, 2, 3);
+  state.uniformVector3(1, 1, 2, 3);
+  state.uniformVector3(1, 1, 2, 4);
+  state.uniformVector3(-1, 1, 2, 3);
+  assert(uniforms == 3);
+  state.useProgram(2);
+  state.uniformMatrix4x4(0, matrix);
+  state.useProgram(1);
+  state.uniformMatrix4x4(0, matrix);
+  assert(programs == 3 && uniforms == 4 &&
+         "Another program's uniform needs its own value");
+
+  // After invalidate() every setter reaches GL again, once.
+  state.invalidate();
+  state.useProgram(1);
+  state.bindVertexArray(3);
+  state.bindBuffer(GL_ARRAY_BUFFER, 4);
+  state.uniformMatrix4x4(0, matrix);
+  assert(programs == 4 && vertex_arrays == 3 && buffers == 6 &&
+         uniforms == 5);
+  state.useProgram(1);
+  state.bindVertexArray(3);
+  state.bindBuffer(GL_ARRAY_BUFFER, 4);
+  state.uniformMatrix4x4(0, matrix);
+  assert(programs == 4 && vertex_arrays == 3 && buffers == 6 &&
+         uniforms == 5);
+  return 0;
+}
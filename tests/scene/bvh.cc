@@ -0,0 +1,108 @@
+#include <assert.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <math/Frustum.hh>
+#include <math/Mat.hh>
+#include <numbers>
+#include <random>
+#include <scene/Bvh.hh>
+#include <utils/jobs.hh>
+#include <vector>
+
+math::Aabb box(float x, float y, float z, float half_size) {
+  return {math::Vec3{x - half_size, y - half_size, z - half_size},
+          math::Vec3{x + half_size, y + half_size, z + half_size}};
+}
+
+// Culling is conservative: every object whose box touches the frustum is
+// kept, and nothing whose bounding sphere misses it.
+bool conservative(const math::Frustum& frustum,
+                  const std::vector<math::Aabb>& boxes,
+                  std::vector<scene::Bvh::Object> visible) {
+  std::ranges::sort(visible);
+  if (std::ranges::adjacent_find(visible) != visible.end()) return false;
+  for (scene::Bvh::Object object = 0; object < boxes.size(); object++) {
+    const bool kept = std::ranges::binary_search(visible, object);
+    const math::Vec3 extent = boxes[object].extent();
+    const math::Sphere sphere{
+        boxes[object].center(),
+        std::sqrt(extent[0] * extent[0] + extent[1] * extent[1] +
+                  extent[2] * extent[2])};
+    if (frustum.intersects(boxes[object]) && !kept) return false;
+    if (!frustum.intersects(sphere) && kept) return false;
+  }
+  return true;
+}
+
+int main(const int argc, const char* argv[]) {
+  std::mt19937 random{11};
+  std::uniform_real_distribution<float> coordinate{-50, 50};
+  std::uniform_real_distribution<float> size{0.1f, 2};
+  std::vector<math::Aabb> boxes;
+  for (unsigned i = 0; i < 5000; i++) {
+    boxes.push_back(box(coordinate(random), coordinate(random),
+                        coordinate(random) - 50, size(random)));
+  }
+
+  scene::Bvh bvh;
+  bvh.build(boxes);
+  assert(bvh.size() == boxes.size());
+  assert(bvh.nodeCount() >= 2 * boxes.size() / scene::Bvh::max_leaf_size - 1);
+  const float built_cost = bvh.cost();
+  // Uniform boxes make a shallow tree of mostly full leaves; splitting off
+  // one bin at a time would double the cost and nest far deeper.
+  assert(bvh.depth() <= 20);
+  assert(built_cost < 100);
+  assert(bvh.nodeCount() < boxes.size() / 2);
+
+  const math::Mat4 projection =
+      math::perspective(std::numbers::pi_v<float> / 3, 1.5f, 0.5f, 80);
+  const math::Frustum frustum{projection};
+  std::vector<scene::Bvh::Object> visible;
+  bvh.cull(frustum, visible);
+  assert(!visible.empty() && visible.size() < boxes.size());
+  assert(conservative(frustum, boxes, visible));
+
+  std::vector<scene::Bvh::Object> parallel;
+  utils::JobSystem jobs{4};
+  bvh.cull(frustum, parallel, &jobs);
+  assert(parallel == visible && "Threads return the same objects in order");
+
+  // Objects drift; refitting keeps culling correct but loosens the tree.
+  std::uniform_real_distribution<float> drift{-20, 20};
+  for (math::Aabb& moved : boxes) {
+    const math::Vec3 offset{drift(random), drift(random), drift(random)};
+    for (unsigned axis = 0; axis < 3; axis++) {
+      moved.min[axis] += offset[axis];
+      moved.max[axis] += offset[axis];
+    }
+  }
+  bvh.refit(boxes);
+  visible.clear();
+  bvh.cull(frustum, visible);
+  assert(conservative(frustum, boxes, visible));
+  const float refit_cost = bvh.cost();
+  assert(refit_cost > built_cost);
+  bvh.build(boxes);
+  assert(bvh.cost() < refit_cost && "Rebuilding tightens the tree again");
+
+  // Everything in view; objects that cannot be told apart still split.
+  const std::vector<math::Aabb> stacked(100, box(0, 0, -10, 1));
+  bvh.build(stacked);
+  visible.clear();
+  bvh.cull(frustum, visible);
+  assert(visible.size() == stacked.size());
+
+  const math::Frustum behind{math::rotate4x4y(std::numbers::pi_v<float>) *
+                             projection};
+  visible.clear();
+  bvh.cull(behind, visible);
+  assert(visible.empty());
+
+  bvh.build({});
+  bvh.cull(frustum, visible);
+  assert(visible.empty() && bvh.cost() == 0);
+  return 0;
+}
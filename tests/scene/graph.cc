@@ -0,0 +1,69 @@
+#include <assert.h>
+
+#include <cmath>
+#include <math/Mat.hh>
+#include <math/Transform.hh>
+#include <scene/Graph.hh>
+
+// Quaternion composition rounds differently from matrix products.
+bool near(const math::Mat4& a, const math::Mat4& b) {
+  for (unsigned i = 0; i < 16; i++) {
+    if (std::abs(a.pointer()[i] - b.pointer()[i]) > 1e-5f) return false;
+  }
+  return true;
+}
+
+int main(const int argc, const char* argv[]) {
+  const math::Transform moved{.translation = math::Vec3{1, 2, 3}};
+  const math::Transform spun{.rotation = math::axisAngle(0, 1, 0, 0.5f),
+                             .scale = math::Vec3{2, 2, 2}};
+
+  assert(near(math::toMat4(spun), math::scale4x4(2) * math::rotate4x4y(0.5f)) &&
+         "Transform matrix differs from the matrix chain");
+
+  scene::Graph graph;
+  const auto root = graph.add(moved);
+  const auto child = graph.add(spun, root);
+  const auto grandchild = graph.add(moved, child);
+  const auto sibling = graph.add({}, root);
+
+  assert(graph.update() == 4 && "First update must compute every node");
+  assert(near(graph.world(grandchild), math::toMat4(moved) *
+                                           math::toMat4(spun) *
+                                           math::toMat4(moved)) &&
+         "World matrix must apply the local transform, then the parents'");
+  assert(near(graph.world(grandchild),
+              math::toMat4(graph.worldTransform(grandchild))) &&
+         "World matrix and transform disagree");
+  assert(graph.update() == 0 && "Nothing changed, nothing to recompute");
+
+  graph.setLocal(child, moved);
+  assert(graph.local(child).translation == moved.translation &&
+         graph.local(child).rotation == moved.rotation);
+  assert(graph.update() == 2 && "Only the changed subtree is recomputed");
+  assert(graph.changed(child) && graph.changed(grandchild) &&
+         !graph.changed(root) && !graph.changed(sibling) &&
+         "Wrong nodes reported as changed");
+  assert(near(graph.world(grandchild), math::toMat4(moved) *
+                                           math::toMat4(moved) *
+                                           math::toMat4(moved)) &&
+         "Stale world matrix after update");
+
+  graph.setLocal(root, spun);
+  assert(graph.update() == 4 && "A changed root invalidates the whole tree");
+
+  // Siblings are composed in batches, across every SIMD width and its tail.
+  scene::Graph wide;
+  const auto parent = wide.add(spun);
+  for (unsigned i = 0; i < 19; i++) {
+    wide.add({.translation = math::Vec3{static_cast<float>(i), 0, 0},
+              .rotation = math::axisAngle(1, 0, 0, i * 0.1f)},
+             parent);
+  }
+  assert(wide.update() == 20);
+  for (unsigned i = 1; i <= 19; i++) {
+    assert(near(wide.world(i),
+                math::toMat4(wide.local(i)) * math::toMat4(spun)));
+  }
+  return 0;
+}
@@ -0,0 +1,58 @@
+#include <assert.h>
+
+#include <cmath>
+#include <cstring>
+#include <math/Mat.hh>
+#include <math/simd.hh>
+#include <scene/Shapes.hh>
+#include <vector>
+
+constexpr unsigned count = 1003;
+constexpr unsigned ticks = 600;
+constexpr float step = 1.f / 60.f;
+constexpr float extent = 0.25f;
+
+scene::Shapes::Frame run(math::simd::Isa isa) {
+  math::simd::setIsa(isa);
+  scene::Shapes shapes{extent};
+  for (unsigned i = 0; i < count; i++) {
+    shapes.add(i * 0.1f, 0.5f + i % 7, 0.5f + (i % 5) * 0.1f, 0.1f,
+               math::Vec3{1, 1, 1});
+  }
+  scene::Shapes::Frame frame;
+  for (unsigned tick = 0; tick < ticks; tick++) shapes.update(step, frame);
+  return frame;
+}
+
+bool same(const std::vector<float>& left, const std::vector<float>& right) {
+  return left.size() == right.size() &&
+         std::memcmp(left.data(), right.data(), left.size() * sizeof(float)) ==
+             0;
+}
+
+int main(const int argc, const char* argv[]) {
+  const math::simd::Isa best = math::simd::detect();
+  const scene::Shapes::Frame expected = run(math::simd::Isa::scalar);
+
+  for (unsigned i = 0; i < count; i++) {
+    const float angle = i * 0.1f + (0.5f + i % 7) * step * ticks;
+    const float scale = 0.1f * (std::fabs(std::sin(angle)) + 0.25f);
+    const float radius = 0.5f + (i % 5) * 0.1f - extent * scale;
+    assert(std::fabs(expected.scale[i] - scale) < 1e-3f &&
+           "Scale drifted away from the closed form");
+    assert(std::fabs(expected.x[i] - std::cos(angle) * radius) < 1e-3f &&
+           std::fabs(expected.y[i] - std::sin(angle) * radius) < 1e-3f &&
+           "Position drifted away from the closed form");
+  }
+
+  for (const math::simd::Isa isa :
+       {math::simd::Isa::sse, math::simd::Isa::avx2}) {
+    if (isa > best) continue;
+    const scene::Shapes::Frame frame = run(isa);
+    assert(same(frame.x, expected.x) && same(frame.y, expected.y) &&
+           same(frame.scale, expected.scale) &&
+           "Vector update differs from the scalar one");
+  }
+
+  return 0;
+}
@@ -0,0 +1,91 @@
+#include <assert.h>
+
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <utils/fs.hh>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+void write(const fs::path& path, std::string_view contents) {
+  std::ofstream{path, std::ios::binary}.write(contents.data(),
+                                              contents.size());
+}
+
+template <typename Function>
+bool throws(Function function) {
+  try {
+    function();
+  } catch (const std::runtime_error&) {
+    return true;
+  }
+  return false;
+}
+
+int main(const int argc, const char* argv[]) {
+  const fs::path directory = fs::temp_directory_path() / "utils_fs_test";
+  fs::create_directories(directory);
+
+  // Binary contents, larger than a page.
+  std::string contents(10000, 'x');
+  contents[1] = '\0';
+  contents[9999] = '\n';
+  write(directory / "data", contents);
+  write(directory / "empty", "");
+  const fs::path missing = directory / "missing";
+
+  assert(utils::readFile(directory / "data") == contents);
+  assert(utils::readFile(directory / "empty").empty());
+  assert(throws([&] { utils::readFile(missing); }));
+  if (fs::exists("/proc/self/status")) {
+    assert(!utils::readFile("/proc/self/status").empty() &&
+           "Files without a size are read to the end");
+  }
+
+  {
+    utils::MappedFile file{directory / "data"};
+    assert(file.size() == contents.size());
+    assert(file.text() == contents);
+    assert(file.bytes()[1] == std::byte{0});
+    file.advise(utils::MappedFile::Access::random);
+    file.prefetch();
+
+    utils::MappedFile moved = std::move(file);
+    assert(moved.text() == contents && file.size() == 0);
+  }
+  {
+    const utils::MappedFile file{directory / "empty"};
+    assert(file.size() == 0 && file.bytes().empty());
+    file.prefetch();
+  }
+  assert(throws([&] { utils::MappedFile{missing}; }));
+
+  std::vector<fs::path> paths;
+  for (unsigned i = 0; i < 20; i++) {
+    paths.push_back(directory / ("asset" + std::to_string(i)));
+    write(paths.back(), std::string(i * 1000, 'a' + i));
+  }
+  paths.push_back(missing);
+  {
+    utils::FileBatch batch{paths, 4};
+    assert(batch.size() == 21);
+    for (unsigned i = 0; i < 20; i++) {
+      const utils::MappedFile file = batch.get(i);
+      assert(file.text() == std::string(i * 1000, 'a' + i));
+    }
+    assert(throws([&] { batch.get(20); }) && "Errors reach get()");
+  }
+  {
+    // Results can be left untaken; destruction waits for the workers.
+    utils::FileBatch batch{paths};
+  }
+  assert(utils::FileBatch{std::vector<fs::path>{}}.size() == 0);
+
+  fs::remove_all(directory);
+  return 0;
+}
@@ -0,0 +1,191 @@
+#include <assert.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <stdexcept>
+#include <thread>
+#include <utils/jobs.hh>
+#include <vector>
+
+// Every pushed item is taken exactly once, by its owner or by a thief.
+void testDeque() {
+  utils::StealingDeque<int*> deque{4};
+  std::vector<int> values(8);
+  assert(deque.pop() == nullptr && deque.steal() == nullptr);
+  for (int i = 0; i < 4; i++) assert(deque.push(&values[i]));
+  assert(!deque.push(&values[4]) && "Capacity is a hard limit");
+  assert(deque.steal() == &values[0] && "Thieves take the oldest item");
+  assert(deque.pop() == &values[3] && "The owner takes the newest item");
+  assert(deque.pop() == &values[2] && deque.pop() == &values[1]);
+  assert(deque.empty());
+
+  constexpr int count = 200000;
+  std::vector<int> items(count);
+  std::vector<std::atomic<int>> taken(count);
+  utils::StealingDeque<int*> shared{256};
+  std::atomic<bool> pushing{true};
+  const auto take = [&](int* item) { taken[item - items.data()]++; };
+  {
+    std::vector<std::jthread> thieves;
+    for (int thief = 0; thief < 3; thief++) {
+      thieves.emplace_back([&] {
+        while (pushing || !shared.empty()) {
+          if (int* item = shared.steal()) take(item);
+        }
+      });
+    }
+    for (int i = 0; i < count; i++) {
+      while (!shared.push(&items[i])) {
+        if (int* item = shared.pop()) take(item);
+      }
+      if (i % 3 == 0) {
+        if (int* item = shared.pop()) take(item);
+      }
+    }
+    while (int* item = shared.pop()) take(item);
+    pushing = false;
+  }
+  assert(std::all_of(taken.begin(), taken.end(),
+                     [](const std::atomic<int>& n) { return n == 1; }));
+}
+
+void testParallelFor(utils::JobSystem& jobs) {
+  for (const std::size_t size : {0u, 1u, 7u, 1000u, 100000u}) {
+    for (const std::size_t grain : {0u, 1u, 64u}) {
+      std::vector<std::atomic<int>> visits(size);
+      jobs.parallelFor(0, size, [&](std::size_t begin, std::size_t end) {
+        assert(begin < end && (grain == 0 || end - begin <= grain));
+        for (std::size_t i = begin; i < end; i++) visits[i]++;
+      }, grain);
+      assert(std::all_of(visits.begin(), visits.end(),
+                         [](const std::atomic<int>& n) { return n == 1; }));
+    }
+  }
+
+  // Uneven iterations, and an offset range.
+  std::atomic<unsigned long> sum = 0;
+  jobs.parallelFor(1000, 3000, [&](std::size_t begin, std::size_t end) {
+    unsigned long local = 0;
+    for (std::size_t i = begin; i < end; i++) {
+      for (std::size_t k = 0; k < (i % 100) * 50; k++) {
+        local += k % 2;
+      }
+      local += i;
+    }
+    sum += local;
+  });
+  unsigned long expected = 0;
+  for (std::size_t i = 1000; i < 3000; i++) {
+    expected += i + (i % 100) * 25;
+  }
+  assert(sum == expected);
+
+  bool thrown = false;
+  try {
+    jobs.parallelFor(0, 10000, [](std::size_t begin, std::size_t end) {
+      if (begin <= 5000 && 5000 < end) throw std::runtime_error{"loop"};
+    });
+  } catch (const std::runtime_error&) {
+    thrown = true;
+  }
+  assert(thrown && "The body's exception reaches the caller");
+}
+
+void testJobs(utils::JobSystem& jobs) {
+  std::atomic<int> step = 0;
+  int a = 0, b = 0, c = 0, d = 0;
+  const utils::JobSystem::Job first = jobs.submit([&] { a = ++step; });
+  const utils::JobSystem::Job left = jobs.submit([&] { b = ++step; }, {first});
+  const utils::JobSystem::Job right =
+      jobs.submit([&] { c = ++step; }, {first});
+  const utils::JobSystem::Job last =
+      jobs.submit([&] { d = ++step; }, {left, right});
+  jobs.wait(last);
+  assert(last.done() && first.done() && left.done() && right.done());
+  assert(a == 1 && b > a && c > a && d == 4 && "Dependencies run first");
+
+  // Finished dependencies and empty handles do not hold a job back.
+  int late = 0;
+  jobs.wait(jobs.submit([&] { late = 1; }, {first, {}}));
+  assert(late == 1);
+
+  const utils::JobSystem::Job failing =
+      jobs.submit([] { throw std::runtime_error{"job"}; });
+  bool continued = false;
+  const utils::JobSystem::Job after =
+      jobs.submit([&] { continued = true; }, {failing});
+  bool thrown = false;
+  try {
+    jobs.wait(failing);
+  } catch (const std::runtime_error&) {
+    thrown = true;
+  }
+  jobs.wait(after);
+  assert(thrown && continued);
+
+  // Many small jobs, some spawning loops of their own.
+  std::atomic<unsigned long> total = 0;
+  std::vector<utils::JobSystem::Job> batch;
+  for (unsigned i = 0; i < 500; i++) {
+    batch.push_back(jobs.submit([&jobs, &total, i] {
+      if (i % 50 == 0) {
+        jobs.parallelFor(0, 1000, [&](std::size_t begin, std::size_t end) {
+          total += end - begin;
+        });
+      } else {
+        total++;
+      }
+    }));
+  }
+  for (const utils::JobSystem::Job& job : batch) jobs.wait(job);
+  assert(total == 10 * 1000 + 490);
+
+  // Threads outside the system may submit and wait too.
+  std::atomic<int> outside = 0;
+  std::jthread{[&] {
+    const utils::JobSystem::Job job = jobs.submit([&] { outside++; });
+    jobs.wait(jobs.submit([&] { outside++; }, {job}));
+    jobs.parallelFor(0, 100, [&](std::size_t begin, std::size_t end) {
+      outside += end - begin;
+    });
+  }}.join();
+  assert(outside == 102);
+}
+
+int main(const int argc, const char* argv[]) {
+  testDeque();
+  for (const unsigned threads : {1u, 2u, 4u, 0u}) {
+    utils::JobSystem jobs{threads};
+    assert(jobs.threads() >= 1 && (threads == 0 || jobs.threads() == threads));
+    testParallelFor(jobs);
+    testJobs(jobs);
+  }
+
+  // Continuations that overflow the deque run in place, and may depend on
+  // the job that released them.
+  {
+    utils::JobSystem jobs{1};
+    const utils::JobSystem::Job first = jobs.submit([] {});
+    std::atomic<int> nested = 0;
+    std::vector<utils::JobSystem::Job> continuations;
+    for (int i = 0; i < 1100; i++) {
+      continuations.push_back(jobs.submit(
+          [&jobs, &nested, first] {
+            jobs.wait(jobs.submit([&] { nested++; }, {first}));
+          },
+          {first}));
+    }
+    for (const utils::JobSystem::Job& job : continuations) jobs.wait(job);
+    assert(nested == 1100);
+  }
+
+  // Queued jobs still run when the system goes away.
+  std::atomic<int> ran = 0;
+  {
+    utils::JobSystem jobs{3};
+    for (int i = 0; i < 100; i++) jobs.submit([&] { ran++; });
+  }
+  assert(ran == 100);
+  return 0;
+}
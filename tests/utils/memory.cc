@@ -0,0 +1,98 @@
+#include <assert.h>
+
+#include <cstddef>
+#include <heap/counters.hh>
+#include <cstdint>
+#include <memory_resource>
+#include <new>
+#include <utils/memory.hh>
+#include <vector>
+
+bool aligned(const void* pointer, std::size_t alignment) {
+  return reinterpret_cast<std::uintptr_t>(pointer) % alignment == 0;
+}
+
+struct Node {
+  Node* next = nullptr;
+  float value = 0;
+};
+
+// What a frame of the demos does with scratch memory: staging arrays of
+// varying sizes, filled and dropped.
+void frame(utils::Arena& arena, std::size_t count) {
+  std::pmr::vector<float> staging{&arena};
+  for (std::size_t i = 0; i < count; i++) staging.push_back(i);
+  std::pmr::vector<std::uint32_t> visible(count / 2, &arena);
+  assert(staging.size() == count && visible.size() == count / 2);
+}
+
+int main(const int argc, const char* argv[]) {
+  assert(heap::installed());
+  {
+    utils::Arena arena{256};
+    void* first = arena.allocate(10, 1);
+    void* second = arena.allocate(8, 64);
+    assert(aligned(second, 64));
+    assert(static_cast<std::byte*>(second) >=
+           static_cast<std::byte*>(first) + 10);
+    assert(arena.used() >= 18 && arena.capacity() == 256);
+
+    // Larger than a block: gets a block of its own.
+    void* large = arena.allocate(1000, 16);
+    assert(aligned(large, 16) && arena.capacity() > 256 + 1000);
+    const std::size_t capacity = arena.capacity();
+
+    arena.reset();
+    assert(arena.used() == 0 && arena.capacity() == capacity);
+    large = arena.allocate(1000, 16);
+    void* small = arena.allocate(10, 1);
+    assert(large != nullptr && small != nullptr);
+    assert(arena.capacity() == capacity && "Reset merges the blocks");
+  }
+
+  {
+    utils::Arena arena;
+    frame(arena, 100000);
+    arena.reset();
+    const heap::Counters before = heap::thread();
+    for (unsigned i = 0; i < 10; i++) {
+      frame(arena, 100000 - i * 1000);
+      arena.reset();
+    }
+    assert((heap::thread() - before).allocations == 0 &&
+           "Steady frames allocate nothing");
+  }
+
+  {
+    utils::Pool pool{sizeof(Node), 4, alignof(Node)};
+    assert(pool.chunkSize() >= sizeof(Node));
+    std::pmr::polymorphic_allocator<Node> allocator{&pool};
+    std::vector<Node*> nodes;
+    for (unsigned i = 0; i < 6; i++) {
+      nodes.push_back(allocator.new_object<Node>());
+      nodes.back()->value = i;
+      assert(aligned(nodes.back(), alignof(Node)));
+    }
+    assert(pool.allocated() == 6 && pool.capacity() == 8);
+    for (unsigned i = 0; i < 6; i++) assert(nodes[i]->value == i);
+    assert(static_cast<std::byte*>(static_cast<void*>(nodes[1])) -
+               static_cast<std::byte*>(static_cast<void*>(nodes[0])) ==
+           static_cast<std::ptrdiff_t>(pool.chunkSize()));
+
+    Node* freed = nodes[2];
+    allocator.delete_object(freed);
+    assert(pool.allocated() == 5);
+    const heap::Counters before = heap::thread();
+    Node* reused = allocator.new_object<Node>();
+    assert(reused == freed && (heap::thread() - before).allocations == 0);
+
+    bool threw = false;
+    try {
+      static_cast<void>(pool.allocate(pool.chunkSize() + 1, 1));
+    } catch (const std::bad_alloc&) {
+      threw = true;
+    }
+    assert(threw && "Larger requests are refused");
+  }
+  return 0;
+}
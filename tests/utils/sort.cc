@@ -0,0 +1,51 @@
+#include <assert.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+#include <random>
+#include <span>
+#include <utils/sort.hh>
+#include <vector>
+
+// Indices in the order std::stable_sort puts the keys in.
+std::vector<std::uint32_t> expected(const std::vector<std::uint64_t>& keys) {
+  std::vector<std::uint32_t> order(keys.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(),
+                   [&](std::uint32_t a, std::uint32_t b) {
+                     return keys[a] < keys[b];
+                   });
+  return order;
+}
+
+bool matches(std::span<const std::uint32_t> sorted,
+             const std::vector<std::uint32_t>& order) {
+  return std::equal(sorted.begin(), sorted.end(), order.begin(), order.end());
+}
+
+int main(const int argc, const char* argv[]) {
+  utils::RadixSorter sorter;
+  assert(sorter.sort({}).empty());
+
+  const std::vector<std::uint64_t> single{42};
+  assert(matches(sorter.sort(single), {0}));
+
+  // Full-width keys, and keys that differ only in a few bytes, with many
+  // duplicates to check that ties keep their order.
+  std::mt19937_64 random{5};
+  for (const std::uint64_t mask :
+       {~0ull, 0xff00'0000'0000'00ffull, 0x0000'00ff'ff00'0000ull, 0x3ull}) {
+    for (const unsigned count : {2u, 17u, 1000u, 70000u}) {
+      std::vector<std::uint64_t> keys(count);
+      for (std::uint64_t& key : keys) {
+        key = (random() & mask) | 0x0100'0000'0000'0000ull;
+      }
+      assert(matches(sorter.sort(keys), expected(keys)));
+    }
+  }
+
+  const std::vector<std::uint64_t> same(100, 7);
+  assert(matches(sorter.sort(same), expected(same)));
+  return 0;
+}
@@ -0,0 +1,31 @@
+#include <assert.h>
+
+#include <array>
+#include <thread>
+#include <utils/triple.hh>
+
+constexpr unsigned long values = 200000;
+
+int main(const int argc, const char* argv[]) {
+  using Value = std::array<unsigned long, 8>;
+  utils::TripleBuffer<Value> buffer{Value{}};
+
+  std::jthread writer{[&buffer]() {
+    for (unsigned long number = 1; number <= values; number++) {
+      buffer.write().fill(number);
+      buffer.publish();
+    }
+  }};
+
+  unsigned long last = 0;
+  while (last < values) {
+    const Value& value = buffer.read();
+    for (const unsigned long item : value) {
+      assert(item == value[0] && "Reader saw a partially written value");
+    }
+    assert(value[0] >= last && "Reader went back to an older value");
+    last = value[0];
+  }
+
+  return 0;
+}